@@ -38,62 +38,75 @@ SOURCES += \
   ./src/main.cpp\
   ./src/MainWindow.cpp \
   ./src/PlotHD.cpp \
+  ./src/PlotPool.cpp \
   ./src/Geometry.cpp \
   ./src/MyVTKApplication.cpp \
   ./src/AboutDialog.cpp \
+  ./src/ArrayRangeEngine.cpp \
+  ./src/BatchRenderer.cpp \
+  ./src/DatasetRegistry.cpp \
+  ./src/ExternalArray.cpp \
   ./src/GeometryPartRepresentation.cpp \
   ./src/GeometryPart.cpp \
-  ./src/GeometryFactory.cpp
+  ./src/GeometryCache.cpp \
+  ./src/GeometryFactory.cpp \
+  ./src/GeometryLoader.cpp \
+  ./src/LiveSource.cpp \
+  ./src/LODProxySet.cpp \
+  ./src/MemoryGrowthDriver.cpp \
+  ./src/ParallelBandedContourFilter.cpp \
+  ./src/PartBanding.cpp \
+  ./src/PartBatch.cpp \
+  ./src/PartCache.cpp \
+  ./src/PartHierarchy.cpp \
+  ./src/PartLocator.cpp \
+  ./src/PrecisionConverter.cpp \
+  ./src/ProceduralGeometry.cpp \
+  ./src/ProbeEngine.cpp \
+  ./src/ProbeRunner.cpp \
+  ./src/RedrawScheduler.cpp \
+  ./src/TimeSeriesPlayer.cpp \
+  ./src/Tracer.cpp
 
 HEADERS  += \
   ./src/MainWindow.h \
   ./src/PlotHD.h \
+  ./src/PlotPool.h \
   ./src/Geometry.h \
   ./src/MyVTKApplication.h \
   ./src/AboutDialog.h \
+  ./src/ArrayRangeEngine.h \
+  ./src/BatchRenderer.h \
+  ./src/DatasetRegistry.h \
+  ./src/ExternalArray.h \
   ./src/GeometryPartRepresentation.h \
   ./src/GeometryPart.h \
-  ./src/GeometryFactory.h
+  ./src/GeometryCache.h \
+  ./src/GeometryFactory.h \
+  ./src/GeometryLoader.h \
+  ./src/LiveSegment.h \
+  ./src/LiveSource.h \
+  ./src/LODProxySet.h \
+  ./src/MemoryGrowthDriver.h \
+  ./src/ParallelBandedContourFilter.h \
+  ./src/PartBanding.h \
+  ./src/PartBatch.h \
+  ./src/PartCache.h \
+  ./src/PartHierarchy.h \
+  ./src/PartLocator.h \
+  ./src/PrecisionConverter.h \
+  ./src/ProceduralGeometry.h \
+  ./src/ProbeEngine.h \
+  ./src/ProbeRunner.h \
+  ./src/RedrawScheduler.h \
+  ./src/TimeSeriesPlayer.h \
+  ./src/Tracer.h
 
 FORMS    += \
   ./src/ui/MainWindow.ui \
   ./src/ui/AboutDialog.ui
 
-INCLUDEPATH += \
-  $$(VTK_7_INCLUDE_PATH)
+# shm_open
+unix:!macx: LIBS += -lrt
 
-LIBS += \
-  -L$$(VTK_7_LIBRARY_PATH) \
-  -lvtkCommonColor-7.1 \
-  -lvtkCommonCore-7.1 \
-  -lvtkCommonComputationalGeometry-7.1 \
-  -lvtkCommonDataModel-7.1 \
-  -lvtkCommonExecutionModel-7.1 \
-  -lvtkCommonMath-7.1 \
-  -lvtkCommonMisc-7.1 \
-  -lvtkCommonSystem-7.1 \
-  -lvtkCommonTransforms-7.1 \
-  -lvtkDICOMParser-7.1 \
-  -lvtkFiltersCore-7.1 \
-  -lvtkFiltersGeneral-7.1 \
-  -lvtkFiltersGeometry-7.1 \
-  -lvtkFiltersModeling-7.1 \
-  -lvtkFiltersExtraction-7.1 \
-  -lvtkFiltersSources-7.1 \
-  -lvtkFiltersStatistics-7.1 \
-  -lvtkGUISupportQt-7.1 \
-  -lvtkGUISupportQtOpenGL-7.1 \
-  -lvtkIOImage-7.1 \
-  -lvtkImagingCore-7.1 \
-  -lvtkImagingFourier-7.1 \
-  -lvtkInteractionStyle-7.1 \
-  -lvtkRenderingCore-7.1 \
-  -lvtkRenderingOpenGL2-7.1 \
-  -lvtkalglib-7.1 \
-  -lvtkglew-7.1 \
-  -lvtkjpeg-7.1 \
-  -lvtkmetaio-7.1 \
-  -lvtkpng-7.1 \
-  -lvtksys-7.1 \
-  -lvtktiff-7.1 \
-  -lvtkzlib-7.1
+include(vtk7.pri)
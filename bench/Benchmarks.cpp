@@ -0,0 +1,670 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "Benchmarks.h"
+
+#include "Geometry.h"
+#include "GeometryPart.h"
+#include "GeometryPartRepresentation.h"
+#include "PartBatch.h"
+#include "PlotHD.h"
+#include "PlotPool.h"
+#include "RedrawScheduler.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkVersion.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+//------------------------------------------------------------------------------
+
+typedef QList<QPair<QString, QString>> Parameters;
+
+QPair<QString, QString> parameter(const char* name, qint64 value)
+{
+  return qMakePair(QString(name), QString::number(value));
+}
+
+//------------------------------------------------------------------------------
+
+Benchmarks::Options::Options()
+  :
+  m_meshSizes(QList<int>() << 16 << 32 << 64),
+  m_nofBands(QList<int>() << 5 << 10 << 20),
+  m_nofParts(200),
+  m_partSize(8),
+  m_nofFields(4),
+  m_nofRepeats(5),
+  m_gui(false)
+{
+}
+
+//------------------------------------------------------------------------------
+
+Benchmarks::Benchmarks(const Options& options)
+  :
+  m_options(options)
+{
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkUnstructuredGrid> Benchmarks::CreateHexMesh(
+  int size,
+  int nofFields)
+{
+  const vtkIdType n  = size + 1;
+  const double    dx = 1.0 / size;
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(n * n * n);
+
+  std::vector<vtkSmartPointer<vtkFloatArray>> fields(nofFields);
+
+  for( int f = 0; f < nofFields; ++f )
+  {
+    fields[f] = vtkSmartPointer<vtkFloatArray>::New();
+    fields[f]->SetName(
+      (f == 0)? "TestField" : qPrintable(QString("Field%1").arg(f)));
+    fields[f]->SetNumberOfTuples(n * n * n);
+  }
+
+  for( vtkIdType k = 0; k < n; ++k )
+  {
+    for( vtkIdType j = 0; j < n; ++j )
+    {
+      for( vtkIdType i = 0; i < n; ++i )
+      {
+        const vtkIdType id = i + n * (j + n * k);
+        const double x = i * dx, y = j * dx, z = k * dx;
+
+        points->SetPoint(id, x, y, z);
+
+        for( int f = 0; f < nofFields; ++f )
+        {
+          const double value =
+            std::sin(6.0 * (f + 1) * x) * std::cos(4.0 * y) + z;
+
+          fields[f]->SetValue(id, static_cast<float>(value));
+        }
+      }
+    }
+  }
+
+  const vtkIdType nofCells = static_cast<vtkIdType>(size) * size * size;
+
+  vtkSmartPointer<vtkIdTypeArray> connectivity =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(9 * nofCells);
+
+  vtkIdType* cell = connectivity->GetPointer(0);
+
+  for( vtkIdType k = 0; k < size; ++k )
+  {
+    for( vtkIdType j = 0; j < size; ++j )
+    {
+      for( vtkIdType i = 0; i < size; ++i )
+      {
+        const vtkIdType p = i + n * (j + n * k);
+
+        *cell++ = 8;
+        *cell++ = p;
+        *cell++ = p + 1;
+        *cell++ = p + 1 + n;
+        *cell++ = p + n;
+        *cell++ = p + n * n;
+        *cell++ = p + 1 + n * n;
+        *cell++ = p + 1 + n + n * n;
+        *cell++ = p + n + n * n;
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  cells->SetCells(nofCells, connectivity);
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->SetCells(VTK_HEXAHEDRON, cells);
+
+  for( auto& field : fields )
+  {
+    grid->GetPointData()->AddArray(field);
+  }
+
+  return grid;
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::run()
+{
+  benchAddPart();
+  benchSolidPartActor();
+  benchDatasetPartActor();
+
+  // Needs a display for the QVTKWidget2 of the plot
+  if( m_options.m_gui )
+  {
+    benchPlotAddGeometry();
+    benchBatchRender();
+    benchPlotRecycle();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+const QList<Benchmarks::Result>& Benchmarks::getResults() const
+{
+  return m_results;
+}
+
+//------------------------------------------------------------------------------
+
+QString Benchmarks::toJson() const
+{
+  QStringList results;
+
+  for( const Result& result : m_results )
+  {
+    std::vector<double> sorted = result.m_times;
+    std::sort(sorted.begin(), sorted.end());
+
+    const double mean =
+      std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+    QStringList parameters;
+
+    for( const auto& param : result.m_parameters )
+    {
+      parameters << QString("\"%1\": %2").arg(param.first, param.second);
+    }
+
+    results << QString(
+      "    {\"name\": \"%1\", \"parameters\": {%2}, \"repeats\": %3, "
+      "\"min_ms\": %4, \"median_ms\": %5, \"mean_ms\": %6, \"max_ms\": %7}")
+      .arg(result.m_name)
+      .arg(parameters.join(", "))
+      .arg(sorted.size())
+      .arg(sorted.front(), 0, 'f', 3)
+      .arg(sorted[sorted.size() / 2], 0, 'f', 3)
+      .arg(mean, 0, 'f', 3)
+      .arg(sorted.back(), 0, 'f', 3);
+  }
+
+  return QString(
+    "{\n"
+    "  \"suite\": \"QtVTKViewerBenchmarks\",\n"
+    "  \"qt_version\": \"%1\",\n"
+    "  \"vtk_version\": \"%2\",\n"
+    "  \"threads\": %3,\n"
+    "  \"results\": [\n%4\n  ]\n"
+    "}\n")
+    .arg(qVersion())
+    .arg(vtkVersion::GetVTKVersion())
+    .arg(QThread::idealThreadCount())
+    .arg(results.join(",\n"));
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::benchAddPart()
+{
+  const QString name = "Geometry::addPart";
+
+  if( !isSelected(name) )
+  {
+    return;
+  }
+
+  // Every part gets a shallow copy of the same mesh, the arrays are still
+  // scanned once per part as every part has its own range cache
+  vtkSmartPointer<vtkUnstructuredGrid> mesh =
+    CreateHexMesh(m_options.m_partSize, m_options.m_nofFields);
+
+  std::vector<std::unique_ptr<GeometryPart>> parts;
+  std::unique_ptr<Geometry> geom;
+
+  measure(
+    name,
+    Parameters()
+      << parameter("parts", m_options.m_nofParts)
+      << parameter("fields", m_options.m_nofFields)
+      << parameter("part_cells", mesh->GetNumberOfCells()),
+    [&]()
+    {
+      geom = std::unique_ptr<Geometry>(new Geometry());
+
+      for( int p = 0; p < m_options.m_nofParts; ++p )
+      {
+        parts.push_back(std::unique_ptr<GeometryPart>(new GeometryPart()));
+        parts.back()->setGeometryData(mesh);
+      }
+    },
+    [&]()
+    {
+      for( auto& part : parts )
+      {
+        geom->addPart(std::move(part));
+      }
+    },
+    [&]()
+    {
+      parts.clear();
+      geom.reset();
+    });
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::benchSolidPartActor()
+{
+  const QString name = "GeometryPartRepresentation::updateSolidPartActor";
+
+  if( !isSelected(name) )
+  {
+    return;
+  }
+
+  for( int size : m_options.m_meshSizes )
+  {
+    vtkSmartPointer<vtkUnstructuredGrid> mesh = CreateHexMesh(size, 1);
+
+    std::shared_ptr<GeometryPart> part;
+    std::unique_ptr<GeometryPartRepresentation> rep;
+
+    // A new part every time, otherwise the surface is already extracted
+    measure(
+      name,
+      Parameters()
+        << parameter("cells", mesh->GetNumberOfCells()),
+      [&]()
+      {
+        part = std::make_shared<GeometryPart>();
+        part->setGeometryData(mesh);
+      },
+      [&]()
+      {
+        rep = std::unique_ptr<GeometryPartRepresentation>(
+          new GeometryPartRepresentation(
+            part,
+            vtkWeakPointer<vtkRenderer>()));
+
+        rep->updateSolidPartActor();
+        rep->updatePipeline();
+      },
+      [&]()
+      {
+        rep.reset();
+        part.reset();
+      });
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::benchDatasetPartActor()
+{
+  const QString name = "GeometryPartRepresentation::updateDatasetPartActor";
+
+  if( !isSelected(name) )
+  {
+    return;
+  }
+
+  for( int size : m_options.m_meshSizes )
+  {
+    vtkSmartPointer<vtkUnstructuredGrid> mesh = CreateHexMesh(size, 1);
+
+    for( int nofBands : m_options.m_nofBands )
+    {
+      std::unique_ptr<Geometry> geom;
+      std::unique_ptr<GeometryPartRepresentation> rep;
+
+      measure(
+        name,
+        Parameters()
+          << parameter("cells", mesh->GetNumberOfCells())
+          << parameter("bands", nofBands),
+        [&]()
+        {
+          geom = std::unique_ptr<Geometry>(new Geometry());
+
+          std::unique_ptr<GeometryPart> part(new GeometryPart());
+          part->setGeometryData(mesh);
+          geom->addPart(std::move(part));
+
+          rep = std::unique_ptr<GeometryPartRepresentation>(
+            new GeometryPartRepresentation(
+              geom->getPart(0),
+              vtkWeakPointer<vtkRenderer>()));
+
+          rep->setDatasetInfo(geom->findDataset("TestField"));
+          rep->setNofBands(nofBands);
+          rep->setShowDataset(true);
+        },
+        [&]()
+        {
+          rep->updateDatasetPartActor();
+          rep->updatePipeline();
+        },
+        [&]()
+        {
+          rep.reset();
+          geom.reset();
+        });
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::benchPlotAddGeometry()
+{
+  const QString name = "PlotHD::addGeometry";
+
+  if( !isSelected(name) )
+  {
+    return;
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> mesh =
+    CreateHexMesh(m_options.m_partSize, m_options.m_nofFields);
+
+  std::shared_ptr<Geometry> geom(new Geometry());
+
+  for( int p = 0; p < m_options.m_nofParts; ++p )
+  {
+    std::unique_ptr<GeometryPart> part(new GeometryPart());
+    part->setGeometryData(mesh);
+    geom->addPart(std::move(part));
+  }
+
+  std::unique_ptr<PlotHD> plot;
+
+  const int minNofParts = PartBatch::GetMinNofParts();
+
+  // Includes the scheduler tick that executes the pipelines of all parts,
+  // batched the parts go into composite blocks instead of their own actors
+  for( int batched = 0; batched < 2; ++batched )
+  {
+    PartBatch::SetMinNofParts(batched);
+
+    measure(
+      name,
+      Parameters()
+        << parameter("parts", m_options.m_nofParts)
+        << parameter("part_cells", mesh->GetNumberOfCells())
+        << parameter("batched", batched),
+      [&]()
+      {
+        plot = std::unique_ptr<PlotHD>(new PlotHD());
+      },
+      [&]()
+      {
+        plot->addGeometry(geom);
+        plot->getRedrawScheduler()->flush();
+      },
+      [&]()
+      {
+        plot.reset();
+      });
+  }
+
+  PartBatch::SetMinNofParts(minNofParts);
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::benchBatchRender()
+{
+  const QString name = "vtkRenderWindow::Render";
+
+  if( !isSelected(name) )
+  {
+    return;
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> mesh =
+    CreateHexMesh(m_options.m_partSize, m_options.m_nofFields);
+
+  std::shared_ptr<Geometry> geom(new Geometry());
+
+  // Side by side, so the frame holds every part
+  for( int p = 0; p < m_options.m_nofParts; ++p )
+  {
+    vtkSmartPointer<vtkUnstructuredGrid> partMesh =
+      vtkSmartPointer<vtkUnstructuredGrid>::New();
+    partMesh->ShallowCopy(mesh);
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->DeepCopy(mesh->GetPoints());
+
+    for( vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i )
+    {
+      double point[3];
+      points->GetPoint(i, point);
+      point[0] += 1.1 * p;
+      points->SetPoint(i, point);
+    }
+
+    partMesh->SetPoints(points);
+
+    std::unique_ptr<GeometryPart> part(new GeometryPart());
+    part->setGeometryData(partMesh);
+    geom->addPart(std::move(part));
+  }
+
+  const DatasetHandle dataset = geom->findDataset("TestField");
+
+  // A still frame of the solids and the bands, from one actor per part and
+  // layer or from the composite mappers of a batch. The first frame uploads
+  // the buffers and is not timed.
+  for( int batched = 0; batched < 2; ++batched )
+  {
+    vtkSmartPointer<vtkRenderer> renderer;
+    vtkSmartPointer<vtkRenderWindow> renWin;
+    std::unique_ptr<PartBatch> batch;
+    std::vector<std::unique_ptr<GeometryPartRepresentation>> reps;
+
+    measure(
+      name,
+      Parameters()
+        << parameter("parts", m_options.m_nofParts)
+        << parameter("part_cells", mesh->GetNumberOfCells())
+        << parameter("batched", batched),
+      [&]()
+      {
+        renderer = vtkSmartPointer<vtkRenderer>::New();
+
+        renWin = vtkSmartPointer<vtkRenderWindow>::New();
+        renWin->SetOffScreenRendering(1);
+        renWin->SetSize(1024, 768);
+        renWin->AddRenderer(renderer);
+
+        if( batched )
+        {
+          batch.reset(new PartBatch(renderer.Get()));
+        }
+
+        for( int p = 0; p < m_options.m_nofParts; ++p )
+        {
+          reps.push_back(std::unique_ptr<GeometryPartRepresentation>(
+            new GeometryPartRepresentation(geom->getPart(p), renderer.Get())));
+
+          GeometryPartRepresentation* rep = reps.back().get();
+
+          rep->setDatasetInfo(dataset);
+          rep->setShowDataset(true);
+          rep->applyChanges();
+
+          if( batch )
+          {
+            rep->setBatch(batch.get(), p);
+          }
+
+          rep->updatePipeline();
+        }
+
+        renderer->ResetCamera();
+        renWin->Render();
+      },
+      [&]()
+      {
+        renWin->Render();
+      },
+      [&]()
+      {
+        // The representations remove their actors from the renderer
+        reps.clear();
+        batch.reset();
+        renWin = nullptr;
+        renderer = nullptr;
+      });
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::benchPlotRecycle()
+{
+  const QString name = "PlotPool::Acquire";
+
+  if( !isSelected(name) )
+  {
+    return;
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> mesh =
+    CreateHexMesh(m_options.m_partSize, m_options.m_nofFields);
+
+  std::shared_ptr<Geometry> geom(new Geometry());
+
+  std::unique_ptr<GeometryPart> part(new GeometryPart());
+  part->setGeometryData(mesh);
+  geom->addPart(std::move(part));
+
+  const int capacity = PlotPool::GetCapacity();
+
+  // Without pool every plot creates its render widget and renderer, with it
+  // the plot released by the previous repeat is taken back
+  for( int pooled = 0; pooled < 2; ++pooled )
+  {
+    PlotPool::SetCapacity(pooled);
+
+    measure(
+      name,
+      Parameters()
+        << parameter("pooled", pooled)
+        << parameter("part_cells", mesh->GetNumberOfCells()),
+      [&]()
+      {
+      },
+      [&]()
+      {
+        PlotHD* plot = PlotPool::Acquire(nullptr);
+        plot->addGeometry(geom);
+        plot->getRedrawScheduler()->flush();
+        PlotPool::Release(plot);
+      },
+      [&]()
+      {
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+      });
+  }
+
+  PlotPool::Clear();
+  PlotPool::SetCapacity(capacity);
+}
+
+//------------------------------------------------------------------------------
+
+bool Benchmarks::isSelected(const QString& name) const
+{
+  return m_options.m_filter.isEmpty() ||
+         name.contains(m_options.m_filter, Qt::CaseInsensitive);
+}
+
+//------------------------------------------------------------------------------
+
+void Benchmarks::measure(
+  const QString& name,
+  const Parameters& parameters,
+  std::function<void()> setup,
+  std::function<void()> body,
+  std::function<void()> teardown)
+{
+  Result result;
+  result.m_name       = name;
+  result.m_parameters = parameters;
+
+  for( int r = -1; r < m_options.m_nofRepeats; ++r )
+  {
+    setup();
+
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto end = std::chrono::steady_clock::now();
+
+    teardown();
+
+    // The first run only warms up caches and lazy initializations
+    if( r >= 0 )
+    {
+      result.m_times.push_back(
+        std::chrono::duration<double, std::milli>(end - start).count());
+    }
+  }
+
+  m_results << result;
+
+  QStringList values;
+
+  for( const auto& param : parameters )
+  {
+    values << QString("%1=%2").arg(param.first, param.second);
+  }
+
+  // Progress on stderr, stdout only gets the JSON
+  qWarning("%s (%s): %.3f ms",
+    qPrintable(name),
+    qPrintable(values.join(" ")),
+    *std::min_element(result.m_times.begin(), result.m_times.end()));
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+#include <vtkSmartPointer.h>
+
+#include <functional>
+#include <vector>
+
+class vtkUnstructuredGrid;
+
+// Times the geometry and representation hot paths on generated hexahedral
+// meshes and reports the results as JSON, so runs of different releases
+// can be compared by a script.
+class Benchmarks
+{
+public:
+  struct Options
+  {
+    Options();
+
+    QList<int> m_meshSizes;
+    QList<int> m_nofBands;
+    int        m_nofParts;
+    int        m_partSize;
+    int        m_nofFields;
+    int        m_nofRepeats;
+    bool       m_gui;
+    QString    m_filter;
+  };
+
+  struct Result
+  {
+    QString                         m_name;
+    QList<QPair<QString, QString>>  m_parameters;
+    std::vector<double>             m_times;
+  };
+
+  explicit Benchmarks(const Options& options);
+
+  // Hexahedral grid with size^3 cells and nofFields analytic point fields,
+  // the first one is named "TestField" like the field PlotHD shows
+  static vtkSmartPointer<vtkUnstructuredGrid> CreateHexMesh(
+    int size,
+    int nofFields);
+
+  void run();
+
+  const QList<Result>& getResults() const;
+  QString toJson() const;
+
+protected:
+  void benchAddPart();
+  void benchSolidPartActor();
+  void benchDatasetPartActor();
+  void benchPlotAddGeometry();
+  void benchBatchRender();
+  void benchPlotRecycle();
+
+  bool isSelected(const QString& name) const;
+
+  // Runs setup (not timed), body (timed) and teardown (not timed) once to
+  // warm up, then m_nofRepeats times
+  void measure(
+    const QString& name,
+    const QList<QPair<QString, QString>>& parameters,
+    std::function<void()> setup,
+    std::function<void()> body,
+    std::function<void()> teardown);
+
+  Options       m_options;
+  QList<Result> m_results;
+};
+
+#endif // BENCHMARKS_H
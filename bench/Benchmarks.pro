@@ -0,0 +1,89 @@
+#-------------------------------------------------------------------------------
+#
+# Copyright 2017 Edson Contreras
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+#-------------------------------------------------------------------------------
+
+# Microbenchmarks of the geometry and representation hot paths, see
+# bench/main.cpp for the options. Results are printed as JSON.
+
+QT       += core gui opengl
+
+TARGET = QtVTKViewerBenchmarks
+TEMPLATE = app
+
+QMAKE_CXXFLAGS += -std=c++11
+
+INCLUDEPATH += \
+  ../src
+
+SOURCES += \
+  ./main.cpp \
+  ./Benchmarks.cpp \
+  ../src/ArrayRangeEngine.cpp \
+  ../src/DatasetRegistry.cpp \
+  ../src/ExternalArray.cpp \
+  ../src/Geometry.cpp \
+  ../src/GeometryCache.cpp \
+  ../src/GeometryLoader.cpp \
+  ../src/GeometryPart.cpp \
+  ../src/GeometryPartRepresentation.cpp \
+  ../src/LODProxySet.cpp \
+  ../src/ParallelBandedContourFilter.cpp \
+  ../src/PartBanding.cpp \
+  ../src/PartBatch.cpp \
+  ../src/PartCache.cpp \
+  ../src/PartHierarchy.cpp \
+  ../src/PartLocator.cpp \
+  ../src/PrecisionConverter.cpp \
+  ../src/ProbeEngine.cpp \
+  ../src/PlotHD.cpp \
+  ../src/PlotPool.cpp \
+  ../src/RedrawScheduler.cpp \
+  ../src/TimeSeriesPlayer.cpp \
+  ../src/Tracer.cpp
+
+HEADERS  += \
+  ./Benchmarks.h \
+  ../src/ArrayRangeEngine.h \
+  ../src/DatasetRegistry.h \
+  ../src/ExternalArray.h \
+  ../src/Geometry.h \
+  ../src/GeometryCache.h \
+  ../src/GeometryLoader.h \
+  ../src/GeometryPart.h \
+  ../src/GeometryPartRepresentation.h \
+  ../src/LODProxySet.h \
+  ../src/ParallelBandedContourFilter.h \
+  ../src/PartBanding.h \
+  ../src/PartBatch.h \
+  ../src/PartCache.h \
+  ../src/PartHierarchy.h \
+  ../src/PartLocator.h \
+  ../src/PrecisionConverter.h \
+  ../src/ProbeEngine.h \
+  ../src/PlotHD.h \
+  ../src/PlotPool.h \
+  ../src/RedrawScheduler.h \
+  ../src/TimeSeriesPlayer.h \
+  ../src/Tracer.h
+
+include(../vtk7.pri)
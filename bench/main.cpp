@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "Benchmarks.h"
+
+#include <QApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstdio>
+
+//------------------------------------------------------------------------------
+
+QList<int> parseList(const QString& value)
+{
+  QList<int> values;
+
+  for( const QString& item : value.split(',', QString::SkipEmptyParts) )
+  {
+    values << item.toInt();
+  }
+
+  return values;
+}
+
+//------------------------------------------------------------------------------
+
+void printUsage(const QString& program)
+{
+  std::fprintf(stderr,
+    "Usage: %s [options]\n"
+    "  --sizes a,b,c    cells per edge of the representation meshes\n"
+    "  --bands a,b,c    band counts of the dataset benchmark\n"
+    "  --parts N        parts of the addPart/addGeometry benchmarks\n"
+    "  --part-size N    cells per edge of every part\n"
+    "  --fields N       point fields of every part\n"
+    "  --repeat N       timed runs of every benchmark\n"
+    "  --filter TEXT    only run benchmarks whose name contains TEXT\n"
+    "  --gui            also run PlotHD::addGeometry and the render\n"
+    "                   benchmarks (need a display)\n"
+    "  --output FILE    write the JSON results to FILE instead of stdout\n",
+    qPrintable(program));
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  bool gui = false;
+
+  for( int i = 1; i < argc; ++i )
+  {
+    gui = gui || (QString(argv[i]) == "--gui");
+  }
+
+  QApplication app(argc, argv, gui);
+
+  const QStringList args = app.arguments();
+
+  Benchmarks::Options options;
+  options.m_gui = gui;
+
+  QString outputFile;
+
+  for( int i = 1; i < args.size(); ++i )
+  {
+    const QString& arg   = args[i];
+    const QString  value = args.value(i + 1);
+
+    if( arg == "--gui" )
+    {
+      continue;
+    }
+    else if( value.isEmpty() )
+    {
+      printUsage(args[0]);
+      return 1;
+    }
+
+    if( arg == "--sizes" )
+    {
+      options.m_meshSizes = parseList(value);
+    }
+    else if( arg == "--bands" )
+    {
+      options.m_nofBands = parseList(value);
+    }
+    else if( arg == "--parts" )
+    {
+      options.m_nofParts = value.toInt();
+    }
+    else if( arg == "--part-size" )
+    {
+      options.m_partSize = value.toInt();
+    }
+    else if( arg == "--fields" )
+    {
+      options.m_nofFields = value.toInt();
+    }
+    else if( arg == "--repeat" )
+    {
+      options.m_nofRepeats = value.toInt();
+    }
+    else if( arg == "--filter" )
+    {
+      options.m_filter = value;
+    }
+    else if( arg == "--output" )
+    {
+      outputFile = value;
+    }
+    else
+    {
+      printUsage(args[0]);
+      return 1;
+    }
+
+    ++i;
+  }
+
+  options.m_nofRepeats = std::max(options.m_nofRepeats, 1);
+  options.m_nofFields  = std::max(options.m_nofFields, 1);
+  options.m_partSize   = std::max(options.m_partSize, 1);
+
+  Benchmarks benchmarks(options);
+  benchmarks.run();
+
+  const QString json = benchmarks.toJson();
+
+  if( outputFile.isEmpty() )
+  {
+    QTextStream(stdout) << json;
+    return 0;
+  }
+
+  QFile file(outputFile);
+
+  if( !file.open(QIODevice::WriteOnly | QIODevice::Text) )
+  {
+    qWarning("Could not write '%s'", qPrintable(outputFile));
+    return 1;
+  }
+
+  QTextStream(&file) << json;
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
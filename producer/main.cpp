@@ -0,0 +1,469 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+// Writes a few hexahedral boxes with moving fields into a POSIX shared-memory
+// segment with the layout of src/LiveSegment.h, advancing the generation at a
+// fixed rate. Every --remesh-every steps the boxes are refined or coarsened,
+// which changes their topology. A new topology is written to the other of
+// two banks of buffers, the one a viewer may still wrap is left alone.
+
+#include "LiveSegment.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+const unsigned char VtkHexahedron = 12;
+const int           NofFields     = 3;
+const int           NofBanks      = 2;
+
+volatile sig_atomic_t s_stop = 0;
+
+void stop(int)
+{
+  s_stop = 1;
+}
+
+struct Options
+{
+  Options()
+    :
+    m_name("/qtvtk_live"),
+    m_nofParts(4),
+    m_size(32),
+    m_rate(20.0),
+    m_remeshEvery(200),
+    m_nofSteps(0)
+  {
+  }
+
+  std::string m_name;
+  int         m_nofParts;
+  int         m_size;         // Cells per edge
+  double      m_rate;         // Generations per second
+  int         m_remeshEvery;
+  int         m_nofSteps;     // 0 runs until interrupted
+};
+
+struct PartLayout
+{
+  uint64_t m_record;
+  uint64_t m_points;
+  uint64_t m_connectivity;
+  uint64_t m_cellTypes;
+  uint64_t m_fieldRecords;
+  uint64_t m_fields[NofFields];
+};
+
+uint64_t align(uint64_t offset)
+{
+  return (offset + 63) & ~uint64_t(63);
+}
+
+// Layout of every part for boxes of size^3 cells in the buffers starting at
+// offset, returns the end of the buffers
+uint64_t computeLayout(
+  int nofParts,
+  int size,
+  uint64_t offset,
+  std::vector<PartLayout>& layouts)
+{
+  const uint64_t nofPoints = uint64_t(size + 1) * (size + 1) * (size + 1);
+  const uint64_t nofCells  = uint64_t(size) * size * size;
+
+  layouts.resize(nofParts);
+
+  for( int p = 0; p < nofParts; ++p )
+  {
+    layouts[p].m_record =
+      sizeof(LiveSegmentHeader) + p * sizeof(LivePartRecord);
+  }
+
+  for( int p = 0; p < nofParts; ++p )
+  {
+    PartLayout& layout = layouts[p];
+
+    layout.m_points       = align(offset);
+    layout.m_connectivity = align(layout.m_points + nofPoints * 3 * 4);
+    layout.m_cellTypes    = align(layout.m_connectivity + nofCells * 9 * 8);
+    layout.m_fieldRecords = align(layout.m_cellTypes + nofCells);
+
+    offset = layout.m_fieldRecords + NofFields * sizeof(LiveFieldRecord);
+
+    // Temperature and Velocity on points, Pressure on cells
+    layout.m_fields[0] = align(offset);
+    layout.m_fields[1] = align(layout.m_fields[0] + nofPoints * 4);
+    layout.m_fields[2] = align(layout.m_fields[1] + nofPoints * 3 * 4);
+
+    offset = layout.m_fields[2] + nofCells * 4;
+  }
+
+  return align(offset);
+}
+
+// Start of the buffers of a bank, every bank fits boxes of maxSize^3 cells
+uint64_t bankOffset(int nofParts, int maxSize, int bank)
+{
+  std::vector<PartLayout> layouts;
+
+  const uint64_t records =
+    align(sizeof(LiveSegmentHeader) + nofParts * sizeof(LivePartRecord));
+  const uint64_t bankSize =
+    computeLayout(nofParts, maxSize, records, layouts) - records;
+
+  return records + bank * bankSize;
+}
+
+void setName(char* target, const std::string& name)
+{
+  std::memset(target, 0, LiveNameSize);
+  std::strncpy(target, name.c_str(), LiveNameSize - 1);
+}
+
+void writeTopology(
+  char* base,
+  const PartLayout& layout,
+  int part,
+  int size,
+  uint64_t topology)
+{
+  const uint64_t n         = size + 1;
+  const uint64_t nofPoints = n * n * n;
+  const uint64_t nofCells  = uint64_t(size) * size * size;
+
+  LivePartRecord* record =
+    reinterpret_cast<LivePartRecord*>(base + layout.m_record);
+
+  setName(record->m_name, "Box_" + std::to_string(part));
+  record->m_topology           = topology;
+  record->m_nofPoints          = nofPoints;
+  record->m_nofCells           = nofCells;
+  record->m_pointsOffset       = layout.m_points;
+  record->m_connectivityOffset = layout.m_connectivity;
+  record->m_connectivitySize   = nofCells * 9;
+  record->m_cellTypesOffset    = layout.m_cellTypes;
+  record->m_nofFields          = NofFields;
+  record->m_padding            = 0;
+  record->m_fieldsOffset       = layout.m_fieldRecords;
+
+  int64_t* cell = reinterpret_cast<int64_t*>(base + layout.m_connectivity);
+
+  for( uint64_t k = 0; k < uint64_t(size); ++k )
+  {
+    for( uint64_t j = 0; j < uint64_t(size); ++j )
+    {
+      for( uint64_t i = 0; i < uint64_t(size); ++i )
+      {
+        const int64_t c = i + n * (j + n * k);
+
+        *cell++ = 8;
+        *cell++ = c;
+        *cell++ = c + 1;
+        *cell++ = c + 1 + n;
+        *cell++ = c + n;
+        *cell++ = c + n * n;
+        *cell++ = c + 1 + n * n;
+        *cell++ = c + 1 + n + n * n;
+        *cell++ = c + n + n * n;
+      }
+    }
+  }
+
+  std::memset(base + layout.m_cellTypes, VtkHexahedron, nofCells);
+
+  LiveFieldRecord* fields =
+    reinterpret_cast<LiveFieldRecord*>(base + layout.m_fieldRecords);
+
+  const char*    names[NofFields]        = {
+    "Temperature",
+    "Velocity",
+    "Pressure"};
+  const uint32_t associations[NofFields] = {
+    LiveFieldRecord::POINT_DATA,
+    LiveFieldRecord::POINT_DATA,
+    LiveFieldRecord::CELL_DATA};
+  const uint32_t components[NofFields]   = {1, 3, 1};
+
+  for( int f = 0; f < NofFields; ++f )
+  {
+    setName(fields[f].m_name, names[f]);
+    fields[f].m_association   = associations[f];
+    fields[f].m_nofComponents = components[f];
+    fields[f].m_offset        = layout.m_fields[f];
+  }
+}
+
+void writeValues(
+  char* base,
+  const PartLayout& layout,
+  int part,
+  int size,
+  double time)
+{
+  const uint64_t n  = size + 1;
+  const double   dx = 1.0 / size;
+
+  float* points      = reinterpret_cast<float*>(base + layout.m_points);
+  float* temperature = reinterpret_cast<float*>(base + layout.m_fields[0]);
+  float* velocity    = reinterpret_cast<float*>(base + layout.m_fields[1]);
+  float* pressure    = reinterpret_cast<float*>(base + layout.m_fields[2]);
+
+  for( uint64_t k = 0; k < n; ++k )
+  {
+    for( uint64_t j = 0; j < n; ++j )
+    {
+      for( uint64_t i = 0; i < n; ++i )
+      {
+        const uint64_t id = i + n * (j + n * k);
+
+        const double x = 1.1 * part + i * dx;
+        const double y = j * dx;
+        const double z = k * dx;
+
+        // The top of the boxes waves
+        points[3*id]     = float(x);
+        points[3*id + 1] = float(y);
+        points[3*id + 2] = float(z * (1.0 + 0.1 * std::sin(2.0 * x + time)));
+
+        temperature[id] = float(std::sin(4.0 * x - time) * std::cos(3.0 * y));
+
+        velocity[3*id]     = float(-(y - 0.5));
+        velocity[3*id + 1] = float(x - 0.5 - 1.1 * part);
+        velocity[3*id + 2] = float(0.2 * std::sin(time));
+      }
+    }
+  }
+
+  const uint64_t nofCells = uint64_t(size) * size * size;
+
+  for( uint64_t c = 0; c < nofCells; ++c )
+  {
+    pressure[c] = float(std::cos(0.01 * c + time));
+  }
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+  for( int i = 1; i < argc; ++i )
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1 < argc);
+
+    if( (arg == "--name") && hasValue )
+    {
+      options.m_name = argv[++i];
+    }
+    else if( (arg == "--parts") && hasValue )
+    {
+      options.m_nofParts = std::atoi(argv[++i]);
+    }
+    else if( (arg == "--size") && hasValue )
+    {
+      options.m_size = std::atoi(argv[++i]);
+    }
+    else if( (arg == "--rate") && hasValue )
+    {
+      options.m_rate = std::atof(argv[++i]);
+    }
+    else if( (arg == "--remesh-every") && hasValue )
+    {
+      options.m_remeshEvery = std::atoi(argv[++i]);
+    }
+    else if( (arg == "--steps") && hasValue )
+    {
+      options.m_nofSteps = std::atoi(argv[++i]);
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  if( options.m_name.empty() || (options.m_name[0] != '/') )
+  {
+    options.m_name = "/" + options.m_name;
+  }
+
+  return (options.m_nofParts > 0) && (options.m_size > 0) &&
+    (options.m_rate > 0.0) && (options.m_remeshEvery >= 0) &&
+    (options.m_nofSteps >= 0);
+}
+
+void printUsage(const char* program)
+{
+  std::fprintf(stderr,
+    "Usage: %s [options]\n"
+    "  --name NAME         shared memory segment (default /qtvtk_live)\n"
+    "  --parts N           boxes (default 4)\n"
+    "  --size N            cells per edge of every box (default 32)\n"
+    "  --rate HZ           generations per second (default 20)\n"
+    "  --remesh-every N    steps between topology changes, 0 never\n"
+    "  --steps N           steps before exiting, 0 until interrupted\n",
+    program);
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  Options options;
+
+  if( !parseOptions(argc, argv, options) )
+  {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  const int fd = shm_open(options.m_name.c_str(), O_CREAT | O_RDWR, 0600);
+
+  if( fd < 0 )
+  {
+    std::perror("shm_open");
+    return 1;
+  }
+
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  std::vector<PartLayout> layouts;
+
+  const int maxSize = options.m_size + 1;
+
+  // A segment left by a previous run may still be mapped by a viewer, it is
+  // never made smaller (see LiveSegment.h)
+  struct stat info;
+  uint64_t mappedSize =
+    bankOffset(options.m_nofParts, maxSize, NofBanks);
+
+  if( (fstat(fd, &info) == 0) && (uint64_t(info.st_size) > mappedSize) )
+  {
+    mappedSize = info.st_size;
+  }
+  else if( ftruncate(fd, mappedSize) != 0 )
+  {
+    std::perror("ftruncate");
+    close(fd);
+    return 1;
+  }
+
+  void* data = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+    MAP_SHARED, fd, 0);
+
+  if( data == MAP_FAILED )
+  {
+    std::perror("mmap");
+    close(fd);
+    return 1;
+  }
+
+  char*    base        = static_cast<char*>(data);
+  uint64_t generation  = 0;
+  uint64_t topology    = 0;
+  int      size        = options.m_size;
+  bool     remesh      = true;
+
+  const auto period = std::chrono::duration<double>(1.0 / options.m_rate);
+  const auto start  = std::chrono::steady_clock::now();
+
+  for( int step = 0; !s_stop &&
+       ((options.m_nofSteps == 0) || (step < options.m_nofSteps)); ++step )
+  {
+    if( (options.m_remeshEvery > 0) && (step > 0) &&
+        ((step % options.m_remeshEvery) == 0) )
+    {
+      size   = (size == options.m_size)? options.m_size + 1 : options.m_size;
+      remesh = true;
+    }
+
+    LiveSegmentHeader* header = reinterpret_cast<LiveSegmentHeader*>(base);
+
+    // Odd while writing
+    StoreLiveGeneration(header, ++generation);
+
+    std::memcpy(header->m_magic, LiveSegmentMagic, sizeof(LiveSegmentMagic));
+    header->m_version     = LiveSegmentVersion;
+    header->m_idTypeSize  = sizeof(int64_t);
+    header->m_segmentSize = mappedSize;
+    header->m_nofParts    = options.m_nofParts;
+    header->m_padding     = 0;
+
+    const double time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+        .count();
+
+    header->m_time = time;
+
+    if( remesh )
+    {
+      ++topology;
+
+      // Viewers wrapping the previous topology keep reading the other bank
+      // until they see the new records
+      computeLayout(
+        options.m_nofParts,
+        size,
+        bankOffset(options.m_nofParts, maxSize, topology % NofBanks),
+        layouts);
+
+      for( int p = 0; p < options.m_nofParts; ++p )
+      {
+        writeTopology(base, layouts[p], p, size, topology);
+      }
+
+      remesh = false;
+    }
+
+    for( int p = 0; p < options.m_nofParts; ++p )
+    {
+      writeValues(base, layouts[p], p, size, time);
+    }
+
+    StoreLiveGeneration(header, ++generation);
+
+    std::this_thread::sleep_until(start + (step + 1) * period);
+  }
+
+  munmap(base, mappedSize);
+
+  close(fd);
+  shm_unlink(options.m_name.c_str());
+
+  return 0;
+}
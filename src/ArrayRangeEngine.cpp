@@ -0,0 +1,636 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "ArrayRangeEngine.h"
+
+#include <QMutexLocker>
+
+#include <vtkDataArray.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+// Tuples per task: large enough to amortize the scheduling, small enough for
+// the chunk of every scanned array to stay in cache while it is processed.
+const vtkIdType RangeScanGrain = 32768;
+
+//------------------------------------------------------------------------------
+
+class RangeScanner
+{
+public:
+  RangeScanner(vtkIdType nofTuples, int nofComponents)
+    :
+    m_nofTuples(nofTuples),
+    m_nofComponents(nofComponents)
+  {
+  }
+
+  virtual ~RangeScanner()
+  {
+  }
+
+  // result holds [min, max] per component followed by the [min, max] of the
+  // squared magnitude
+  virtual void scan(vtkIdType begin, vtkIdType end, double* result) const = 0;
+
+  int getResultSize() const
+  {
+    return 2 * m_nofComponents + 2;
+  }
+
+  vtkIdType m_nofTuples;
+  int       m_nofComponents;
+};
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+class TypedRangeScanner : public RangeScanner
+{
+public:
+  TypedRangeScanner(const T* data, vtkIdType nofTuples, int nofComponents)
+    :
+    RangeScanner(nofTuples, nofComponents),
+    m_data(data)
+  {
+  }
+
+  virtual void scan(vtkIdType begin, vtkIdType end, double* result) const
+  {
+    end = std::min(end, m_nofTuples);
+
+    if( begin >= end )
+    {
+      return;
+    }
+
+    if( m_nofComponents == 1 )
+    {
+      scanScalars(m_data + begin, end - begin, result);
+      return;
+    }
+
+    const int nc = m_nofComponents;
+    double* magnitude = result + 2 * nc;
+
+    for( vtkIdType t = begin; t < end; ++t )
+    {
+      const T* tuple = m_data + t * nc;
+      double   mag2  = 0.0;
+
+      for( int c = 0; c < nc; ++c )
+      {
+        const double v = static_cast<double>(tuple[c]);
+
+        result[2 * c]     = (v < result[2 * c])?     v : result[2 * c];
+        result[2 * c + 1] = (v > result[2 * c + 1])? v : result[2 * c + 1];
+
+        mag2 += v * v;
+      }
+
+      magnitude[0] = (mag2 < magnitude[0])? mag2 : magnitude[0];
+      magnitude[1] = (mag2 > magnitude[1])? mag2 : magnitude[1];
+    }
+  }
+
+protected:
+  void scanScalars(const T* values, vtkIdType n, double* result) const
+  {
+    // Four independent accumulators break the dependency chain so the
+    // compiler can keep them in vector registers
+    double lo[4]    = {result[0], result[0], result[0], result[0]};
+    double hi[4]    = {result[1], result[1], result[1], result[1]};
+    double absLo[4] = {
+      std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::max()};
+
+    vtkIdType i = 0;
+
+    for( ; i + 4 <= n; i += 4 )
+    {
+      for( int l = 0; l < 4; ++l )
+      {
+        const double v = static_cast<double>(values[i + l]);
+        const double a = std::fabs(v);
+
+        lo[l]    = (v < lo[l])?    v : lo[l];
+        hi[l]    = (v > hi[l])?    v : hi[l];
+        absLo[l] = (a < absLo[l])? a : absLo[l];
+      }
+    }
+
+    for( ; i < n; ++i )
+    {
+      const double v = static_cast<double>(values[i]);
+      const double a = std::fabs(v);
+
+      lo[0]    = (v < lo[0])?    v : lo[0];
+      hi[0]    = (v > hi[0])?    v : hi[0];
+      absLo[0] = (a < absLo[0])? a : absLo[0];
+    }
+
+    finishScalars(lo, hi, absLo, result);
+  }
+
+  // For a single component the squared magnitude range follows from the
+  // smallest absolute value and the component range
+  static void finishScalars(
+    const double* lo,
+    const double* hi,
+    const double* absLo,
+    double* result)
+  {
+    result[0] = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+    result[1] = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+
+    if( result[0] > result[1] )
+    {
+      return;
+    }
+
+    const double minAbs =
+      std::min(std::min(absLo[0], absLo[1]), std::min(absLo[2], absLo[3]));
+    const double maxAbs = std::max(std::fabs(result[0]), std::fabs(result[1]));
+
+    result[2] = std::min(result[2], minAbs * minAbs);
+    result[3] = std::max(result[3], maxAbs * maxAbs);
+  }
+
+  const T* m_data;
+};
+
+//------------------------------------------------------------------------------
+
+#if defined(__SSE2__)
+
+// _mm_min_pd/_mm_max_pd return the second operand when any of them is NaN,
+// keeping the accumulator as second operand skips NaN values like
+// vtkDataArray::GetRange does.
+
+template <>
+void TypedRangeScanner<double>::scanScalars(
+  const double* values,
+  vtkIdType n,
+  double* result) const
+{
+  const __m128d absMask =
+    _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+
+  __m128d lo0    = _mm_set1_pd(result[0]);
+  __m128d lo1    = lo0;
+  __m128d hi0    = _mm_set1_pd(result[1]);
+  __m128d hi1    = hi0;
+  __m128d absLo0 = _mm_set1_pd(std::numeric_limits<double>::max());
+  __m128d absLo1 = absLo0;
+
+  vtkIdType i = 0;
+
+  for( ; i + 4 <= n; i += 4 )
+  {
+    const __m128d v0 = _mm_loadu_pd(values + i);
+    const __m128d v1 = _mm_loadu_pd(values + i + 2);
+
+    lo0    = _mm_min_pd(v0, lo0);
+    lo1    = _mm_min_pd(v1, lo1);
+    hi0    = _mm_max_pd(v0, hi0);
+    hi1    = _mm_max_pd(v1, hi1);
+    absLo0 = _mm_min_pd(_mm_and_pd(v0, absMask), absLo0);
+    absLo1 = _mm_min_pd(_mm_and_pd(v1, absMask), absLo1);
+  }
+
+  double lo[4];
+  double hi[4];
+  double absLo[4];
+
+  _mm_storeu_pd(lo, lo0);
+  _mm_storeu_pd(lo + 2, lo1);
+  _mm_storeu_pd(hi, hi0);
+  _mm_storeu_pd(hi + 2, hi1);
+  _mm_storeu_pd(absLo, absLo0);
+  _mm_storeu_pd(absLo + 2, absLo1);
+
+  for( ; i < n; ++i )
+  {
+    const double a = std::fabs(values[i]);
+
+    lo[0]    = (values[i] < lo[0])? values[i] : lo[0];
+    hi[0]    = (values[i] > hi[0])? values[i] : hi[0];
+    absLo[0] = (a < absLo[0])?      a         : absLo[0];
+  }
+
+  finishScalars(lo, hi, absLo, result);
+}
+
+//------------------------------------------------------------------------------
+
+template <>
+void TypedRangeScanner<float>::scanScalars(
+  const float* values,
+  vtkIdType n,
+  double* result) const
+{
+  // Float accumulators are exact since every value is a float, the initial
+  // +/- DBL_MAX limits become +/- infinity
+  const float inf      = std::numeric_limits<float>::infinity();
+  const float floatMax = std::numeric_limits<float>::max();
+
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+  __m128 lo4 = _mm_set1_ps(
+    (result[0] > floatMax)? inf : static_cast<float>(result[0]));
+  __m128 hi4 = _mm_set1_ps(
+    (result[1] < -floatMax)? -inf : static_cast<float>(result[1]));
+  __m128 absLo4 = _mm_set1_ps(inf);
+
+  vtkIdType i = 0;
+
+  for( ; i + 4 <= n; i += 4 )
+  {
+    const __m128 v = _mm_loadu_ps(values + i);
+
+    lo4    = _mm_min_ps(v, lo4);
+    hi4    = _mm_max_ps(v, hi4);
+    absLo4 = _mm_min_ps(_mm_and_ps(v, absMask), absLo4);
+  }
+
+  float loF[4];
+  float hiF[4];
+  float absLoF[4];
+
+  _mm_storeu_ps(loF, lo4);
+  _mm_storeu_ps(hiF, hi4);
+  _mm_storeu_ps(absLoF, absLo4);
+
+  double lo[4];
+  double hi[4];
+  double absLo[4];
+
+  for( int l = 0; l < 4; ++l )
+  {
+    lo[l]    = std::min(static_cast<double>(loF[l]), result[0]);
+    hi[l]    = std::max(static_cast<double>(hiF[l]), result[1]);
+    absLo[l] = static_cast<double>(absLoF[l]);
+  }
+
+  for( ; i < n; ++i )
+  {
+    const double v = static_cast<double>(values[i]);
+    const double a = std::fabs(v);
+
+    lo[0]    = (v < lo[0])?    v : lo[0];
+    hi[0]    = (v > hi[0])?    v : hi[0];
+    absLo[0] = (a < absLo[0])? a : absLo[0];
+  }
+
+  finishScalars(lo, hi, absLo, result);
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+// Fallback for arrays without the standard (array of structures) layout
+class GenericRangeScanner : public RangeScanner
+{
+public:
+  explicit GenericRangeScanner(vtkDataArray* arr)
+    :
+    RangeScanner(arr->GetNumberOfTuples(), arr->GetNumberOfComponents()),
+    m_array(arr)
+  {
+  }
+
+  virtual void scan(vtkIdType begin, vtkIdType end, double* result) const
+  {
+    end = std::min(end, m_nofTuples);
+
+    const int nc = m_nofComponents;
+    double* magnitude = result + 2 * nc;
+
+    for( vtkIdType t = begin; t < end; ++t )
+    {
+      double mag2 = 0.0;
+
+      for( int c = 0; c < nc; ++c )
+      {
+        const double v = m_array->GetComponent(t, c);
+
+        result[2 * c]     = (v < result[2 * c])?     v : result[2 * c];
+        result[2 * c + 1] = (v > result[2 * c + 1])? v : result[2 * c + 1];
+
+        mag2 += v * v;
+      }
+
+      magnitude[0] = (mag2 < magnitude[0])? mag2 : magnitude[0];
+      magnitude[1] = (mag2 > magnitude[1])? mag2 : magnitude[1];
+    }
+  }
+
+protected:
+  vtkDataArray* m_array;
+};
+
+//------------------------------------------------------------------------------
+
+class RangeScanFunctor
+{
+public:
+  explicit RangeScanFunctor(const std::vector<RangeScanner*>& scanners)
+    :
+    m_scanners(scanners),
+    m_resultSize(0)
+  {
+    for( RangeScanner* scanner : m_scanners )
+    {
+      m_offsets.push_back(m_resultSize);
+      m_resultSize += scanner->getResultSize();
+    }
+
+    initializeResult(m_result);
+  }
+
+  void Initialize()
+  {
+    initializeResult(m_threadResult.Local());
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::vector<double>& result = m_threadResult.Local();
+
+    // All arrays are scanned for the same tuple chunk before moving on
+    for( size_t s = 0; s < m_scanners.size(); ++s )
+    {
+      m_scanners[s]->scan(begin, end, &result[m_offsets[s]]);
+    }
+  }
+
+  void Reduce()
+  {
+    for( auto it = m_threadResult.begin(); it != m_threadResult.end(); ++it )
+    {
+      const std::vector<double>& local = *it;
+
+      for( size_t i = 0; i < m_resultSize; i += 2 )
+      {
+        m_result[i]     = std::min(m_result[i], local[i]);
+        m_result[i + 1] = std::max(m_result[i + 1], local[i + 1]);
+      }
+    }
+  }
+
+  const double* getResult(size_t scanner) const
+  {
+    return &m_result[m_offsets[scanner]];
+  }
+
+protected:
+  void initializeResult(std::vector<double>& result) const
+  {
+    result.resize(m_resultSize);
+
+    for( size_t i = 0; i < m_resultSize; i += 2 )
+    {
+      result[i]     = std::numeric_limits<double>::max();
+      result[i + 1] = -std::numeric_limits<double>::max();
+    }
+  }
+
+  const std::vector<RangeScanner*>&        m_scanners;
+  std::vector<size_t>                      m_offsets;
+  size_t                                   m_resultSize;
+  std::vector<double>                      m_result;
+  vtkSMPThreadLocal<std::vector<double>>   m_threadResult;
+};
+
+//------------------------------------------------------------------------------
+
+RangeScanner* createScanner(vtkDataArray* arr)
+{
+  if( !arr->HasStandardMemoryLayout() )
+  {
+    return new GenericRangeScanner(arr);
+  }
+
+  RangeScanner* scanner = nullptr;
+
+  switch( arr->GetDataType() )
+  {
+    vtkTemplateMacro(
+      scanner = new TypedRangeScanner<VTK_TT>(
+        static_cast<const VTK_TT*>(arr->GetVoidPointer(0)),
+        arr->GetNumberOfTuples(),
+        arr->GetNumberOfComponents()));
+
+    default:
+      scanner = new GenericRangeScanner(arr);
+  }
+
+  return scanner;
+}
+
+//------------------------------------------------------------------------------
+
+ArrayRange::ArrayRange()
+  :
+  m_nofComponents(0),
+  m_magnitudeRange{
+    std::numeric_limits<double>::max(),
+    -std::numeric_limits<double>::max()}
+{
+}
+
+//------------------------------------------------------------------------------
+
+const double* ArrayRange::getComponentRange(int component) const
+{
+  if( (component < 0) || (component >= m_nofComponents) )
+  {
+    return nullptr;
+  }
+
+  return &m_componentRanges[2 * component];
+}
+
+//------------------------------------------------------------------------------
+
+const double* ArrayRange::getMagnitudeRange() const
+{
+  return m_magnitudeRange;
+}
+
+//------------------------------------------------------------------------------
+
+ArrayRangeEngine::ArrayRangeEngine()
+{
+}
+
+//------------------------------------------------------------------------------
+
+std::vector<ArrayRange> ArrayRangeEngine::computeRanges(
+  vtkDataSetAttributes* att)
+{
+  std::vector<ArrayRange> ranges;
+
+  if( !att )
+  {
+    return ranges;
+  }
+
+  std::vector<vtkDataArray*> arrays;
+
+  for( int i = 0; i < att->GetNumberOfArrays(); ++i )
+  {
+    if( vtkDataArray* arr = att->GetArray(i) )
+    {
+      arrays.push_back(arr);
+    }
+  }
+
+  ranges.resize(arrays.size());
+
+  std::vector<vtkDataArray*> outdated;
+  std::vector<size_t>        outdatedIndices;
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    for( size_t i = 0; i < arrays.size(); ++i )
+    {
+      auto it = m_cache.find(arrays[i]);
+
+      if( (it != m_cache.end()) &&
+          (it->m_array.GetPointer() == arrays[i]) &&
+          (it->m_mTime == arrays[i]->GetMTime()) )
+      {
+        ranges[i] = it->m_range;
+        ranges[i].m_name = arrays[i]->GetName();
+      }
+      else
+      {
+        outdated.push_back(arrays[i]);
+        outdatedIndices.push_back(i);
+      }
+    }
+  }
+
+  if( outdated.empty() )
+  {
+    return ranges;
+  }
+
+  std::vector<ArrayRange> computed = ComputeRanges(outdated);
+
+  QMutexLocker locker(&m_mutex);
+
+  // Drop the entries of deleted arrays before their address gets reused
+  for( auto it = m_cache.begin(); it != m_cache.end(); )
+  {
+    if( !it->m_array )
+    {
+      it = m_cache.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  for( size_t i = 0; i < outdated.size(); ++i )
+  {
+    ranges[outdatedIndices[i]] = computed[i];
+
+    CacheEntry& entry = m_cache[outdated[i]];
+    entry.m_array = outdated[i];
+    entry.m_mTime = outdated[i]->GetMTime();
+    entry.m_range = computed[i];
+  }
+
+  return ranges;
+}
+
+//------------------------------------------------------------------------------
+
+void ArrayRangeEngine::clear()
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_cache.clear();
+}
+
+//------------------------------------------------------------------------------
+
+std::vector<ArrayRange> ArrayRangeEngine::ComputeRanges(
+  const std::vector<vtkDataArray*>& arrays)
+{
+  std::vector<ArrayRange> ranges(arrays.size());
+  std::vector<std::unique_ptr<RangeScanner>> scannerOwners;
+  std::vector<RangeScanner*> scanners;
+
+  vtkIdType nofTuples = 0;
+
+  for( vtkDataArray* arr : arrays )
+  {
+    scannerOwners.push_back(std::unique_ptr<RangeScanner>(createScanner(arr)));
+    scanners.push_back(scannerOwners.back().get());
+
+    nofTuples = std::max(nofTuples, arr->GetNumberOfTuples());
+  }
+
+  RangeScanFunctor functor(scanners);
+  vtkSMPTools::For(0, nofTuples, RangeScanGrain, functor);
+
+  for( size_t i = 0; i < arrays.size(); ++i )
+  {
+    const double* result = functor.getResult(i);
+    const int     nc     = arrays[i]->GetNumberOfComponents();
+
+    ArrayRange& range = ranges[i];
+    range.m_name          = arrays[i]->GetName();
+    range.m_nofComponents = nc;
+    range.m_componentRanges.assign(result, result + 2 * nc);
+
+    if( result[2 * nc] <= result[2 * nc + 1] )
+    {
+      range.m_magnitudeRange[0] = std::sqrt(result[2 * nc]);
+      range.m_magnitudeRange[1] = std::sqrt(result[2 * nc + 1]);
+    }
+  }
+
+  return ranges;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef ARRAYRANGEENGINE_H
+#define ARRAYRANGEENGINE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <vtkType.h>
+#include <vtkWeakPointer.h>
+
+#include <vector>
+
+class vtkDataArray;
+class vtkDataSetAttributes;
+
+struct ArrayRange
+{
+  ArrayRange();
+
+  const double* getComponentRange(int component) const;
+  const double* getMagnitudeRange() const;
+
+  QString             m_name;
+  int                 m_nofComponents;
+  std::vector<double> m_componentRanges;
+  double              m_magnitudeRange[2];
+};
+
+// Computes the per-component and magnitude ranges of all the arrays of a
+// vtkDataSetAttributes in one pass over the tuples, split across threads with
+// vtkSMPTools::For and merged from per-thread ranges (parallel only with a
+// TBB or OpenMP backend). Results are cached per array and only recomputed
+// when the array MTime changes.
+class ArrayRangeEngine
+{
+public:
+  ArrayRangeEngine();
+
+  std::vector<ArrayRange> computeRanges(vtkDataSetAttributes* att);
+  void clear();
+
+  static std::vector<ArrayRange> ComputeRanges(
+    const std::vector<vtkDataArray*>& arrays);
+
+protected:
+  struct CacheEntry
+  {
+    vtkWeakPointer<vtkDataArray> m_array;
+    vtkMTimeType                 m_mTime;
+    ArrayRange                   m_range;
+  };
+
+  QMutex                           m_mutex;
+  QHash<vtkDataArray*, CacheEntry> m_cache;
+};
+
+#endif // ARRAYRANGEENGINE_H
@@ -0,0 +1,388 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "BatchRenderer.h"
+
+#include "Geometry.h"
+#include "GeometryFactory.h"
+#include "GeometryPartRepresentation.h"
+#include "Tracer.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QRunnable>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <vtkPNGWriter.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+#include <vtkWindowToImageFilter.h>
+
+#include <algorithm>
+#include <cstdio>
+
+//------------------------------------------------------------------------------
+
+class BatchRenderer::Worker : public QRunnable
+{
+public:
+  Worker(BatchRenderer* batch, const QList<Job>& jobs)
+    :
+    m_batch(batch),
+    m_jobs(jobs)
+  {
+  }
+
+  virtual void run()
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    const QString& source = m_jobs.first().m_geometryFile;
+
+    std::shared_ptr<Geometry> geom =
+      GeometryFactory::IsProceduralSpec(source)?
+        GeometryFactory::CreateProceduralGeometry(source) :
+        GeometryFactory::CreateGeometryFromFile(source);
+
+    if( !geom )
+    {
+      qWarning("Could not read '%s'",
+        qPrintable(m_jobs.first().m_geometryFile));
+
+      for( const Job& job : m_jobs )
+      {
+        m_batch->jobDone(job, false, 0.0);
+      }
+
+      return;
+    }
+
+    // No event loop in this thread, the parts are published right here
+    geom->waitForLoaded();
+
+    // One renderer per worker, reused by all the jobs of the geometry
+    vtkSmartPointer<vtkRenderer> renderer =
+      vtkSmartPointer<vtkRenderer>::New();
+    renderer->SetBackground(1, .714, .757);
+
+    vtkSmartPointer<vtkRenderWindow> renWin =
+      vtkSmartPointer<vtkRenderWindow>::New();
+    renWin->SetOffScreenRendering(1);
+    renWin->AddRenderer(renderer);
+
+    std::vector<std::unique_ptr<GeometryPartRepresentation>> reps;
+
+    for( auto part : geom->getParts() )
+    {
+      reps.push_back(std::unique_ptr<GeometryPartRepresentation>(
+        new GeometryPartRepresentation(part, renderer.Get())));
+    }
+
+    bool cameraReset = false;
+
+    for( const Job& job : m_jobs )
+    {
+      const DatasetHandle dataset = geom->findDataset(job.m_datasetName);
+
+      if( !dataset.isValid() )
+      {
+        qWarning("No dataset '%s' in '%s'",
+          qPrintable(job.m_datasetName),
+          qPrintable(job.m_geometryFile));
+
+        m_batch->jobDone(job, false, timer.restart() / 1000.0);
+        continue;
+      }
+
+      // Without an event loop the changes are applied right away instead of
+      // waiting for a RedrawEvent or a scheduler tick
+      for( auto& rep : reps )
+      {
+        rep->setDatasetInfo(dataset);
+        rep->setNofBands(job.m_nofBands);
+        rep->setShowDataset(true);
+
+        rep->applyChanges();
+        rep->updatePipeline();
+      }
+
+      renWin->SetSize(job.m_width, job.m_height);
+
+      if( !cameraReset )
+      {
+        renderer->ResetCamera();
+        cameraReset = true;
+      }
+
+      {
+        TRACE_SCOPE("BatchRenderer::render");
+
+        renWin->Render();
+      }
+
+      vtkSmartPointer<vtkWindowToImageFilter> grabber =
+        vtkSmartPointer<vtkWindowToImageFilter>::New();
+      grabber->SetInput(renWin);
+      grabber->ReadFrontBufferOff();
+      grabber->Update();
+
+      vtkSmartPointer<vtkPNGWriter> writer =
+        vtkSmartPointer<vtkPNGWriter>::New();
+      writer->SetFileName(qPrintable(job.m_imageFile));
+      writer->SetInputConnection(grabber->GetOutputPort());
+      writer->Write();
+
+      m_batch->jobDone(job, writer->GetErrorCode() == 0,
+        timer.restart() / 1000.0);
+    }
+
+    // The representations remove their actors from the renderer, which must
+    // still be alive
+    reps.clear();
+  }
+
+protected:
+  BatchRenderer* m_batch;
+  QList<Job>     m_jobs;
+};
+
+//------------------------------------------------------------------------------
+
+BatchRenderer::Job::Job()
+  :
+  m_nofBands(10),
+  m_width(1024),
+  m_height(768)
+{
+}
+
+//------------------------------------------------------------------------------
+
+BatchRenderer::BatchRenderer(int nofWorkers)
+  :
+  m_nofWorkers(nofWorkers > 0? nofWorkers : QThread::idealThreadCount()),
+  m_nofImages(0),
+  m_nofFailures(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool BatchRenderer::ReadJobFile(const QString& fileName, QList<Job>& jobs)
+{
+  QFile file(fileName);
+
+  if( !file.open(QIODevice::ReadOnly | QIODevice::Text) )
+  {
+    qWarning("Could not open job file '%s'", qPrintable(fileName));
+    return false;
+  }
+
+  // Relative paths are relative to the job file
+  const QDir baseDir = QFileInfo(fileName).absoluteDir();
+
+  QTextStream in(&file);
+  int lineNumber = 0;
+
+  while( !in.atEnd() )
+  {
+    const QString line = in.readLine().trimmed();
+    ++lineNumber;
+
+    if( line.isEmpty() || line.startsWith('#') )
+    {
+      continue;
+    }
+
+    const QStringList fields = line.split(QRegExp("\\s+"));
+
+    bool ok = (fields.size() == 4) || (fields.size() == 6);
+
+    Job job;
+
+    if( ok )
+    {
+      job.m_geometryFile = GeometryFactory::IsProceduralSpec(fields[0])?
+        fields[0] : baseDir.absoluteFilePath(fields[0]);
+      job.m_datasetName  = fields[1];
+      job.m_nofBands     = fields[2].toInt(&ok);
+      job.m_imageFile    = baseDir.absoluteFilePath(fields[3]);
+    }
+
+    if( ok && (fields.size() == 6) )
+    {
+      bool widthOk = false, heightOk = false;
+
+      job.m_width  = fields[4].toInt(&widthOk);
+      job.m_height = fields[5].toInt(&heightOk);
+
+      ok = widthOk && heightOk && (job.m_width > 0) && (job.m_height > 0);
+    }
+
+    if( !ok || (job.m_nofBands < 1) )
+    {
+      qWarning("%s:%d: expected 'geometry dataset bands image [width height]'",
+        qPrintable(fileName), lineNumber);
+      return false;
+    }
+
+    jobs << job;
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+int BatchRenderer::run(const QList<Job>& jobs)
+{
+  m_nofImages   = 0;
+  m_nofFailures = 0;
+
+  QMap<QString, QList<Job>> jobsPerGeometry;
+
+  for( const Job& job : jobs )
+  {
+    jobsPerGeometry[job.m_geometryFile] << job;
+  }
+
+  // The parts cache their surfaces and bands in pipelines that are not
+  // thread safe, so workers do not share a geometry. The jobs of a geometry
+  // are split in runs, each run loads the geometry once. A geometry gets
+  // workers in proportion of its share of the jobs, so a single case with
+  // many images still keeps every worker busy.
+  QList<QList<Job>> chunks;
+
+  for( const QList<Job>& geometryJobs : jobsPerGeometry )
+  {
+    const int nofChunks = std::max(1, std::min(geometryJobs.size(),
+      (geometryJobs.size() * m_nofWorkers + jobs.size() - 1) / jobs.size()));
+
+    for( int chunk = 0; chunk < nofChunks; ++chunk )
+    {
+      const int first = chunk * geometryJobs.size() / nofChunks;
+      const int last  = (chunk + 1) * geometryJobs.size() / nofChunks;
+
+      chunks << geometryJobs.mid(first, last - first);
+    }
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(m_nofWorkers);
+
+  for( const QList<Job>& chunkJobs : chunks )
+  {
+    pool.start(new Worker(this, chunkJobs));
+  }
+
+  pool.waitForDone();
+
+  const double seconds = timer.elapsed() / 1000.0;
+
+  std::printf("%d images in %.3f s with %d workers: %.2f images/s\n",
+    m_nofImages,
+    seconds,
+    std::min(m_nofWorkers, chunks.size()),
+    (seconds > 0.0)? m_nofImages / seconds : 0.0);
+
+  if( m_nofFailures > 0 )
+  {
+    std::printf("%d jobs failed\n", m_nofFailures);
+  }
+
+  std::fflush(stdout);
+
+  return m_nofFailures;
+}
+
+//------------------------------------------------------------------------------
+
+int BatchRenderer::Main(const QStringList& arguments)
+{
+  const int batchIndex   = arguments.indexOf("--batch");
+  const int workersIndex = arguments.indexOf("--workers");
+
+  if( (batchIndex < 0) || (batchIndex + 1 >= arguments.size()) )
+  {
+    qWarning("Usage: %s --batch <job file> [--workers <count>]",
+      qPrintable(arguments.value(0)));
+    return 1;
+  }
+
+  int nofWorkers = 0;
+
+  if( (workersIndex >= 0) && (workersIndex + 1 < arguments.size()) )
+  {
+    nofWorkers = arguments[workersIndex + 1].toInt();
+  }
+
+  QList<Job> jobs;
+
+  if( !ReadJobFile(arguments[batchIndex + 1], jobs) )
+  {
+    return 1;
+  }
+
+  BatchRenderer batch(nofWorkers);
+
+  return (batch.run(jobs) == 0)? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+
+void BatchRenderer::jobDone(const Job& job, bool ok, double seconds)
+{
+  QMutexLocker locker(&m_mutex);
+
+  if( ok )
+  {
+    ++m_nofImages;
+  }
+  else
+  {
+    ++m_nofFailures;
+  }
+
+  std::printf("%s %s (%s, %d bands) in %.3f s\n",
+    ok? "rendered" : "FAILED",
+    qPrintable(job.m_imageFile),
+    qPrintable(job.m_datasetName),
+    job.m_nofBands,
+    seconds);
+
+  std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
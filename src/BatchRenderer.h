@@ -0,0 +1,76 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Headless rendering of a job file to images, without MainWindow or any
+// widget: every worker renders through its own offscreen render window
+// (OSMesa when VTK is built with it). Each line of the job file is a job:
+//
+//   # geometry file    dataset   bands  image file        [width height]
+//   data/engine.vtm    Pressure  12     out/pressure.png  1600 1200
+//
+// The jobs of a geometry are split in runs across the workers, in proportion
+// of the share of the geometry in the job file. Each run reads the geometry
+// and extracts its surfaces once, then renders its jobs in sequence.
+class BatchRenderer
+{
+public:
+  struct Job
+  {
+    Job();
+
+    QString m_geometryFile;
+    QString m_datasetName;
+    int     m_nofBands;
+    QString m_imageFile;
+    int     m_width;
+    int     m_height;
+  };
+
+  explicit BatchRenderer(int nofWorkers = 0);
+
+  static bool ReadJobFile(const QString& fileName, QList<Job>& jobs);
+
+  // Renders every job and prints a report, returns the number of failures
+  int run(const QList<Job>& jobs);
+
+  // Entry point of the --batch command line mode
+  static int Main(const QStringList& arguments);
+
+protected:
+  class Worker;
+
+  void jobDone(const Job& job, bool ok, double seconds);
+
+  int    m_nofWorkers;
+  QMutex m_mutex;
+  int    m_nofImages;
+  int    m_nofFailures;
+};
+
+#endif // BATCHRENDERER_H
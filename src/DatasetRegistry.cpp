@@ -0,0 +1,204 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "DatasetRegistry.h"
+
+#include "ArrayRangeEngine.h"
+
+#include <limits>
+
+//------------------------------------------------------------------------------
+
+DatasetRegistry::DatasetRegistry()
+{
+}
+
+//------------------------------------------------------------------------------
+
+int DatasetRegistry::intern(const QString& name, Association association)
+{
+  auto it = m_ids[association].constFind(name);
+
+  if( it != m_ids[association].constEnd() )
+  {
+    return it.value();
+  }
+
+  DatasetInfo info;
+  info.m_name              = name;
+  info.m_key               = name.toLatin1();
+  info.m_association       = association;
+  info.m_nofComponents     = 0;
+  info.m_range[0]          = std::numeric_limits<double>::max();
+  info.m_range[1]          = -std::numeric_limits<double>::max();
+  info.m_magnitudeRange[0] = std::numeric_limits<double>::max();
+  info.m_magnitudeRange[1] = -std::numeric_limits<double>::max();
+
+  const int id = static_cast<int>(m_datasets.size());
+
+  m_datasets.push_back(info);
+  m_ids[association].insert(name, id);
+
+  return id;
+}
+
+//------------------------------------------------------------------------------
+
+int DatasetRegistry::find(const QString& name, Association association) const
+{
+  return m_ids[association].value(name, -1);
+}
+
+//------------------------------------------------------------------------------
+
+void DatasetRegistry::mergeRange(int id, const ArrayRange& range)
+{
+  DatasetInfo& info = m_datasets[id];
+
+  info.m_nofComponents = qMax(info.m_nofComponents, range.m_nofComponents);
+
+  if( const double* componentRange = range.getComponentRange(0) )
+  {
+    info.m_range[0] = qMin(info.m_range[0], componentRange[0]);
+    info.m_range[1] = qMax(info.m_range[1], componentRange[1]);
+  }
+
+  info.m_magnitudeRange[0] =
+    qMin(info.m_magnitudeRange[0], range.getMagnitudeRange()[0]);
+  info.m_magnitudeRange[1] =
+    qMax(info.m_magnitudeRange[1], range.getMagnitudeRange()[1]);
+}
+
+//------------------------------------------------------------------------------
+
+void DatasetRegistry::setInfo(const DatasetInfo& info)
+{
+  const int id = intern(info.m_name, info.m_association);
+
+  m_datasets[id] = info;
+  m_datasets[id].m_key = info.m_name.toLatin1();
+}
+
+//------------------------------------------------------------------------------
+
+const DatasetRegistry::DatasetInfo& DatasetRegistry::getInfo(int id) const
+{
+  return m_datasets[id];
+}
+
+//------------------------------------------------------------------------------
+
+int DatasetRegistry::getNofDatasets() const
+{
+  return static_cast<int>(m_datasets.size());
+}
+
+//------------------------------------------------------------------------------
+
+DatasetHandle::DatasetHandle()
+  :
+  m_id(-1)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DatasetHandle::DatasetHandle(
+  std::shared_ptr<const DatasetRegistry> registry,
+  int id)
+  :
+  m_registry(registry),
+  m_id(registry? id : -1)
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool DatasetHandle::isValid() const
+{
+  return m_registry && (m_id >= 0) && (m_id < m_registry->getNofDatasets());
+}
+
+//------------------------------------------------------------------------------
+
+int DatasetHandle::getId() const
+{
+  return m_id;
+}
+
+//------------------------------------------------------------------------------
+
+const QString& DatasetHandle::getName() const
+{
+  return m_registry->getInfo(m_id).m_name;
+}
+
+//------------------------------------------------------------------------------
+
+const char* DatasetHandle::getKey() const
+{
+  return m_registry->getInfo(m_id).m_key.constData();
+}
+
+//------------------------------------------------------------------------------
+
+DatasetRegistry::Association DatasetHandle::getAssociation() const
+{
+  return m_registry->getInfo(m_id).m_association;
+}
+
+//------------------------------------------------------------------------------
+
+int DatasetHandle::getNofComponents() const
+{
+  return m_registry->getInfo(m_id).m_nofComponents;
+}
+
+//------------------------------------------------------------------------------
+
+const double* DatasetHandle::getRange() const
+{
+  return m_registry->getInfo(m_id).m_range;
+}
+
+//------------------------------------------------------------------------------
+
+const double* DatasetHandle::getMagnitudeRange() const
+{
+  return m_registry->getInfo(m_id).m_magnitudeRange;
+}
+
+//------------------------------------------------------------------------------
+
+bool DatasetHandle::operator==(const DatasetHandle& other) const
+{
+  return (m_registry == other.m_registry) && (m_id == other.m_id);
+}
+
+//------------------------------------------------------------------------------
+
+bool DatasetHandle::operator!=(const DatasetHandle& other) const
+{
+  return !(*this == other);
+}
+
+//------------------------------------------------------------------------------
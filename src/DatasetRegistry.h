@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef DATASETREGISTRY_H
+#define DATASETREGISTRY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include <memory>
+#include <vector>
+
+struct ArrayRange;
+
+// Interns the point and cell field names of a Geometry to integer ids and
+// keeps their ranges and metadata in a contiguous table indexed by id.
+class DatasetRegistry
+{
+public:
+  enum Association
+  {
+    POINT_DATA,
+    CELL_DATA
+  };
+
+  struct DatasetInfo
+  {
+    QString     m_name;
+    QByteArray  m_key;
+    Association m_association;
+    int         m_nofComponents;
+    double      m_range[2];
+    double      m_magnitudeRange[2];
+  };
+
+  DatasetRegistry();
+
+  int intern(const QString& name, Association association);
+  int find(const QString& name, Association association) const;
+
+  void mergeRange(int id, const ArrayRange& range);
+  void setInfo(const DatasetInfo& info);
+
+  const DatasetInfo& getInfo(int id) const;
+  int getNofDatasets() const;
+
+protected:
+  std::vector<DatasetInfo> m_datasets;
+  QHash<QString, int>      m_ids[2];
+};
+
+// Cheap, copyable reference to one entry of a DatasetRegistry. It keeps the
+// registry alive, so it stays valid after the owning Geometry is deleted.
+class DatasetHandle
+{
+public:
+  DatasetHandle();
+  DatasetHandle(std::shared_ptr<const DatasetRegistry> registry, int id);
+
+  bool isValid() const;
+  int getId() const;
+
+  const QString& getName() const;
+  const char* getKey() const;
+  DatasetRegistry::Association getAssociation() const;
+  int getNofComponents() const;
+  const double* getRange() const;
+  const double* getMagnitudeRange() const;
+
+  bool operator==(const DatasetHandle& other) const;
+  bool operator!=(const DatasetHandle& other) const;
+
+protected:
+  std::shared_ptr<const DatasetRegistry> m_registry;
+  int                                    m_id;
+};
+
+#endif // DATASETREGISTRY_H
@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "ExternalArray.h"
+
+#include <vtkDataArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationObjectBaseKey.h>
+#include <vtkObjectFactory.h>
+#include <vtkCellType.h>
+#include <vtkType.h>
+
+//------------------------------------------------------------------------------
+
+vtkStandardNewMacro(ExternalBufferOwner);
+
+//------------------------------------------------------------------------------
+
+ExternalBufferOwner::ExternalBufferOwner()
+{
+}
+
+//------------------------------------------------------------------------------
+
+ExternalBufferOwner::~ExternalBufferOwner()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void ExternalBufferOwner::setOwner(std::shared_ptr<void> owner)
+{
+  m_owner = owner;
+}
+
+//------------------------------------------------------------------------------
+
+vtkInformationKeyMacro(ExternalArray, BUFFER_OWNER, ObjectBase);
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkDataArray> ExternalArray::Wrap(
+  int dataType,
+  void* data,
+  vtkIdType nofTuples,
+  int nofComponents,
+  std::shared_ptr<void> owner)
+{
+  vtkSmartPointer<vtkDataArray> arr =
+    vtkSmartPointer<vtkDataArray>::Take(
+      vtkDataArray::CreateDataArray(dataType));
+
+  if( !arr )
+  {
+    return arr;
+  }
+
+  // save = 1: VTK never frees or reallocates the external memory
+  arr->SetNumberOfComponents(nofComponents);
+  arr->SetVoidArray(data, nofTuples * nofComponents, 1);
+
+  if( owner )
+  {
+    vtkSmartPointer<ExternalBufferOwner> bufferOwner =
+      vtkSmartPointer<ExternalBufferOwner>::New();
+
+    bufferOwner->setOwner(owner);
+
+    arr->GetInformation()->Set(BUFFER_OWNER(), bufferOwner);
+  }
+
+  return arr;
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkDataArray> ExternalArray::Wrap(const ExternalBuffer& buffer)
+{
+  std::shared_ptr<void> owner;
+
+  if( buffer.m_deleter )
+  {
+    owner = std::shared_ptr<void>(buffer.m_data, buffer.m_deleter);
+  }
+
+  return Wrap(
+    buffer.m_dataType,
+    buffer.m_data,
+    buffer.m_nofTuples,
+    buffer.m_nofComponents,
+    owner);
+}
+
+//------------------------------------------------------------------------------
+
+ExternalBuffer::ExternalBuffer()
+  :
+  m_data(nullptr),
+  m_dataType(VTK_VOID),
+  m_nofTuples(0),
+  m_nofComponents(1)
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool ExternalBuffer::isEmpty() const
+{
+  return !m_data || (m_nofTuples <= 0);
+}
+
+//------------------------------------------------------------------------------
+
+ExternalMesh::ExternalMesh()
+  :
+  m_nofCells(0),
+  m_cellType(VTK_EMPTY_CELL)
+{
+}
+
+//------------------------------------------------------------------------------
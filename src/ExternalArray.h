@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef EXTERNALARRAY_H
+#define EXTERNALARRAY_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+
+#include <functional>
+#include <memory>
+
+class vtkDataArray;
+class vtkInformationObjectBaseKey;
+
+// Keeps alive the memory wrapped by an external VTK array. It is stored in
+// the information of the array, so it is released together with the array
+// (and every shallow copy of it) instead of with its original owner.
+class ExternalBufferOwner : public vtkObject
+{
+public:
+  static ExternalBufferOwner* New();
+  vtkTypeMacro(ExternalBufferOwner, vtkObject);
+
+  void setOwner(std::shared_ptr<void> owner);
+
+protected:
+  ExternalBufferOwner();
+  ~ExternalBufferOwner();
+
+  std::shared_ptr<void> m_owner;
+
+private:
+  ExternalBufferOwner(const ExternalBufferOwner&) = delete;
+  void operator=(const ExternalBufferOwner&) = delete;
+};
+
+// Memory owned by the caller, m_deleter (if any) is called with m_data once
+// the last VTK array wrapping it is deleted. It is only called for buffers
+// that were wrapped: a mesh rejected by GeometryPart::setExternalData stays
+// with the caller, who has to release it.
+struct ExternalBuffer
+{
+  ExternalBuffer();
+
+  bool isEmpty() const;
+
+  void*     m_data;
+  int       m_dataType;      // VTK_FLOAT, VTK_DOUBLE, VTK_ID_TYPE, ...
+  vtkIdType m_nofTuples;
+  int       m_nofComponents;
+
+  std::function<void(void*)> m_deleter;
+};
+
+// Unstructured mesh in caller owned buffers, see GeometryPart::setExternalData
+struct ExternalMesh
+{
+  ExternalMesh();
+
+  ExternalBuffer m_points;         // 3 components, VTK_FLOAT or VTK_DOUBLE
+
+  // VTK_ID_TYPE, every cell as its number of points followed by the ids
+  vtkIdType      m_nofCells;
+  ExternalBuffer m_connectivity;
+
+  // VTK_UNSIGNED_CHAR per cell, or m_cellType for every cell
+  ExternalBuffer m_cellTypes;
+  int            m_cellType;
+
+  // VTK_ID_TYPE offset of every cell in m_connectivity, computed if empty
+  ExternalBuffer m_cellLocations;
+
+  QList<QPair<QString, ExternalBuffer>> m_pointFields;
+  QList<QPair<QString, ExternalBuffer>> m_cellFields;
+};
+
+class ExternalArray
+{
+public:
+  static vtkInformationObjectBaseKey* BUFFER_OWNER();
+
+  static vtkSmartPointer<vtkDataArray> Wrap(
+    int dataType,
+    void* data,
+    vtkIdType nofTuples,
+    int nofComponents,
+    std::shared_ptr<void> owner);
+
+  static vtkSmartPointer<vtkDataArray> Wrap(const ExternalBuffer& buffer);
+};
+
+#endif // EXTERNALARRAY_H
@@ -22,7 +22,12 @@
 
 #include "Geometry.h"
 
+#include "GeometryLoader.h"
 #include "GeometryPart.h"
+#include "PartCache.h"
+#include "ProbeEngine.h"
+#include "TimeSeriesPlayer.h"
+#include "Tracer.h"
 
 #include <vtkAlgorithmOutput.h>
 #include <vtkCellData.h>
@@ -31,41 +36,32 @@
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
 
-#include <limits>
-
 //------------------------------------------------------------------------------
 
-void fillDatasetMap(vtkDataSetAttributes* att, QMap<QString, double*>& dataMap)
+void fillDatasetRegistry(
+  const std::vector<ArrayRange>& ranges,
+  DatasetRegistry::Association association,
+  DatasetRegistry& registry)
 {
-  if( !att )
+  for( const ArrayRange& range : ranges )
   {
-    return;
+    registry.mergeRange(registry.intern(range.m_name, association), range);
   }
+}
 
-  for( vtkIdType i = 0; i < att->GetNumberOfArrays(); ++i )
-  {
-    vtkDataArray* arr = att->GetArray(i);
-
-    if( !dataMap.contains(arr->GetName()) )
-    {
-      dataMap[arr->GetName()] = new double [2] {
-        std::numeric_limits<double>::max(),
-        -std::numeric_limits<double>::max()};
-    }
-
-    dataMap[arr->GetName()][0] = qMin(
-      dataMap[arr->GetName()][0],
-      arr->GetRange()[0]);
+//------------------------------------------------------------------------------
 
-    dataMap[arr->GetName()][1] = qMax(
-      dataMap[arr->GetName()][1],
-      arr->GetRange()[1]);
-  }
-}
+PrecisionPolicy Geometry::s_defaultPrecision;
 
 //------------------------------------------------------------------------------
 
-Geometry::Geometry(QObject *parent) : QObject(parent)
+Geometry::Geometry(QObject *parent)
+  :
+  QObject(parent),
+  m_datasets(std::make_shared<DatasetRegistry>()),
+  m_timeStep(-1),
+  m_precision(s_defaultPrecision),
+  m_hierarchyValid(false)
 {
 }
 
@@ -73,26 +69,48 @@ Geometry::Geometry(QObject *parent) : QObject(parent)
 
 Geometry::~Geometry()
 {
-  qDeleteAll(m_pointDatasetsInfo);
-  qDeleteAll(m_cellDatasetsInfo);
 }
 
 //------------------------------------------------------------------------------
 
 void Geometry::addPart(std::unique_ptr<GeometryPart> part)
 {
+  TRACE_SCOPE("Geometry::addPart");
+
   if( !part )
   {
     return;
   }
 
-  vtkPointData* pData = part->getGeometryData()->GetPointData();
-  vtkCellData*  cData = part->getGeometryData()->GetCellData();
+  fillDatasetRegistry(
+    part->getPointDataRanges(),
+    DatasetRegistry::POINT_DATA,
+    *m_datasets);
 
-  fillDatasetMap(pData, m_pointDatasetsInfo);
-  fillDatasetMap(cData, m_cellDatasetsInfo);
+  fillDatasetRegistry(
+    part->getCellDataRanges(),
+    DatasetRegistry::CELL_DATA,
+    *m_datasets);
 
-  m_geomParts << std::shared_ptr<GeometryPart>(std::move(part));
+  appendPart(std::shared_ptr<GeometryPart>(std::move(part)));
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::appendPart(std::shared_ptr<GeometryPart> part)
+{
+  // Only assigns the policy for parts read with it, see
+  // GeometryLoader::BlockReader
+  part->setPrecisionPolicy(m_precision);
+
+  m_geomParts << part;
+  m_hierarchyValid = false;
+
+  // Parts over the memory budget drop their data from here on
+  PartCache::Add(part);
+  PartCache::EnforceBudget();
+
+  emit partAdded(m_geomParts.size() - 1);
 }
 
 //------------------------------------------------------------------------------
@@ -111,17 +129,317 @@ QList<std::weak_ptr<GeometryPart>> Geometry::getParts() const
 
 //------------------------------------------------------------------------------
 
-QMap<QString, double*> Geometry::getPointDatasetsInfo() const
+std::weak_ptr<GeometryPart> Geometry::getPart(int index) const
+{
+  if( (index < 0) || (index >= m_geomParts.size()) )
+  {
+    return std::weak_ptr<GeometryPart>();
+  }
+
+  return m_geomParts[index];
+}
+
+//------------------------------------------------------------------------------
+
+int Geometry::getNofParts() const
+{
+  return m_geomParts.size();
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::partDataChanged(
+  int index,
+  bool pointsChanged,
+  const QStringList& arrays)
+{
+  partsDataChanged(QList<int>() << index, pointsChanged, arrays);
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::partsDataChanged(
+  const QList<int>& indices,
+  bool pointsChanged,
+  const QStringList& arrays)
+{
+  TRACE_SCOPE("Geometry::partsDataChanged");
+
+  bool changed = false;
+
+  for( int index : indices )
+  {
+    std::shared_ptr<GeometryPart> part = m_geomParts.value(index);
+
+    if( !part )
+    {
+      continue;
+    }
+
+    part->dataChanged(pointsChanged, arrays);
+
+    m_hierarchyValid = m_hierarchyValid && !pointsChanged;
+
+    // Like time steps, the ranges grow to cover every value shown
+    fillDatasetRegistry(
+      part->getPointDataRanges(),
+      DatasetRegistry::POINT_DATA,
+      *m_datasets);
+
+    fillDatasetRegistry(
+      part->getCellDataRanges(),
+      DatasetRegistry::CELL_DATA,
+      *m_datasets);
+
+    changed = true;
+  }
+
+  // A single redraw of the plots for all the parts
+  if( changed )
+  {
+    emit dataChanged();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::waitForLoaded()
+{
+  // See GeometryFactory::CreateGeometryFromFile(), the loader is a child
+  if( GeometryLoader* loader = findChild<GeometryLoader*>() )
+  {
+    loader->waitForFinished();
+  }
+
+  if( TimeSeriesPlayer* player = getTimeSeriesPlayer() )
+  {
+    player->waitForCurrentStep();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+const PartHierarchy& Geometry::getPartHierarchy()
+{
+  if( !m_hierarchyValid )
+  {
+    TRACE_SCOPE("Geometry::getPartHierarchy");
+
+    // Evicted parts keep their bounds, nothing is read again
+    std::vector<double> bounds(6 * m_geomParts.size());
+
+    for( int i = 0; i < m_geomParts.size(); ++i )
+    {
+      m_geomParts[i]->getBounds(&bounds[6*i]);
+    }
+
+    m_hierarchy.build(bounds);
+    m_hierarchyValid = true;
+  }
+
+  return m_hierarchy;
+}
+
+//------------------------------------------------------------------------------
+
+std::shared_ptr<const DatasetRegistry> Geometry::getDatasetRegistry() const
+{
+  return m_datasets;
+}
+
+//------------------------------------------------------------------------------
+
+DatasetHandle Geometry::findDataset(
+  const QString& name,
+  DatasetRegistry::Association association) const
+{
+  return DatasetHandle(m_datasets, m_datasets->find(name, association));
+}
+
+//------------------------------------------------------------------------------
+
+DatasetHandle Geometry::findDataset(const QString& name) const
+{
+  DatasetHandle handle = findDataset(name, DatasetRegistry::POINT_DATA);
+
+  if( !handle.isValid() )
+  {
+    handle = findDataset(name, DatasetRegistry::CELL_DATA);
+  }
+
+  return handle;
+}
+
+//------------------------------------------------------------------------------
+
+ProbeSamples Geometry::probePoints(
+  const QString& fieldName,
+  const std::vector<double>& points) const
+{
+  const DatasetHandle dataset = findDataset(fieldName);
+
+  return ProbeEngine(*this).probePoints(
+    fieldName,
+    dataset.isValid()? dataset.getAssociation() : DatasetRegistry::POINT_DATA,
+    points);
+}
+
+//------------------------------------------------------------------------------
+
+ProbeSamples Geometry::probeLine(
+  const QString& fieldName,
+  const std::vector<double>& polyline,
+  int nofSamples) const
+{
+  const DatasetHandle dataset = findDataset(fieldName);
+
+  return ProbeEngine(*this).probeLine(
+    fieldName,
+    dataset.isValid()? dataset.getAssociation() : DatasetRegistry::POINT_DATA,
+    polyline,
+    nofSamples);
+}
+
+//------------------------------------------------------------------------------
+
+int Geometry::getNofTimeSteps() const
 {
-  return m_pointDatasetsInfo;
+  return m_timeValues.size();
 }
 
 //------------------------------------------------------------------------------
 
-QMap<QString, double*> Geometry::getCellDatasetsInfo() const
+double Geometry::getTimeValue(int step) const
 {
-  return m_cellDatasetsInfo;
+  return m_timeValues.value(step, 0.0);
 }
 
 //------------------------------------------------------------------------------
 
+int Geometry::getTimeStep() const
+{
+  return m_timeStep;
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::setTimeValues(const QList<double>& timeValues)
+{
+  m_timeValues = timeValues;
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::setTimeStepData(const TimeStepData& data)
+{
+  TRACE_SCOPE("Geometry::setTimeStepData");
+
+  fillDatasetRegistry(
+    data.m_pointRanges,
+    DatasetRegistry::POINT_DATA,
+    *m_datasets);
+
+  fillDatasetRegistry(
+    data.m_cellRanges,
+    DatasetRegistry::CELL_DATA,
+    *m_datasets);
+
+  m_timeStep = data.m_step;
+  m_hierarchyValid = false;
+
+  if( m_geomParts.isEmpty() )
+  {
+    for( size_t i = 0; i < data.m_blocks.size(); ++i )
+    {
+      std::shared_ptr<GeometryPart> part = std::make_shared<GeometryPart>();
+      part->setPartName(data.m_names[static_cast<int>(i)]);
+      part->setPrecisionPolicy(m_precision);
+      part->setTimeStepData(
+        data.m_step, data.m_blocks[i], data.m_savedBytes[i]);
+
+      appendPart(part);
+    }
+  }
+  else
+  {
+    // Blocks are matched by name, single files per step are named after the
+    // file and only match by their order
+    const bool sameLayout =
+      (static_cast<int>(data.m_blocks.size()) == m_geomParts.size());
+
+    for( int i = 0; i < m_geomParts.size(); ++i )
+    {
+      int index = data.m_names.indexOf(m_geomParts[i]->getPartName());
+
+      if( (index < 0) && sameLayout )
+      {
+        index = i;
+      }
+
+      if( index >= 0 )
+      {
+        m_geomParts[i]->setTimeStepData(
+          data.m_step, data.m_blocks[index], data.m_savedBytes[index]);
+      }
+    }
+  }
+
+  emit timeStepChanged(m_timeStep);
+}
+
+//------------------------------------------------------------------------------
+
+TimeSeriesPlayer* Geometry::getTimeSeriesPlayer() const
+{
+  // See GeometryFactory::CreateGeometryFromFile(), the player is a child
+  return findChild<TimeSeriesPlayer*>();
+}
+
+//------------------------------------------------------------------------------
+
+const PrecisionPolicy& Geometry::getPrecisionPolicy() const
+{
+  return m_precision;
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::setPrecisionPolicy(const PrecisionPolicy& policy)
+{
+  m_precision = policy;
+
+  for( auto part : m_geomParts )
+  {
+    part->setPrecisionPolicy(m_precision);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+qint64 Geometry::getSavedBytes() const
+{
+  qint64 savedBytes = 0;
+
+  for( auto part : m_geomParts )
+  {
+    savedBytes += part->getSavedBytes();
+  }
+
+  return savedBytes;
+}
+
+//------------------------------------------------------------------------------
+
+PrecisionPolicy Geometry::GetDefaultPrecisionPolicy()
+{
+  return s_defaultPrecision;
+}
+
+//------------------------------------------------------------------------------
+
+void Geometry::SetDefaultPrecisionPolicy(const PrecisionPolicy& policy)
+{
+  s_defaultPrecision = policy;
+}
+
+//------------------------------------------------------------------------------
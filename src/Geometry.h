@@ -23,13 +23,18 @@
 #ifndef GEOMETRY_H
 #define GEOMETRY_H
 
+#include "DatasetRegistry.h"
+#include "PartHierarchy.h"
+#include "PrecisionConverter.h"
+
 #include <QList>
-#include <QMap>
 #include <QObject>
+#include <QStringList>
 
 #include <vtkSmartPointer.h>
 
 #include <memory>
+#include <vector>
 
 class vtkAlgorithmOutput;
 class vtkDoubleArray;
@@ -37,6 +42,9 @@ class vtkPolyData;
 class vtkPassThrough;
 
 class GeometryPart;
+class TimeSeriesPlayer;
+struct ProbeSamples;
+struct TimeStepData;
 
 class Geometry : public QObject
 {
@@ -47,14 +55,85 @@ public:
 
   void addPart(std::unique_ptr<GeometryPart> part);
   QList<std::weak_ptr<GeometryPart>> getParts() const;
+  std::weak_ptr<GeometryPart> getPart(int index) const;
+  int getNofParts() const;
+
+  // The data of a part changed in place (see GeometryPart::dataChanged), the
+  // ranges of the changed arrays are merged into the dataset registry
+  void partDataChanged(
+    int index,
+    bool pointsChanged = true,
+    const QStringList& arrays = QStringList());
+  void partsDataChanged(
+    const QList<int>& indices,
+    bool pointsChanged = true,
+    const QStringList& arrays = QStringList());
+
+  // Bounding volume hierarchy over the bounds of the parts, rebuilt on the
+  // first call after parts are added or moved. The leaves are part indices.
+  const PartHierarchy& getPartHierarchy();
+
+  // Blocks until a geometry read in background has published all its parts
+  void waitForLoaded();
+
+  std::shared_ptr<const DatasetRegistry> getDatasetRegistry() const;
+  DatasetHandle findDataset(
+    const QString& name,
+    DatasetRegistry::Association association) const;
+  DatasetHandle findDataset(const QString& name) const;
+
+  // Samples a point or cell field across every part (see ProbeEngine). The
+  // cell trees are built by every call, keep a ProbeEngine for many probes.
+  ProbeSamples probePoints(
+    const QString& fieldName,
+    const std::vector<double>& points) const;
+  ProbeSamples probeLine(
+    const QString& fieldName,
+    const std::vector<double>& polyline,
+    int nofSamples) const;
 
-  QMap<QString, double*> getPointDatasetsInfo() const;
-  QMap<QString, double*> getCellDatasetsInfo() const;
+  // Transient geometries: every time step replaces the data of all the parts,
+  // the dataset ranges grow to cover every step shown so far. The first step
+  // creates the parts.
+  int getNofTimeSteps() const;
+  double getTimeValue(int step) const;
+  int getTimeStep() const;
+  void setTimeValues(const QList<double>& timeValues);
+  void setTimeStepData(const TimeStepData& data);
+  TimeSeriesPlayer* getTimeSeriesPlayer() const;
+
+  // Storage precision of the parts, applied when they are added and to the
+  // existing ones. The dataset ranges are merged before the conversion, so
+  // they are the exact ranges of the data read.
+  const PrecisionPolicy& getPrecisionPolicy() const;
+  void setPrecisionPolicy(const PrecisionPolicy& policy);
+  qint64 getSavedBytes() const;
+
+  // Policy of the geometries created afterwards
+  static PrecisionPolicy GetDefaultPrecisionPolicy();
+  static void SetDefaultPrecisionPolicy(const PrecisionPolicy& policy);
+
+signals:
+  void partAdded(int index);
+  void timeStepChanged(int step);
+  void dataChanged();
+  void loadProgress(int loadedParts, int totalParts);
+  void loadFinished();
 
 protected:
-  QMap<QString, double*>               m_pointDatasetsInfo;
-  QMap<QString, double*>               m_cellDatasetsInfo;
+  friend class GeometryCache;
+
+  void appendPart(std::shared_ptr<GeometryPart> part);
+
+  std::shared_ptr<DatasetRegistry>     m_datasets;
   QList<std::shared_ptr<GeometryPart>> m_geomParts;
+  QList<double>                        m_timeValues;
+  int                                  m_timeStep;
+  PrecisionPolicy                      m_precision;
+  PartHierarchy                        m_hierarchy;
+  bool                                 m_hierarchyValid;
+
+  static PrecisionPolicy s_defaultPrecision;
 };
 
 #endif // GEOMETRY_H
@@ -0,0 +1,945 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "GeometryCache.h"
+
+#include "ExternalArray.h"
+#include "Geometry.h"
+#include "GeometryLoader.h"
+#include "GeometryPart.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QtConcurrentRun>
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPointSet.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <cstring>
+
+//------------------------------------------------------------------------------
+
+const char    CacheMagic[8]      = {'Q', 'V', 'T', 'K', 'G', 'E', 'O', 'C'};
+const quint32 CacheByteOrderMark = 0x01020304;
+const qint64  CacheAlignment     = 64;
+
+struct CacheFileHeader
+{
+  char    m_magic[8];
+  quint32 m_version;
+  quint32 m_byteOrderMark;
+  quint32 m_idTypeSize;
+  quint32 m_reserved;
+  quint64 m_metadataOffset;
+  quint64 m_metadataSize;
+  // GeometryCache::SourceStamps, after the metadata
+  quint64 m_sourcesOffset;
+  quint64 m_sourcesSize;
+};
+
+struct CacheBlob
+{
+  qint32  m_dataType;
+  qint32  m_nofComponents;
+  qint64  m_nofTuples;
+  quint64 m_offset;
+};
+
+enum CacheAssociation
+{
+  CACHE_POINT_DATA,
+  CACHE_CELL_DATA
+};
+
+bool GeometryCache::s_enabled = true;
+
+//------------------------------------------------------------------------------
+
+QDataStream& operator<<(QDataStream& stream, const CacheBlob& blob)
+{
+  return stream
+    << blob.m_dataType
+    << blob.m_nofComponents
+    << blob.m_nofTuples
+    << blob.m_offset;
+}
+
+//------------------------------------------------------------------------------
+
+QDataStream& operator>>(QDataStream& stream, CacheBlob& blob)
+{
+  return stream
+    >> blob.m_dataType
+    >> blob.m_nofComponents
+    >> blob.m_nofTuples
+    >> blob.m_offset;
+}
+
+//------------------------------------------------------------------------------
+
+QDataStream& operator<<(
+  QDataStream& stream,
+  const DatasetRegistry::DatasetInfo& info)
+{
+  return stream
+    << info.m_name
+    << qint8(info.m_association)
+    << qint32(info.m_nofComponents)
+    << info.m_range[0]
+    << info.m_range[1]
+    << info.m_magnitudeRange[0]
+    << info.m_magnitudeRange[1];
+}
+
+//------------------------------------------------------------------------------
+
+QDataStream& operator>>(
+  QDataStream& stream,
+  DatasetRegistry::DatasetInfo& info)
+{
+  qint8  association   = 0;
+  qint32 nofComponents = 0;
+
+  stream
+    >> info.m_name
+    >> association
+    >> nofComponents
+    >> info.m_range[0]
+    >> info.m_range[1]
+    >> info.m_magnitudeRange[0]
+    >> info.m_magnitudeRange[1];
+
+  info.m_association = (association == DatasetRegistry::CELL_DATA)?
+    DatasetRegistry::CELL_DATA : DatasetRegistry::POINT_DATA;
+  info.m_nofComponents = nofComponents;
+
+  return stream;
+}
+
+//------------------------------------------------------------------------------
+
+QDataStream& operator<<(
+  QDataStream& stream,
+  const GeometryCache::SourceStamp& stamp)
+{
+  return stream << stamp.m_fileName << stamp.m_size << stamp.m_modified;
+}
+
+//------------------------------------------------------------------------------
+
+QDataStream& operator>>(
+  QDataStream& stream,
+  GeometryCache::SourceStamp& stamp)
+{
+  return stream >> stamp.m_fileName >> stamp.m_size >> stamp.m_modified;
+}
+
+//------------------------------------------------------------------------------
+
+bool operator==(
+  const GeometryCache::SourceStamp& a,
+  const GeometryCache::SourceStamp& b)
+{
+  return (a.m_fileName == b.m_fileName) &&
+    (a.m_size == b.m_size) &&
+    (a.m_modified == b.m_modified);
+}
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+// Like GeometryPart::setExternalData, the mapped topology is checked before
+// VTK reads it: a truncated or foreign file must not crash the viewer. The
+// cells are walked in order, every one starts where the previous one ends
+// and only uses existing points. locations, when given, must match the walk.
+bool isValidTopology(
+  vtkIdTypeArray* ids,
+  vtkIdType nofCells,
+  vtkIdType nofPoints,
+  vtkIdTypeArray* locations)
+{
+  if( (nofCells < 0) || (ids->GetNumberOfComponents() != 1) ||
+      (locations && ((locations->GetNumberOfComponents() != 1) ||
+                     (locations->GetNumberOfTuples() != nofCells))) )
+  {
+    return false;
+  }
+
+  const vtkIdType* connectivity = ids->GetPointer(0);
+  const vtkIdType  size         = ids->GetNumberOfTuples();
+  vtkIdType        location     = 0;
+
+  for( vtkIdType c = 0; c < nofCells; ++c )
+  {
+    if( (location >= size) ||
+        (locations && (locations->GetValue(c) != location)) )
+    {
+      return false;
+    }
+
+    const vtkIdType nofCellPoints = connectivity[location];
+
+    if( (nofCellPoints < 0) || (nofCellPoints >= size - location) )
+    {
+      return false;
+    }
+
+    for( vtkIdType p = 1; p <= nofCellPoints; ++p )
+    {
+      const vtkIdType id = connectivity[location + p];
+
+      if( (id < 0) || (id >= nofPoints) )
+      {
+        return false;
+      }
+    }
+
+    location += nofCellPoints + 1;
+  }
+
+  return location == size;
+}
+
+bool isValidCellTypes(vtkUnsignedCharArray* types, vtkIdType nofCells)
+{
+  if( (types->GetNumberOfComponents() != 1) ||
+      (types->GetNumberOfTuples() != nofCells) )
+  {
+    return false;
+  }
+
+  for( vtkIdType c = 0; c < nofCells; ++c )
+  {
+    const unsigned char type = types->GetValue(c);
+
+    if( (type <= VTK_EMPTY_CELL) || (type >= VTK_NUMBER_OF_CELL_TYPES) )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+bool isCompatibleHeader(const CacheFileHeader& header)
+{
+  return
+    (std::memcmp(header.m_magic, CacheMagic, sizeof(CacheMagic)) == 0) &&
+    (header.m_version == GeometryCache::Version) &&
+    (header.m_byteOrderMark == CacheByteOrderMark) &&
+    (header.m_idTypeSize == sizeof(vtkIdType));
+}
+
+//------------------------------------------------------------------------------
+
+bool alignFile(QFile& file)
+{
+  const qint64 padding =
+    (CacheAlignment - (file.pos() % CacheAlignment)) % CacheAlignment;
+
+  if( padding == 0 )
+  {
+    return true;
+  }
+
+  return file.write(QByteArray(padding, '\0')) == padding;
+}
+
+//------------------------------------------------------------------------------
+
+bool writeBlob(QFile& file, vtkDataArray* arr, CacheBlob& blob)
+{
+  vtkSmartPointer<vtkDataArray> data = arr;
+
+  if( !arr->HasStandardMemoryLayout() )
+  {
+    data = vtkSmartPointer<vtkDataArray>::Take(
+      vtkDataArray::CreateDataArray(arr->GetDataType()));
+
+    data->DeepCopy(arr);
+  }
+
+  if( !alignFile(file) )
+  {
+    return false;
+  }
+
+  blob.m_dataType      = data->GetDataType();
+  blob.m_nofComponents = data->GetNumberOfComponents();
+  blob.m_nofTuples     = data->GetNumberOfTuples();
+  blob.m_offset        = file.pos();
+
+  const qint64 size =
+    blob.m_nofTuples * blob.m_nofComponents * data->GetDataTypeSize();
+
+  if( size == 0 )
+  {
+    return true;
+  }
+
+  return file.write(
+    static_cast<const char*>(data->GetVoidPointer(0)), size) == size;
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkDataArray> wrapBlob(
+  const CacheBlob& blob,
+  uchar* base,
+  qint64 fileSize,
+  std::shared_ptr<void> owner)
+{
+  if( (blob.m_nofTuples < 0) || (blob.m_nofComponents < 1) ||
+      ((blob.m_offset % CacheAlignment) != 0) ||
+      (blob.m_offset > static_cast<quint64>(fileSize)) )
+  {
+    return vtkSmartPointer<vtkDataArray>();
+  }
+
+  vtkSmartPointer<vtkDataArray> arr = ExternalArray::Wrap(
+    blob.m_dataType,
+    base + blob.m_offset,
+    blob.m_nofTuples,
+    blob.m_nofComponents,
+    owner);
+
+  if( !arr )
+  {
+    return arr;
+  }
+
+  // Divided, the counts read from the file may overflow a product
+  const quint64 tupleSize =
+    quint64(blob.m_nofComponents) * arr->GetDataTypeSize();
+
+  if( quint64(blob.m_nofTuples) >
+      (static_cast<quint64>(fileSize) - blob.m_offset) / tupleSize )
+  {
+    return vtkSmartPointer<vtkDataArray>();
+  }
+
+  return arr;
+}
+
+//------------------------------------------------------------------------------
+
+bool writeCells(
+  QFile& file,
+  QDataStream& meta,
+  vtkCellArray* cells)
+{
+  CacheBlob blob;
+
+  vtkSmartPointer<vtkIdTypeArray> ids =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+
+  if( cells )
+  {
+    ids = cells->GetData();
+  }
+
+  if( !writeBlob(file, ids, blob) )
+  {
+    return false;
+  }
+
+  meta << qint64(cells? cells->GetNumberOfCells() : 0) << blob;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkCellArray> readCells(
+  QDataStream& meta,
+  uchar* base,
+  qint64 fileSize,
+  std::shared_ptr<void> owner,
+  vtkIdType nofPoints,
+  vtkIdTypeArray* locations = nullptr)
+{
+  qint64    nofCells = 0;
+  CacheBlob blob;
+
+  meta >> nofCells >> blob;
+
+  vtkSmartPointer<vtkDataArray> arr = wrapBlob(blob, base, fileSize, owner);
+  vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(arr);
+
+  if( !ids || !isValidTopology(ids, nofCells, nofPoints, locations) )
+  {
+    return vtkSmartPointer<vtkCellArray>();
+  }
+
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  cells->SetCells(nofCells, ids);
+
+  return cells;
+}
+
+//------------------------------------------------------------------------------
+
+bool writeArrays(
+  QFile& file,
+  vtkDataSetAttributes* att,
+  qint8 association,
+  QList<QPair<QPair<qint8, QString>, CacheBlob>>& arrays)
+{
+  for( int i = 0; i < att->GetNumberOfArrays(); ++i )
+  {
+    vtkDataArray* arr = att->GetArray(i);
+
+    // String and variant arrays are not cached
+    if( !arr || !arr->GetName() )
+    {
+      continue;
+    }
+
+    CacheBlob blob;
+
+    if( !writeBlob(file, arr, blob) )
+    {
+      return false;
+    }
+
+    arrays << qMakePair(qMakePair(association, QString(arr->GetName())), blob);
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+GeometryCache::SourceStamps GeometryCache::GetSourceStamps(
+  const QString& sourceFile)
+{
+  QStringList fileNames(sourceFile);
+
+  for( const GeometryLoader::BlockInfo& block :
+       GeometryLoader::ReadBlockList(sourceFile) )
+  {
+    if( !fileNames.contains(block.m_fileName) )
+    {
+      fileNames << block.m_fileName;
+    }
+  }
+
+  SourceStamps stamps;
+
+  for( const QString& fileName : fileNames )
+  {
+    const QFileInfo info(fileName);
+
+    SourceStamp stamp;
+    stamp.m_fileName = info.absoluteFilePath();
+    stamp.m_size     = info.exists()? info.size() : -1;
+    stamp.m_modified = info.exists()?
+      info.lastModified().toMSecsSinceEpoch() : -1;
+
+    stamps << stamp;
+  }
+
+  return stamps;
+}
+
+//------------------------------------------------------------------------------
+
+QString GeometryCache::CacheFileName(const QString& sourceFile)
+{
+  return sourceFile + ".qvgc";
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryCache::IsValid(const QString& cacheFile, const QString& sourceFile)
+{
+  QFile file(cacheFile);
+  CacheFileHeader header;
+
+  if( !file.open(QIODevice::ReadOnly) ||
+      (file.read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+       sizeof(header)) ||
+      !isCompatibleHeader(header) ||
+      (header.m_sourcesOffset > static_cast<quint64>(file.size())) ||
+      (header.m_sourcesSize >
+       static_cast<quint64>(file.size()) - header.m_sourcesOffset) ||
+      !file.seek(header.m_sourcesOffset) )
+  {
+    return false;
+  }
+
+  // Restored sources (cp -p, rsync -t, archives) may be older than the cache
+  // and still differ from what it was written from, so the stamps must match
+  // exactly
+  const QByteArray sourcesData = file.read(header.m_sourcesSize);
+
+  QDataStream sourcesStream(sourcesData);
+  sourcesStream.setVersion(QDataStream::Qt_4_6);
+
+  SourceStamps sources;
+  sourcesStream >> sources;
+
+  return (sourcesStream.status() == QDataStream::Ok) &&
+    !sources.isEmpty() &&
+    (sources == GetSourceStamps(sourceFile));
+}
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr<Geometry> GeometryCache::Read(const QString& cacheFile)
+{
+  // The mapping lives as long as the last array wrapping it
+  std::shared_ptr<QFile> file = std::make_shared<QFile>(cacheFile);
+
+  if( !file->open(QIODevice::ReadOnly) )
+  {
+    return std::unique_ptr<Geometry>();
+  }
+
+  const qint64 fileSize = file->size();
+
+  if( fileSize < static_cast<qint64>(sizeof(CacheFileHeader)) )
+  {
+    return std::unique_ptr<Geometry>();
+  }
+
+  uchar* base = file->map(0, fileSize);
+
+  if( !base )
+  {
+    return std::unique_ptr<Geometry>();
+  }
+
+  CacheFileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+
+  if( !isCompatibleHeader(header) ||
+      (header.m_metadataOffset > static_cast<quint64>(fileSize)) ||
+      (header.m_metadataSize >
+       static_cast<quint64>(fileSize) - header.m_metadataOffset) )
+  {
+    qWarning("Incompatible geometry cache '%s'", qPrintable(cacheFile));
+    return std::unique_ptr<Geometry>();
+  }
+
+  const QByteArray metadata = QByteArray::fromRawData(
+    reinterpret_cast<const char*>(base + header.m_metadataOffset),
+    header.m_metadataSize);
+
+  QDataStream meta(metadata);
+  meta.setVersion(QDataStream::Qt_4_6);
+
+  std::unique_ptr<Geometry> geom =
+    std::unique_ptr<Geometry>(new Geometry());
+
+  // The ranges were computed when the cache was written, restoring them
+  // avoids touching (and paging in) every array of every part.
+  quint32 nofDatasets = 0;
+  meta >> nofDatasets;
+
+  for( quint32 d = 0; (d < nofDatasets) && (meta.status() == QDataStream::Ok);
+       ++d )
+  {
+    DatasetRegistry::DatasetInfo info;
+    meta >> info;
+
+    geom->m_datasets->setInfo(info);
+  }
+
+  quint32 nofParts = 0;
+  meta >> nofParts;
+
+  for( quint32 p = 0; (p < nofParts) && (meta.status() == QDataStream::Ok);
+       ++p )
+  {
+    QString   name;
+    qint32    dataType = 0;
+    CacheBlob pointsBlob;
+
+    meta >> name >> dataType >> pointsBlob;
+
+    vtkSmartPointer<vtkDataArray> pointsData =
+      wrapBlob(pointsBlob, base, fileSize, file);
+
+    if( !pointsData || (pointsData->GetNumberOfComponents() != 3) )
+    {
+      qWarning("Corrupted geometry cache '%s'", qPrintable(cacheFile));
+      return std::unique_ptr<Geometry>();
+    }
+
+    const vtkIdType nofPoints = pointsData->GetNumberOfTuples();
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointsData);
+
+    vtkSmartPointer<vtkPointSet> data;
+
+    if( dataType == VTK_UNSTRUCTURED_GRID )
+    {
+      CacheBlob typesBlob;
+      CacheBlob locationsBlob;
+
+      meta >> typesBlob >> locationsBlob;
+
+      vtkSmartPointer<vtkDataArray> typesData =
+        wrapBlob(typesBlob, base, fileSize, file);
+      vtkSmartPointer<vtkDataArray> locationsData =
+        wrapBlob(locationsBlob, base, fileSize, file);
+
+      vtkUnsignedCharArray* types =
+        vtkUnsignedCharArray::SafeDownCast(typesData);
+      vtkIdTypeArray* locations = vtkIdTypeArray::SafeDownCast(locationsData);
+
+      vtkSmartPointer<vtkCellArray> cells = locations?
+        readCells(meta, base, fileSize, file, nofPoints, locations) :
+        vtkSmartPointer<vtkCellArray>();
+
+      if( !types || !cells ||
+          !isValidCellTypes(types, cells->GetNumberOfCells()) )
+      {
+        qWarning("Corrupted geometry cache '%s'", qPrintable(cacheFile));
+        return std::unique_ptr<Geometry>();
+      }
+
+      vtkSmartPointer<vtkUnstructuredGrid> uGrid =
+        vtkSmartPointer<vtkUnstructuredGrid>::New();
+
+      uGrid->SetPoints(points);
+      uGrid->SetCells(types, locations, cells);
+
+      data = uGrid;
+    }
+    else if( dataType == VTK_POLY_DATA )
+    {
+      vtkSmartPointer<vtkCellArray> cells[4];
+
+      for( int c = 0; c < 4; ++c )
+      {
+        cells[c] = readCells(meta, base, fileSize, file, nofPoints);
+
+        if( !cells[c] )
+        {
+          qWarning("Corrupted geometry cache '%s'", qPrintable(cacheFile));
+          return std::unique_ptr<Geometry>();
+        }
+      }
+
+      vtkSmartPointer<vtkPolyData> pData =
+        vtkSmartPointer<vtkPolyData>::New();
+
+      pData->SetPoints(points);
+      pData->SetVerts(cells[0]);
+      pData->SetLines(cells[1]);
+      pData->SetPolys(cells[2]);
+      pData->SetStrips(cells[3]);
+
+      data = pData;
+    }
+    else
+    {
+      return std::unique_ptr<Geometry>();
+    }
+
+    quint32 nofArrays = 0;
+    meta >> nofArrays;
+
+    for( quint32 a = 0; a < nofArrays; ++a )
+    {
+      qint8     association = CACHE_POINT_DATA;
+      QString   arrayName;
+      CacheBlob blob;
+
+      meta >> association >> arrayName >> blob;
+
+      vtkSmartPointer<vtkDataArray> arr = wrapBlob(blob, base, fileSize, file);
+
+      const vtkIdType nofTuples = (association == CACHE_CELL_DATA)?
+        data->GetNumberOfCells() : nofPoints;
+
+      if( !arr || (arr->GetNumberOfTuples() != nofTuples) )
+      {
+        qWarning("Corrupted geometry cache '%s'", qPrintable(cacheFile));
+        return std::unique_ptr<Geometry>();
+      }
+
+      arr->SetName(qPrintable(arrayName));
+
+      if( association == CACHE_CELL_DATA )
+      {
+        data->GetCellData()->AddArray(arr);
+      }
+      else
+      {
+        data->GetPointData()->AddArray(arr);
+      }
+    }
+
+    std::unique_ptr<GeometryPart> part =
+      std::unique_ptr<GeometryPart>(new GeometryPart());
+
+    part->setPartName(name);
+    part->setGeometryData(data);
+
+    geom->appendPart(std::shared_ptr<GeometryPart>(std::move(part)));
+  }
+
+  if( meta.status() != QDataStream::Ok )
+  {
+    qWarning("Corrupted geometry cache '%s'", qPrintable(cacheFile));
+    return std::unique_ptr<Geometry>();
+  }
+
+  return geom;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryCache::Write(
+  const QString& cacheFile,
+  const Geometry& geometry,
+  const SourceStamps& sources)
+{
+  return WriteSnapshot(cacheFile, TakeSnapshot(geometry, sources));
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryCache::WriteInBackground(
+  const QString& cacheFile,
+  const Geometry& geometry,
+  const SourceStamps& sources)
+{
+  QtConcurrent::run(&GeometryCache::WriteSnapshot,
+    cacheFile,
+    TakeSnapshot(geometry, sources));
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryCache::IsEnabled()
+{
+  return s_enabled;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryCache::SetEnabled(bool enabled)
+{
+  s_enabled = enabled;
+}
+
+//------------------------------------------------------------------------------
+
+GeometryCache::Snapshot GeometryCache::TakeSnapshot(
+  const Geometry& geometry,
+  const SourceStamps& sources)
+{
+  Snapshot snapshot;
+  snapshot.m_datasets = *geometry.m_datasets;
+  snapshot.m_sources  = sources;
+
+  for( auto part : geometry.m_geomParts )
+  {
+    vtkPointSet* data = vtkPointSet::SafeDownCast(part->getGeometryData());
+
+    if( data && data->GetPoints() )
+    {
+      PartSnapshot partSnapshot;
+      partSnapshot.m_name = part->getPartName();
+      partSnapshot.m_data.TakeReference(data->NewInstance());
+      partSnapshot.m_data->ShallowCopy(data);
+
+      snapshot.m_parts << partSnapshot;
+    }
+  }
+
+  return snapshot;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryCache::WriteSnapshot(
+  const QString& cacheFile,
+  const Snapshot& snapshot)
+{
+  const QString tmpFileName = cacheFile + ".tmp";
+
+  QFile file(tmpFileName);
+
+  if( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+  {
+    qWarning("Could not write geometry cache '%s'", qPrintable(cacheFile));
+    return false;
+  }
+
+  CacheFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.m_magic, CacheMagic, sizeof(CacheMagic));
+  header.m_version       = Version;
+  header.m_byteOrderMark = CacheByteOrderMark;
+  header.m_idTypeSize    = sizeof(vtkIdType);
+
+  bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header))
+    == sizeof(header);
+
+  QByteArray  metadata;
+  QDataStream meta(&metadata, QIODevice::WriteOnly);
+  meta.setVersion(QDataStream::Qt_4_6);
+
+  const QList<PartSnapshot>& parts = snapshot.m_parts;
+
+  meta << quint32(snapshot.m_datasets.getNofDatasets());
+
+  for( int d = 0; d < snapshot.m_datasets.getNofDatasets(); ++d )
+  {
+    meta << snapshot.m_datasets.getInfo(d);
+  }
+
+  meta << quint32(parts.size());
+
+  for( int p = 0; ok && (p < parts.size()); ++p )
+  {
+    vtkPointSet* data = parts[p].m_data;
+
+    // Parts without points or cells have no such arrays, they are written
+    // empty like the cells in writeCells()
+    vtkSmartPointer<vtkDataArray> pointsData =
+      vtkSmartPointer<vtkFloatArray>::New();
+    pointsData->SetNumberOfComponents(3);
+
+    if( data->GetPoints() )
+    {
+      pointsData = data->GetPoints()->GetData();
+    }
+
+    CacheBlob pointsBlob;
+    ok = writeBlob(file, pointsData, pointsBlob);
+
+    meta << parts[p].m_name
+         << qint32(data->GetDataObjectType())
+         << pointsBlob;
+
+    if( auto uGrid = vtkUnstructuredGrid::SafeDownCast(data) )
+    {
+      CacheBlob typesBlob;
+      CacheBlob locationsBlob;
+
+      vtkSmartPointer<vtkDataArray> types =
+        vtkSmartPointer<vtkUnsignedCharArray>::New();
+      vtkSmartPointer<vtkDataArray> locations =
+        vtkSmartPointer<vtkIdTypeArray>::New();
+
+      if( uGrid->GetCellTypesArray() )
+      {
+        types = uGrid->GetCellTypesArray();
+      }
+
+      if( uGrid->GetCellLocationsArray() )
+      {
+        locations = uGrid->GetCellLocationsArray();
+      }
+
+      ok = ok &&
+        writeBlob(file, types, typesBlob) &&
+        writeBlob(file, locations, locationsBlob);
+
+      meta << typesBlob << locationsBlob;
+
+      ok = ok && writeCells(file, meta, uGrid->GetCells());
+    }
+    else if( auto pData = vtkPolyData::SafeDownCast(data) )
+    {
+      ok = ok &&
+        writeCells(file, meta, pData->GetVerts()) &&
+        writeCells(file, meta, pData->GetLines()) &&
+        writeCells(file, meta, pData->GetPolys()) &&
+        writeCells(file, meta, pData->GetStrips());
+    }
+
+    QList<QPair<QPair<qint8, QString>, CacheBlob>> arrays;
+
+    ok = ok &&
+      writeArrays(file, data->GetPointData(), CACHE_POINT_DATA, arrays) &&
+      writeArrays(file, data->GetCellData(), CACHE_CELL_DATA, arrays);
+
+    meta << quint32(arrays.size());
+
+    for( auto& arr : arrays )
+    {
+      meta << arr.first.first << arr.first.second << arr.second;
+    }
+  }
+
+  ok = ok && alignFile(file);
+
+  header.m_metadataOffset = file.pos();
+  header.m_metadataSize   = metadata.size();
+
+  ok = ok && (file.write(metadata) == metadata.size());
+
+  QByteArray  sourcesData;
+  QDataStream sources(&sourcesData, QIODevice::WriteOnly);
+  sources.setVersion(QDataStream::Qt_4_6);
+  sources << snapshot.m_sources;
+
+  header.m_sourcesOffset = file.pos();
+  header.m_sourcesSize   = sourcesData.size();
+
+  ok = ok &&
+    (file.write(sourcesData) == sourcesData.size()) &&
+    file.seek(0) &&
+    (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ==
+     sizeof(header));
+
+  file.close();
+
+  if( !ok )
+  {
+    qWarning("Could not write geometry cache '%s'", qPrintable(cacheFile));
+
+    QFile::remove(tmpFileName);
+    return false;
+  }
+
+  QFile::remove(cacheFile);
+  return QFile::rename(tmpFileName, cacheFile);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef GEOMETRYCACHE_H
+#define GEOMETRYCACHE_H
+
+#include "DatasetRegistry.h"
+
+#include <QList>
+#include <QString>
+
+#include <vtkSmartPointer.h>
+
+#include <memory>
+
+class vtkPointSet;
+
+class Geometry;
+
+// Native binary image of a Geometry: points, cells, point/cell arrays and the
+// dataset ranges. Reading maps the file and wraps every array in place, so
+// nothing is parsed or copied. The topology is checked when it is read, the
+// other arrays are only paged in when touched.
+class GeometryCache
+{
+public:
+  static const quint32 Version = 3;
+
+  // Size and modification time of a file the cache was written from
+  struct SourceStamp
+  {
+    QString m_fileName;
+    qint64  m_size;
+    qint64  m_modified;   // msecs since epoch
+  };
+
+  typedef QList<SourceStamp> SourceStamps;
+
+  // Of the source file and of the block files it lists
+  static SourceStamps GetSourceStamps(const QString& sourceFile);
+
+  static QString CacheFileName(const QString& sourceFile);
+
+  // The cache is valid when every source still has the size and time it had
+  // when it was read, older or newer
+  static bool IsValid(const QString& cacheFile, const QString& sourceFile);
+
+  static std::unique_ptr<Geometry> Read(const QString& cacheFile);
+
+  // The stamps are taken before the sources are read, see GeometryLoader
+  static bool Write(
+    const QString& cacheFile,
+    const Geometry& geometry,
+    const SourceStamps& sources);
+  static void WriteInBackground(
+    const QString& cacheFile,
+    const Geometry& geometry,
+    const SourceStamps& sources);
+
+  static bool IsEnabled();
+  static void SetEnabled(bool enabled);
+
+protected:
+  // Shallow copies taken in the GUI thread, parts may be evicted (see
+  // PartCache) while the snapshot is written
+  struct PartSnapshot
+  {
+    QString                      m_name;
+    vtkSmartPointer<vtkPointSet> m_data;
+  };
+
+  struct Snapshot
+  {
+    QList<PartSnapshot> m_parts;
+    DatasetRegistry     m_datasets;
+    SourceStamps        m_sources;
+  };
+
+  static Snapshot TakeSnapshot(
+    const Geometry& geometry,
+    const SourceStamps& sources);
+  static bool WriteSnapshot(const QString& cacheFile, const Snapshot& snapshot);
+
+  static bool s_enabled;
+};
+
+#endif // GEOMETRYCACHE_H
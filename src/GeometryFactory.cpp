@@ -22,13 +22,26 @@
 #include "GeometryFactory.h"
 
 #include "Geometry.h"
+#include "GeometryCache.h"
+#include "GeometryLoader.h"
 #include "GeometryPart.h"
+#include "LiveSource.h"
+#include "ProceduralGeometry.h"
+#include "TimeSeriesPlayer.h"
+
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QStringList>
 
 #include <vtkAlgorithmOutput.h>
 #include <vtkDoubleArray.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
 #include <vtkCubeSource.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <algorithm>
+#include <cmath>
 
 //------------------------------------------------------------------------------
 
@@ -150,7 +163,16 @@ std::unique_ptr<Geometry> GeometryFactory::CreateBasicGeometry(
     case CUBE_GEOMETRY:
       return createCubeGeometry();
 
-    case SPHERE_GEOMETRY: // Not implemented yet
+    case SPHERE_GEOMETRY:
+      return CreateProceduralGeometry(type, 20000);
+
+    case BOX_GEOMETRY:
+    case TETRA_GEOMETRY:
+      return CreateProceduralGeometry(type, 32768);
+
+    case ASSEMBLY_GEOMETRY:
+      return CreateProceduralGeometry(type, 1000000, 64);
+
     default:
       return std::unique_ptr<Geometry>();
   }
@@ -158,4 +180,227 @@ std::unique_ptr<Geometry> GeometryFactory::CreateBasicGeometry(
 
 //------------------------------------------------------------------------------
 
+std::unique_ptr<Geometry> GeometryFactory::CreateProceduralGeometry(
+  BasicGeometries type,
+  vtkIdType nofCells,
+  int nofParts)
+{
+  if( (nofCells < 1) || (nofParts < 1) )
+  {
+    return std::unique_ptr<Geometry>();
+  }
+
+  std::unique_ptr<Geometry> geom =
+    std::unique_ptr<Geometry>(new Geometry());
+
+  // Unit cells with a gap, the fields are continuous across the parts
+  const int    side    = static_cast<int>(std::ceil(std::cbrt(nofParts)));
+  const double spacing = 1.1;
+
+  const vtkIdType nofPartCells = std::max<vtkIdType>(1, nofCells / nofParts);
+
+  static const BasicGeometries assemblyTypes[] =
+    {SPHERE_GEOMETRY, BOX_GEOMETRY, TETRA_GEOMETRY};
+
+  for( int p = 0; p < nofParts; ++p )
+  {
+    const double origin[3] = {
+      spacing * (p % side),
+      spacing * ((p / side) % side),
+      spacing * (p / (side * side))};
+
+    const double bounds[6] = {
+      origin[0], origin[0] + 1.0,
+      origin[1], origin[1] + 1.0,
+      origin[2], origin[2] + 1.0};
+
+    const BasicGeometries partType =
+      (type == ASSEMBLY_GEOMETRY)? assemblyTypes[p % 3] : type;
+
+    vtkSmartPointer<vtkDataSet> data;
+    QString name;
+
+    switch( partType )
+    {
+      case SPHERE_GEOMETRY:
+      {
+        const double center[3] = {
+          origin[0] + 0.5, origin[1] + 0.5, origin[2] + 0.5};
+
+        data = ProceduralGeometry::CreateSphere(nofPartCells, center, 0.5);
+        name = "Sphere";
+        break;
+      }
+
+      case TETRA_GEOMETRY:
+        data = ProceduralGeometry::CreateTetraVolume(nofPartCells, bounds);
+        name = "Tetra";
+        break;
+
+      default:
+        data = ProceduralGeometry::CreateBox(nofPartCells, bounds);
+        name = "Box";
+        break;
+    }
+
+    std::unique_ptr<GeometryPart> part =
+      std::unique_ptr<GeometryPart>(new GeometryPart());
+
+    part->setPartName(QString("%1_part_%2").arg(name).arg(p));
+    part->setGeometryData(data);
+
+    geom->addPart(std::move(part));
+  }
+
+  return geom;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryFactory::IsProceduralSpec(const QString& spec)
+{
+  const QString type = spec.section(':', 0, 0).toLower();
+
+  return (type == "sphere") ||
+    (type == "box") ||
+    (type == "tetra") ||
+    (type == "assembly");
+}
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr<Geometry> GeometryFactory::CreateProceduralGeometry(
+  const QString& spec)
+{
+  if( !IsProceduralSpec(spec) )
+  {
+    return std::unique_ptr<Geometry>();
+  }
+
+  const QStringList fields = spec.split(':');
+  const QString     type   = fields[0].toLower();
+
+  BasicGeometries geomType = ASSEMBLY_GEOMETRY;
+
+  if( type == "sphere" )
+  {
+    geomType = SPHERE_GEOMETRY;
+  }
+  else if( type == "box" )
+  {
+    geomType = BOX_GEOMETRY;
+  }
+  else if( type == "tetra" )
+  {
+    geomType = TETRA_GEOMETRY;
+  }
+
+  if( fields.size() < 2 )
+  {
+    return CreateBasicGeometry(geomType);
+  }
+
+  QString cells = fields[1].toUpper();
+  double  scale = 1.0;
+
+  if( cells.endsWith('K') || cells.endsWith('M') || cells.endsWith('G') )
+  {
+    scale = cells.endsWith('K')? 1e3 : (cells.endsWith('M')? 1e6 : 1e9);
+    cells.chop(1);
+  }
+
+  bool cellsOk = false;
+  const double nofCells = cells.toDouble(&cellsOk) * scale;
+
+  bool partsOk = true;
+  const int nofParts = (fields.size() > 2)? fields[2].toInt(&partsOk) : 1;
+
+  if( !cellsOk || !partsOk )
+  {
+    qWarning("Invalid procedural geometry '%s'", qPrintable(spec));
+    return std::unique_ptr<Geometry>();
+  }
+
+  return CreateProceduralGeometry(
+    geomType,
+    static_cast<vtkIdType>(nofCells),
+    nofParts);
+}
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr<Geometry> GeometryFactory::CreateGeometryFromFile(
+  QString fileName)
+{
+  // Transient case, the player reads the first time step in background and
+  // it creates the parts
+  if( QFileInfo(fileName).suffix().toLower() == "pvd" )
+  {
+    const QList<TimeSeriesPlayer::StepInfo> steps =
+      TimeSeriesPlayer::ReadStepList(fileName);
+
+    if( steps.isEmpty() )
+    {
+      return std::unique_ptr<Geometry>();
+    }
+
+    std::unique_ptr<Geometry> geom =
+      std::unique_ptr<Geometry>(new Geometry());
+
+    new TimeSeriesPlayer(steps, geom.get());
+
+    return geom;
+  }
+
+  if( !GeometryLoader::CanReadFile(fileName) )
+  {
+    return std::unique_ptr<Geometry>();
+  }
+
+  const QString cacheFile = GeometryCache::CacheFileName(fileName);
+
+  if( GeometryCache::IsEnabled() &&
+      GeometryCache::IsValid(cacheFile, fileName) )
+  {
+    if( std::unique_ptr<Geometry> geom = GeometryCache::Read(cacheFile) )
+    {
+      // Loaded already, queued so the caller can connect to it first like
+      // to a GeometryLoader
+      QMetaObject::invokeMethod(
+        geom.get(), "loadFinished", Qt::QueuedConnection);
+
+      return geom;
+    }
+  }
+
+  std::unique_ptr<Geometry> geom =
+    std::unique_ptr<Geometry>(new Geometry());
+
+  // The loader is a child of the geometry: parts are published to it as
+  // they are read and pending reads are cancelled if it gets deleted.
+  GeometryLoader* loader = new GeometryLoader(fileName, geom.get());
+  loader->start();
+
+  return geom;
+}
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr<Geometry> GeometryFactory::CreateLiveGeometry(
+  const QString& segmentName)
+{
+  std::unique_ptr<Geometry> geom =
+    std::unique_ptr<Geometry>(new Geometry());
 
+  // The source is a child of the geometry, it stops polling with it
+  LiveSource* source = new LiveSource(segmentName, geom.get());
+
+  if( !source->attach() )
+  {
+    return std::unique_ptr<Geometry>();
+  }
+
+  return geom;
+}
+
+//------------------------------------------------------------------------------
@@ -24,6 +24,8 @@
 
 #include <QString>
 
+#include <vtkType.h>
+
 #include <memory>
 
 class Geometry;
@@ -33,12 +35,33 @@ class GeometryFactory
 public:
   enum BasicGeometries {
     CUBE_GEOMETRY,
-    SPHERE_GEOMETRY
+    SPHERE_GEOMETRY,
+    BOX_GEOMETRY,
+    TETRA_GEOMETRY,
+    ASSEMBLY_GEOMETRY
   };
 
   static std::unique_ptr<Geometry> CreateBasicGeometry(BasicGeometries type);
 
+  // Generated geometries for stress tests (see ProceduralGeometry): about
+  // nofCells cells over nofParts parts laid out on a lattice. The cube is
+  // generated as a box, an assembly cycles through sphere, box and tetra
+  // parts.
+  static std::unique_ptr<Geometry> CreateProceduralGeometry(
+    BasicGeometries type,
+    vtkIdType nofCells,
+    int nofParts = 1);
+
+  // "sphere|box|tetra|assembly[:cells[:parts]]", cells may end in K, M or G
+  static bool IsProceduralSpec(const QString& spec);
+  static std::unique_ptr<Geometry> CreateProceduralGeometry(
+    const QString& spec);
+
   static std::unique_ptr<Geometry> CreateGeometryFromFile(QString fileName);
+
+  // Parts followed live from a solver shared-memory segment, see LiveSource
+  static std::unique_ptr<Geometry> CreateLiveGeometry(
+    const QString& segmentName);
 };
 
 #endif // GEOMETRYFACTORY_H
@@ -0,0 +1,471 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "GeometryLoader.h"
+
+#include "Geometry.h"
+#include "GeometryCache.h"
+#include "GeometryPart.h"
+#include "PartCache.h"
+#include "Tracer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QStringList>
+#include <QThread>
+#include <QXmlStreamReader>
+
+#include <vtkAppendFilter.h>
+#include <vtkDataSet.h>
+#include <vtkDataSetReader.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkXMLGenericDataObjectReader.h>
+
+//------------------------------------------------------------------------------
+
+class GeometryLoader::BlockReader : public QRunnable
+{
+public:
+  BlockReader(GeometryLoader* loader, const BlockInfo& block)
+    :
+    m_loader(loader),
+    m_block(block)
+  {
+  }
+
+  virtual void run()
+  {
+    std::unique_ptr<GeometryPart> part;
+
+    if( !m_loader->m_cancelled )
+    {
+      vtkSmartPointer<vtkDataSet> data = ReadBlock(m_block);
+
+      if( data )
+      {
+        part = std::unique_ptr<GeometryPart>(new GeometryPart());
+        part->setPartName(m_block.m_name);
+        // Converted here instead of when the part is added in the GUI thread
+        part->setPrecisionPolicy(m_loader->m_precision);
+        part->setGeometryData(data);
+        part->setDataSource(m_block.m_fileName);
+
+        // Warm the range cache here so Geometry::addPart does not scan the
+        // arrays again in the GUI thread
+        part->getPointDataRanges();
+        part->getCellDataRanges();
+
+        // Published with its ranges and bounds only, see PartCache
+        if( PartCache::IsDeferredLoading() )
+        {
+          part->evict();
+        }
+      }
+      else
+      {
+        qWarning("Could not read block '%s' from '%s'",
+          qPrintable(m_block.m_name),
+          qPrintable(m_block.m_fileName));
+      }
+    }
+
+    m_loader->blockRead(std::move(part));
+  }
+
+protected:
+  GeometryLoader* m_loader;
+  BlockInfo       m_block;
+};
+
+//------------------------------------------------------------------------------
+
+void readMultiBlockIndex(
+  const QString& fileName,
+  const QString& prefix,
+  QList<GeometryLoader::BlockInfo>& blocks)
+{
+  QFile file(fileName);
+
+  if( !file.open(QIODevice::ReadOnly) )
+  {
+    return;
+  }
+
+  const QDir baseDir = QFileInfo(fileName).absoluteDir();
+
+  QStringList blockNames;
+  if( !prefix.isEmpty() )
+  {
+    blockNames << prefix;
+  }
+
+  QXmlStreamReader xml(&file);
+
+  while( !xml.atEnd() )
+  {
+    xml.readNext();
+
+    const QXmlStreamAttributes attributes = xml.attributes();
+
+    if( xml.isStartElement() && (xml.name() == QLatin1String("Block")) )
+    {
+      QString name = attributes.value(QLatin1String("name")).toString();
+
+      if( name.isEmpty() )
+      {
+        name = QString("Block_%1").arg(
+          attributes.value(QLatin1String("index")).toString());
+      }
+
+      blockNames << name;
+    }
+    else if( xml.isEndElement() && (xml.name() == QLatin1String("Block")) )
+    {
+      if( !blockNames.isEmpty() )
+      {
+        blockNames.removeLast();
+      }
+    }
+    else if( xml.isStartElement() && (xml.name() == QLatin1String("DataSet")) )
+    {
+      const QString file = attributes.value(QLatin1String("file")).toString();
+
+      if( file.isEmpty() )
+      {
+        continue;
+      }
+
+      QString name = attributes.value(QLatin1String("name")).toString();
+
+      if( name.isEmpty() )
+      {
+        name = QFileInfo(file).completeBaseName();
+      }
+
+      QStringList fullName = blockNames;
+      fullName << name;
+
+      const QString blockFile = baseDir.absoluteFilePath(file);
+
+      if( QFileInfo(blockFile).suffix().toLower() == "vtm" )
+      {
+        readMultiBlockIndex(blockFile, fullName.join("/"), blocks);
+      }
+      else
+      {
+        GeometryLoader::BlockInfo block;
+        block.m_name     = fullName.join("/");
+        block.m_fileName = blockFile;
+
+        blocks << block;
+      }
+    }
+  }
+
+  if( xml.hasError() )
+  {
+    qWarning("Error parsing '%s': %s",
+      qPrintable(fileName),
+      qPrintable(xml.errorString()));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+GeometryLoader::GeometryLoader(const QString& fileName, Geometry* geometry)
+  :
+  QObject(geometry),
+  m_geometry(geometry),
+  m_fileName(fileName),
+  m_nofReadBlocks(0),
+  m_cancelled(false),
+  m_nofPublishedBlocks(0),
+  m_finished(false)
+{
+  m_pool.setMaxThreadCount(QThread::idealThreadCount());
+
+  if( m_geometry )
+  {
+    connect(
+      this,       SIGNAL(progress(int, int)),
+      m_geometry, SIGNAL(loadProgress(int, int)));
+
+    connect(
+      this,       SIGNAL(finished()),
+      m_geometry, SIGNAL(loadFinished()));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+GeometryLoader::~GeometryLoader()
+{
+  cancel();
+  m_pool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryLoader::CanReadFile(const QString& fileName)
+{
+  const QFileInfo info(fileName);
+  const QString   suffix = info.suffix().toLower();
+
+  return info.isFile() && (
+    (suffix == "vtu") ||
+    (suffix == "vtp") ||
+    (suffix == "vtm") ||
+    (suffix == "vtk") );
+}
+
+//------------------------------------------------------------------------------
+
+QList<GeometryLoader::BlockInfo> GeometryLoader::ReadBlockList(
+  const QString& fileName)
+{
+  QList<BlockInfo> blocks;
+
+  if( QFileInfo(fileName).suffix().toLower() == "vtm" )
+  {
+    readMultiBlockIndex(fileName, QString(), blocks);
+  }
+  else
+  {
+    BlockInfo block;
+    block.m_name     = QFileInfo(fileName).completeBaseName();
+    block.m_fileName = fileName;
+
+    blocks << block;
+  }
+
+  return blocks;
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkDataSet> GeometryLoader::ReadBlock(const BlockInfo& block)
+{
+  TRACE_SCOPE("GeometryLoader::ReadBlock");
+
+  vtkSmartPointer<vtkDataSet> data;
+
+  if( QFileInfo(block.m_fileName).suffix().toLower() == "vtk" )
+  {
+    vtkSmartPointer<vtkDataSetReader> reader =
+      vtkSmartPointer<vtkDataSetReader>::New();
+
+    reader->SetFileName(qPrintable(block.m_fileName));
+    reader->Update();
+
+    data = reader->GetOutput();
+  }
+  else
+  {
+    vtkSmartPointer<vtkXMLGenericDataObjectReader> reader =
+      vtkSmartPointer<vtkXMLGenericDataObjectReader>::New();
+
+    reader->SetFileName(qPrintable(block.m_fileName));
+    reader->Update();
+
+    data = vtkDataSet::SafeDownCast(reader->GetOutput());
+  }
+
+  if( !data || (data->GetNumberOfPoints() == 0) )
+  {
+    return vtkSmartPointer<vtkDataSet>();
+  }
+
+  // GeometryPart only keeps unstructured grids and polydata, any other
+  // dataset type (image, rectilinear, structured) is converted here so the
+  // conversion also runs on the worker thread.
+  if( !vtkUnstructuredGrid::SafeDownCast(data) &&
+      !vtkPolyData::SafeDownCast(data) )
+  {
+    vtkSmartPointer<vtkAppendFilter> toGrid =
+      vtkSmartPointer<vtkAppendFilter>::New();
+
+    toGrid->AddInputData(data);
+    toGrid->Update();
+
+    data = toGrid->GetOutput();
+  }
+
+  return data;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryLoader::start()
+{
+  // Taken before reading, a source changed meanwhile invalidates the cache
+  if( GeometryCache::IsEnabled() )
+  {
+    m_sourceStamps = GeometryCache::GetSourceStamps(m_fileName);
+  }
+
+  m_blocks = ReadBlockList(m_fileName);
+
+  if( m_geometry )
+  {
+    m_precision = m_geometry->getPrecisionPolicy();
+  }
+
+  if( m_blocks.isEmpty() )
+  {
+    qWarning("No blocks found in '%s'", qPrintable(m_fileName));
+
+    // Queued like the completion of a normal load, the caller connects to
+    // it after start()
+    m_finished = true;
+    QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+    return;
+  }
+
+  emit progress(0, m_blocks.size());
+
+  for( const BlockInfo& block : m_blocks )
+  {
+    m_pool.start(new BlockReader(this, block));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryLoader::cancel()
+{
+  m_cancelled = true;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryLoader::waitForFinished()
+{
+  m_pool.waitForDone();
+
+  publishParts();
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryLoader::isFinished() const
+{
+  return m_finished;
+}
+
+//------------------------------------------------------------------------------
+
+int GeometryLoader::getNofBlocks() const
+{
+  return m_blocks.size();
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryLoader::blockRead(std::unique_ptr<GeometryPart> part)
+{
+  bool firstPending = false;
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    if( part )
+    {
+      m_pendingParts.push_back(std::move(part));
+    }
+
+    ++m_nofReadBlocks;
+
+    firstPending = (m_pendingParts.size() <= 1);
+  }
+
+  // A single queued call drains every part read in the meantime
+  if( firstPending )
+  {
+    QMetaObject::invokeMethod(this, "publishParts", Qt::QueuedConnection);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryLoader::publishParts()
+{
+  std::vector<std::unique_ptr<GeometryPart>> parts;
+  int nofReadBlocks = 0;
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    parts.swap(m_pendingParts);
+    nofReadBlocks = m_nofReadBlocks;
+  }
+
+  if( m_finished )
+  {
+    return;
+  }
+
+  for( auto& part : parts )
+  {
+    m_geometry->addPart(std::move(part));
+  }
+
+  // Adding parts may process events and re-enter this slot
+  if( m_finished || (nofReadBlocks <= m_nofPublishedBlocks) )
+  {
+    return;
+  }
+
+  m_nofPublishedBlocks = nofReadBlocks;
+
+  emit progress(m_nofPublishedBlocks, m_blocks.size());
+
+  if( m_nofPublishedBlocks == m_blocks.size() )
+  {
+    m_finished = true;
+
+    // Only complete geometries are cached, a failed block is re-read next time.
+    // Parts without data (see PartCache) are not read again for the cache.
+    bool resident = true;
+
+    for( const auto& part : m_geometry->getParts() )
+    {
+      resident = resident && part.lock()->isLoaded();
+    }
+
+    if( GeometryCache::IsEnabled() && resident &&
+        (m_geometry->getNofParts() == m_blocks.size()) )
+    {
+      GeometryCache::WriteInBackground(
+        GeometryCache::CacheFileName(m_fileName),
+        *m_geometry,
+        m_sourceStamps);
+    }
+
+    emit finished();
+  }
+}
+
+//------------------------------------------------------------------------------
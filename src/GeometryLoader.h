@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef GEOMETRYLOADER_H
+#define GEOMETRYLOADER_H
+
+#include "GeometryCache.h"
+#include "PrecisionConverter.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class vtkDataSet;
+
+class Geometry;
+class GeometryPart;
+
+// Reads the blocks of a .vtu/.vtp/.vtm/.vtk file on a worker pool and
+// publishes every block as a GeometryPart of the target Geometry (in the GUI
+// thread) as soon as it has been read. The loader is owned by the Geometry,
+// so deleting the Geometry cancels the pending blocks.
+class GeometryLoader : public QObject
+{
+  Q_OBJECT
+public:
+  struct BlockInfo
+  {
+    QString m_name;
+    QString m_fileName;
+  };
+
+  explicit GeometryLoader(const QString& fileName, Geometry* geometry);
+  virtual ~GeometryLoader();
+
+  static bool CanReadFile(const QString& fileName);
+  static QList<BlockInfo> ReadBlockList(const QString& fileName);
+  static vtkSmartPointer<vtkDataSet> ReadBlock(const BlockInfo& block);
+
+  void start();
+  void cancel();
+  void waitForFinished();
+
+  bool isFinished() const;
+  int getNofBlocks() const;
+
+signals:
+  void progress(int loadedBlocks, int totalBlocks);
+  void finished();
+
+protected slots:
+  void publishParts();
+
+protected:
+  class BlockReader;
+
+  void blockRead(std::unique_ptr<GeometryPart> part);
+
+  Geometry*         m_geometry;
+  QString           m_fileName;
+  QList<BlockInfo>  m_blocks;
+  PrecisionPolicy   m_precision;   // Of the geometry when started
+
+  GeometryCache::SourceStamps m_sourceStamps;
+  QThreadPool       m_pool;
+
+  QMutex                                     m_mutex;
+  std::vector<std::unique_ptr<GeometryPart>> m_pendingParts;
+  int                                        m_nofReadBlocks;
+
+  std::atomic<bool> m_cancelled;
+  int               m_nofPublishedBlocks;
+  bool              m_finished;
+};
+
+#endif // GEOMETRYLOADER_H
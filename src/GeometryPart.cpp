@@ -21,23 +21,190 @@
 //------------------------------------------------------------------------------
 #include "GeometryPart.h"
 
+#include "ExternalArray.h"
+#include "GeometryLoader.h"
+#include "LODProxySet.h"
+#include "PartBanding.h"
+#include "PartCache.h"
+#include "PartLocator.h"
+#include "Tracer.h"
+
 #include <vtkAlgorithmOutput.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataArray.h>
+#include <vtkGeometryFilter.h>
+#include <vtkIdTypeArray.h>
 #include <vtkPassThrough.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPointSet.h>
 #include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
 #include <vtkUnstructuredGrid.h>
 
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+bool isNumericType(int dataType)
+{
+  switch( dataType )
+  {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+    case VTK_UNSIGNED_CHAR:
+    case VTK_SHORT:
+    case VTK_UNSIGNED_SHORT:
+    case VTK_INT:
+    case VTK_UNSIGNED_INT:
+    case VTK_LONG:
+    case VTK_UNSIGNED_LONG:
+    case VTK_LONG_LONG:
+    case VTK_UNSIGNED_LONG_LONG:
+    case VTK_ID_TYPE:
+    case VTK_FLOAT:
+    case VTK_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool isValidField(const ExternalBuffer& buffer, vtkIdType nofTuples)
+{
+  return !buffer.isEmpty() &&
+    (buffer.m_nofTuples == nofTuples) &&
+    (buffer.m_nofComponents > 0) &&
+    isNumericType(buffer.m_dataType);
+}
+
+// The cell starting at location fits in the connectivity and only uses
+// existing points
+bool isValidCell(
+  const vtkIdType* connectivity,
+  vtkIdType size,
+  vtkIdType location,
+  vtkIdType nofPoints)
+{
+  if( (location < 0) || (location >= size) )
+  {
+    return false;
+  }
+
+  const vtkIdType nofCellPoints = connectivity[location];
+
+  if( (nofCellPoints < 0) || (nofCellPoints >= size - location) )
+  {
+    return false;
+  }
+
+  for( vtkIdType p = 1; p <= nofCellPoints; ++p )
+  {
+    const vtkIdType id = connectivity[location + p];
+
+    if( (id < 0) || (id >= nofPoints) )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool hasArray(vtkFieldData* fields, vtkAbstractArray* array)
+{
+  for( int a = 0; a < fields->GetNumberOfArrays(); ++a )
+  {
+    if( fields->GetAbstractArray(a) == array )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// KiB of the field arrays of derived not passed through from data
+qint64 getUnsharedSize(vtkFieldData* derived, vtkFieldData* data)
+{
+  qint64 kiBytes = 0;
+
+  for( int a = 0; a < derived->GetNumberOfArrays(); ++a )
+  {
+    vtkAbstractArray* array = derived->GetAbstractArray(a);
+
+    if( !hasArray(data, array) )
+    {
+      kiBytes += array->GetActualMemorySize();
+    }
+  }
+
+  return kiBytes;
+}
+
+// KiB of the surface not shared with the data it was extracted from, the
+// geometry filter passes the points and point arrays through where it can
+qint64 getUnsharedSize(vtkPolyData* surface, vtkDataSet* data)
+{
+  qint64 kiBytes = 0;
+
+  vtkPointSet* pointSet = vtkPointSet::SafeDownCast(data);
+
+  if( surface->GetPoints() &&
+      (!pointSet || (surface->GetPoints() != pointSet->GetPoints())) )
+  {
+    kiBytes += surface->GetPoints()->GetData()->GetActualMemorySize();
+  }
+
+  for( vtkCellArray* cells : { surface->GetVerts(), surface->GetLines(),
+                               surface->GetPolys(), surface->GetStrips() } )
+  {
+    kiBytes += cells? cells->GetActualMemorySize() : 0;
+  }
+
+  kiBytes += getUnsharedSize(surface->GetPointData(), data->GetPointData());
+  kiBytes += getUnsharedSize(surface->GetCellData(), data->GetCellData());
+
+  return kiBytes;
+}
+
+}
+
 //------------------------------------------------------------------------------
 
 GeometryPart::GeometryPart()
   :
-  m_inputFilter( vtkSmartPointer<vtkPassThrough>::New() )
+  m_timeStep(-1),
+  m_nofRepresentations(0),
+  m_evicted(false),
+  m_external(false),
+  m_savedBytes(0),
+  m_inputFilter( vtkSmartPointer<vtkPassThrough>::New() ),
+  m_surfaceFilter( vtkSmartPointer<vtkGeometryFilter>::New() ),
+  m_bounds{0.0, -1.0, 0.0, -1.0, 0.0, -1.0},
+  m_nofCells(0)
+{
+  m_surfaceFilter->SetInputConnection(m_inputFilter->GetOutputPort());
+}
+
+//------------------------------------------------------------------------------
+
+GeometryPart::~GeometryPart()
 {
+  PartCache::Remove(this);
 }
 
 //------------------------------------------------------------------------------
 
 vtkAlgorithmOutput* GeometryPart::getGeometryPort()
 {
+  ensureLoaded();
+
   return m_inputFilter->GetOutputPort();
 }
 
@@ -45,15 +212,51 @@ vtkAlgorithmOutput* GeometryPart::getGeometryPort()
 
 vtkDataSet* GeometryPart::getGeometryData()
 {
+  ensureLoaded();
+
   return vtkDataSet::SafeDownCast( m_inputFilter->GetOutput() );
 }
 
 //------------------------------------------------------------------------------
 
+vtkAlgorithmOutput* GeometryPart::getSurfacePort()
+{
+  // The surface is extracted once per part and shared by every
+  // representation, the pipeline re-executes it only when the part changes.
+  // Polydata is already a surface.
+  if( vtkPolyData::SafeDownCast(getGeometryData()) )
+  {
+    return getGeometryPort();
+  }
+
+  return m_surfaceFilter->GetOutputPort();
+}
+
+//------------------------------------------------------------------------------
+
+vtkPolyData* GeometryPart::getSurfaceData()
+{
+  if( vtkPolyData* pData = vtkPolyData::SafeDownCast(getGeometryData()) )
+  {
+    return pData;
+  }
+
+  TRACE_SCOPE("GeometryPart::getSurfaceData");
+
+  m_surfaceFilter->Update();
+
+  return m_surfaceFilter->GetOutput();
+}
+
+//------------------------------------------------------------------------------
+
 void GeometryPart::setGeometryData(vtkDataSet* data)
 {
   if( data )
   {
+    m_evicted  = false;
+    m_external = false;
+
     if( auto uGrid = vtkUnstructuredGrid::SafeDownCast(data) )
     {
       m_data = vtkSmartPointer<vtkUnstructuredGrid>::New();
@@ -67,12 +270,229 @@ void GeometryPart::setGeometryData(vtkDataSet* data)
       m_data->ShallowCopy(pData);
     }
 
+    // m_data owns its points and attributes objects, the arrays replaced
+    // are not shared with the caller
+    m_savedBytes = PrecisionConverter::ConvertToSingle(m_data, m_precision);
+
     updateData();
   }
 }
 
 //------------------------------------------------------------------------------
 
+bool GeometryPart::setExternalData(const ExternalMesh& mesh)
+{
+  TRACE_SCOPE("GeometryPart::setExternalData");
+
+  const vtkIdType nofPoints = mesh.m_points.m_nofTuples;
+  const vtkIdType nofCells  = mesh.m_nofCells;
+
+  bool valid =
+    !mesh.m_points.isEmpty() &&
+    (mesh.m_points.m_nofComponents == 3) &&
+    ((mesh.m_points.m_dataType == VTK_FLOAT) ||
+     (mesh.m_points.m_dataType == VTK_DOUBLE)) &&
+    !mesh.m_connectivity.isEmpty() &&
+    (mesh.m_connectivity.m_dataType == VTK_ID_TYPE) &&
+    (nofCells > 0);
+
+  valid = valid && (mesh.m_cellTypes.isEmpty()?
+    ((mesh.m_cellType > VTK_EMPTY_CELL) &&
+     (mesh.m_cellType < VTK_NUMBER_OF_CELL_TYPES)) :
+    ((mesh.m_cellTypes.m_dataType == VTK_UNSIGNED_CHAR) &&
+     (mesh.m_cellTypes.m_nofTuples == nofCells)));
+
+  valid = valid && (mesh.m_cellLocations.isEmpty() ||
+    ((mesh.m_cellLocations.m_dataType == VTK_ID_TYPE) &&
+     (mesh.m_cellLocations.m_nofTuples == nofCells)));
+
+  for( const auto& field : mesh.m_pointFields )
+  {
+    valid = valid && isValidField(field.second, nofPoints);
+  }
+
+  for( const auto& field : mesh.m_cellFields )
+  {
+    valid = valid && isValidField(field.second, nofCells);
+  }
+
+  // Every cell is checked before VTK walks the connectivity
+  if( valid )
+  {
+    const vtkIdType* cell =
+      static_cast<const vtkIdType*>(mesh.m_connectivity.m_data);
+    const vtkIdType size = mesh.m_connectivity.m_nofTuples;
+
+    const vtkIdType* locations = mesh.m_cellLocations.isEmpty()?
+      nullptr : static_cast<const vtkIdType*>(mesh.m_cellLocations.m_data);
+    vtkIdType location = 0;
+
+    for( vtkIdType i = 0; valid && (i < nofCells); ++i )
+    {
+      if( locations )
+      {
+        location = locations[i];
+      }
+
+      valid = isValidCell(cell, size, location, nofPoints);
+
+      location += valid? cell[location] + 1 : 0;
+    }
+  }
+
+  if( valid && !mesh.m_cellTypes.isEmpty() )
+  {
+    const unsigned char* types =
+      static_cast<const unsigned char*>(mesh.m_cellTypes.m_data);
+
+    valid = std::all_of(types, types + nofCells, [](unsigned char type)
+    {
+      return (type > VTK_EMPTY_CELL) && (type < VTK_NUMBER_OF_CELL_TYPES);
+    });
+  }
+
+  if( !valid )
+  {
+    qWarning("Inconsistent external buffers for part '%s'",
+      qPrintable(m_partName));
+    return false;
+  }
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetData(ExternalArray::Wrap(mesh.m_points));
+
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkIdTypeArray::SafeDownCast(
+    ExternalArray::Wrap(mesh.m_connectivity));
+
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  cells->SetCells(nofCells, connectivity);
+
+  // Types and locations are only allocated when the caller has none
+  vtkSmartPointer<vtkUnsignedCharArray> types;
+
+  if( mesh.m_cellTypes.isEmpty() )
+  {
+    types = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    types->SetNumberOfValues(nofCells);
+    std::fill_n(types->GetPointer(0), nofCells,
+      static_cast<unsigned char>(mesh.m_cellType));
+  }
+  else
+  {
+    types = vtkUnsignedCharArray::SafeDownCast(
+      ExternalArray::Wrap(mesh.m_cellTypes));
+  }
+
+  vtkSmartPointer<vtkIdTypeArray> locations;
+
+  if( mesh.m_cellLocations.isEmpty() )
+  {
+    locations = vtkSmartPointer<vtkIdTypeArray>::New();
+    locations->SetNumberOfValues(nofCells);
+
+    const vtkIdType* cell = connectivity->GetPointer(0);
+    vtkIdType location = 0;
+
+    for( vtkIdType i = 0; i < nofCells; ++i )
+    {
+      locations->SetValue(i, location);
+      location += cell[location] + 1;
+    }
+  }
+  else
+  {
+    locations = vtkIdTypeArray::SafeDownCast(
+      ExternalArray::Wrap(mesh.m_cellLocations));
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->SetCells(types, locations, cells);
+
+  for( const auto& field : mesh.m_pointFields )
+  {
+    vtkSmartPointer<vtkDataArray> arr = ExternalArray::Wrap(field.second);
+    arr->SetName(qPrintable(field.first));
+
+    grid->GetPointData()->AddArray(arr);
+  }
+
+  for( const auto& field : mesh.m_cellFields )
+  {
+    vtkSmartPointer<vtkDataArray> arr = ExternalArray::Wrap(field.second);
+    arr->SetName(qPrintable(field.first));
+
+    grid->GetCellData()->AddArray(arr);
+  }
+
+  m_evicted    = false;
+  m_external   = true;
+  m_savedBytes = 0;
+  m_data       = grid;
+
+  updateData();
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryPart::isExternal() const
+{
+  return m_external;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::dataChanged(bool pointsChanged, const QStringList& arrays)
+{
+  if( !m_data || m_evicted )
+  {
+    return;
+  }
+
+  TRACE_SCOPE("GeometryPart::dataChanged");
+
+  vtkPointSet* pointSet = vtkPointSet::SafeDownCast(m_data);
+
+  if( pointsChanged && pointSet && pointSet->GetPoints() )
+  {
+    pointSet->GetPoints()->GetData()->Modified();
+    pointSet->GetPoints()->Modified();
+  }
+
+  // The range cache recomputes only the arrays with a newer MTime
+  vtkDataSetAttributes* attributes[] = {
+    m_data->GetPointData(),
+    m_data->GetCellData()};
+
+  for( vtkDataSetAttributes* att : attributes )
+  {
+    for( int i = 0; i < att->GetNumberOfArrays(); ++i )
+    {
+      vtkDataArray* arr = att->GetArray(i);
+
+      if( arr && (arrays.isEmpty() ||
+          (arr->GetName() && arrays.contains(arr->GetName()))) )
+      {
+        arr->Modified();
+      }
+    }
+  }
+
+  m_data->Modified();
+
+  m_inputFilter->Update();
+
+  if( pointsChanged )
+  {
+    updateLocator();
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void GeometryPart::setGeometryConnection(vtkAlgorithmOutput* port)
 {
   if( m_data )
@@ -80,8 +500,18 @@ void GeometryPart::setGeometryConnection(vtkAlgorithmOutput* port)
     m_data = vtkSmartPointer<vtkDataSet>();
   }
 
+  TRACE_SCOPE("GeometryPart::setGeometryConnection");
+
+  m_evicted = false;
+  m_external = false;
+  m_savedBytes = 0;
+
   m_inputFilter->SetInputConnection(port);
   m_inputFilter->Update();
+
+  PartCache::Loaded(this);
+
+  updateLocator();
 }
 
 //------------------------------------------------------------------------------
@@ -90,8 +520,35 @@ void GeometryPart::updateData()
 {
   if( m_data )
   {
+    TRACE_SCOPE("GeometryPart::updateData");
+
     m_inputFilter->SetInputData(m_data);
     m_inputFilter->Update();
+
+    PartCache::Loaded(this);
+
+    updateLocator();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::updateLocator()
+{
+  // Only parts somebody probes have one, they live in the GUI thread
+  if( m_locator )
+  {
+    m_locator->update(vtkDataSet::SafeDownCast(m_inputFilter->GetOutput()));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::ensureLoaded()
+{
+  if( m_evicted )
+  {
+    load();
   }
 }
 
@@ -110,3 +567,365 @@ const QString& GeometryPart::getPartName() const
 }
 
 //------------------------------------------------------------------------------
+
+void GeometryPart::setTimeStepData(
+  int step,
+  vtkDataSet* data,
+  qint64 savedBytes)
+{
+  setGeometryData(data);
+
+  // Already converted by the reader, nothing was left to save here
+  m_savedBytes += savedBytes;
+
+  m_timeStep = step;
+}
+
+//------------------------------------------------------------------------------
+
+int GeometryPart::getTimeStep() const
+{
+  return m_timeStep;
+}
+
+//------------------------------------------------------------------------------
+
+std::vector<ArrayRange> GeometryPart::getPointDataRanges()
+{
+  if( m_evicted )
+  {
+    return m_pointRanges;
+  }
+
+  vtkDataSet* data = getGeometryData();
+
+  return m_rangeEngine.computeRanges(data? data->GetPointData() : nullptr);
+}
+
+//------------------------------------------------------------------------------
+
+std::vector<ArrayRange> GeometryPart::getCellDataRanges()
+{
+  if( m_evicted )
+  {
+    return m_cellRanges;
+  }
+
+  vtkDataSet* data = getGeometryData();
+
+  return m_rangeEngine.computeRanges(data? data->GetCellData() : nullptr);
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::getBounds(double bounds[6])
+{
+  vtkDataSet* data = m_evicted? nullptr : getGeometryData();
+
+  if( data )
+  {
+    data->GetBounds(bounds);
+  }
+  else
+  {
+    std::copy(m_bounds, m_bounds + 6, bounds);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+vtkIdType GeometryPart::getNofCells()
+{
+  vtkDataSet* data = m_evicted? nullptr : getGeometryData();
+
+  return data? data->GetNumberOfCells() : m_nofCells;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::setDataSource(const QString& fileName)
+{
+  m_dataSource = fileName;
+}
+
+//------------------------------------------------------------------------------
+
+const QString& GeometryPart::getDataSource() const
+{
+  return m_dataSource;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryPart::isLoaded() const
+{
+  return !m_evicted;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryPart::canEvict() const
+{
+  return !m_evicted &&
+    !m_dataSource.isEmpty() &&
+    (m_nofRepresentations == 0);
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::load()
+{
+  if( !m_evicted )
+  {
+    return;
+  }
+
+  TRACE_SCOPE("GeometryPart::load");
+
+  GeometryLoader::BlockInfo block;
+  block.m_name     = m_partName;
+  block.m_fileName = m_dataSource;
+
+  vtkSmartPointer<vtkDataSet> data = GeometryLoader::ReadBlock(block);
+
+  if( !data )
+  {
+    // The part stays empty, the file is not read again on every access
+    qWarning("Could not read part '%s' again from '%s'",
+      qPrintable(m_partName),
+      qPrintable(m_dataSource));
+
+    m_dataSource.clear();
+    data = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  }
+
+  setGeometryData(data);
+
+  PartCache::EnforceBudget();
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::evict()
+{
+  if( !canEvict() )
+  {
+    return;
+  }
+
+  TRACE_SCOPE("GeometryPart::evict");
+
+  vtkDataSet* data = vtkDataSet::SafeDownCast( m_inputFilter->GetOutput() );
+
+  if( data )
+  {
+    m_pointRanges = m_rangeEngine.computeRanges(data->GetPointData());
+    m_cellRanges  = m_rangeEngine.computeRanges(data->GetCellData());
+    data->GetBounds(m_bounds);
+    m_nofCells = data->GetNumberOfCells();
+  }
+
+  m_evicted = true;
+
+  // Every output of the part is released, the pipeline objects stay so the
+  // ports handed out remain valid
+  m_data = vtkSmartPointer<vtkDataSet>();
+  m_inputFilter->RemoveAllInputConnections(0);
+  m_inputFilter->GetOutputDataObject(0)->Initialize();
+  m_surfaceFilter->GetOutput()->Initialize();
+  m_rangeEngine.clear();
+  m_savedBytes = 0;
+  m_locator.reset();
+
+  PartCache::Evicted(this);
+}
+
+//------------------------------------------------------------------------------
+
+qint64 GeometryPart::getMemorySize() const
+{
+  if( m_evicted )
+  {
+    return 0;
+  }
+
+  vtkDataSet* data = vtkDataSet::SafeDownCast(m_inputFilter->GetOutput());
+
+  if( !data )
+  {
+    return 0;
+  }
+
+  // KiB
+  qint64 kiBytes = data->GetActualMemorySize();
+
+  // A polydata part is its own surface
+  vtkPolyData* surface = m_surfaceFilter->GetOutput();
+
+  if( !vtkPolyData::SafeDownCast(data) && (surface->GetNumberOfCells() > 0) )
+  {
+    kiBytes += getUnsharedSize(surface, data);
+  }
+
+  qint64 bytes = kiBytes * 1024;
+
+  for( const auto& banding : m_bandings )
+  {
+    if( auto alive = banding.lock() )
+    {
+      bytes += alive->getMemorySize();
+    }
+  }
+
+  if( auto surfaceLOD = m_surfaceLOD.lock() )
+  {
+    bytes += surfaceLOD->getMemorySize();
+  }
+
+  if( m_locator )
+  {
+    bytes += m_locator->getMemorySize();
+  }
+
+  return bytes;
+}
+
+//------------------------------------------------------------------------------
+
+const PrecisionPolicy& GeometryPart::getPrecisionPolicy() const
+{
+  return m_precision;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::setPrecisionPolicy(const PrecisionPolicy& policy)
+{
+  // The data set since was converted with it, see GeometryLoader
+  if( policy == m_precision )
+  {
+    return;
+  }
+
+  m_precision = policy;
+
+  // Connected parts are not converted, their data belongs to the upstream
+  // pipeline. Neither are external parts: the copy would drop the wrapped
+  // buffers and with them the updates made in place by their owner.
+  if( m_data && !m_evicted && !m_external && !m_precision.isNative() )
+  {
+    const qint64 savedBytes =
+      PrecisionConverter::ConvertToSingle(m_data, m_precision);
+
+    if( savedBytes > 0 )
+    {
+      m_savedBytes += savedBytes;
+
+      updateData();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+qint64 GeometryPart::getSavedBytes() const
+{
+  return m_savedBytes;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::addRepresentation()
+{
+  ++m_nofRepresentations;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPart::removeRepresentation()
+{
+  --m_nofRepresentations;
+}
+
+//------------------------------------------------------------------------------
+
+int GeometryPart::getNofRepresentations() const
+{
+  return m_nofRepresentations;
+}
+
+//------------------------------------------------------------------------------
+
+std::shared_ptr<PartBanding> GeometryPart::getBanding(
+  const QString& datasetName,
+  int association,
+  int nofBands)
+{
+  const QString key =
+    QString("%1/%2/%3").arg(association).arg(nofBands).arg(datasetName);
+
+  std::shared_ptr<PartBanding> banding = m_bandings.value(key).lock();
+
+  if( !banding )
+  {
+    banding = std::make_shared<PartBanding>(
+      getSurfacePort(),
+      datasetName,
+      association,
+      nofBands);
+
+    m_bandings.insert(key, banding);
+  }
+
+  // Forget the settings nobody shows anymore
+  for( auto it = m_bandings.begin(); it != m_bandings.end(); )
+  {
+    if( it.value().expired() )
+    {
+      it = m_bandings.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  return banding;
+}
+
+//------------------------------------------------------------------------------
+
+std::shared_ptr<LODProxySet> GeometryPart::getSurfaceLOD()
+{
+  std::shared_ptr<LODProxySet> lod = m_surfaceLOD.lock();
+
+  if( !lod )
+  {
+    lod = std::make_shared<LODProxySet>();
+    m_surfaceLOD = lod;
+  }
+
+  return lod;
+}
+
+//------------------------------------------------------------------------------
+
+std::shared_ptr<PartLocator> GeometryPart::getLocator()
+{
+  if( !m_locator )
+  {
+    m_locator = std::make_shared<PartLocator>();
+    m_locator->update(getGeometryData());
+  }
+
+  return m_locator;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryPart::hasLocator() const
+{
+  return m_locator != nullptr;
+}
+
+//------------------------------------------------------------------------------
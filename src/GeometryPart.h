@@ -22,34 +22,140 @@
 #ifndef GEOMETRYPART_H
 #define GEOMETRYPART_H
 
+#include "ArrayRangeEngine.h"
+#include "PrecisionConverter.h"
+
+#include <QHash>
 #include <QString>
+#include <QStringList>
 
 #include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <memory>
+#include <vector>
 
 class vtkAlgorithmOutput;
-class vtkPassThrough;
 class vtkDataSet;
+class vtkGeometryFilter;
+class vtkPassThrough;
+class vtkPolyData;
+
+class LODProxySet;
+class PartBanding;
+class PartLocator;
+struct ExternalMesh;
 
 class GeometryPart
 {
 public:
   GeometryPart();
+  ~GeometryPart();
 
   vtkAlgorithmOutput* getGeometryPort();
   vtkDataSet* getGeometryData();
 
+  vtkAlgorithmOutput* getSurfacePort();
+  vtkPolyData* getSurfaceData();
+
   void setPartName(const QString& name);
   void setGeometryData(vtkDataSet*);
   void setGeometryConnection(vtkAlgorithmOutput*);
 
   const QString& getPartName() const;
 
+  // Wraps the caller buffers without copying them, the data is not converted
+  // by the precision policy. Returns false if the buffers are inconsistent,
+  // then nothing is wrapped, no deleter is ever called and the buffers stay
+  // owned by the caller. Ownership only transfers on success.
+  bool setExternalData(const ExternalMesh& mesh);
+  bool isExternal() const;
+
+  // The values of the external buffers (or of any array set) have changed in
+  // place, an empty list is every array
+  void dataChanged(bool pointsChanged, const QStringList& arrays);
+
+  // Replaces the data by the one of a time step of a transient geometry,
+  // savedBytes by the precision policy when the reader converted it
+  void setTimeStepData(int step, vtkDataSet* data, qint64 savedBytes = 0);
+  int getTimeStep() const;
+
+  std::vector<ArrayRange> getPointDataRanges();
+  std::vector<ArrayRange> getCellDataRanges();
+  void getBounds(double bounds[6]);
+  vtkIdType getNofCells();
+
+  // Out-of-core parts (see PartCache): a part with a data source may drop
+  // its data, only the ranges, bounds and number of cells stay. The data is
+  // read again by the first accessor of the ports or data above. GUI thread
+  // only.
+  void setDataSource(const QString& fileName);
+  const QString& getDataSource() const;
+  bool isLoaded() const;
+  bool canEvict() const;
+  void load();
+  void evict();
+
+  // Bytes of the part data and of everything derived from it: the surface,
+  // the bandings, the level of detail proxies and the locator. 0 when evicted
+  qint64 getMemorySize() const;
+
+  // Applied to the current data and to every data set afterwards, data
+  // already converted to single precision stays single. Set before the data
+  // in background readers, so publishing the part in the GUI thread with the
+  // same policy converts nothing.
+  const PrecisionPolicy& getPrecisionPolicy() const;
+  void setPrecisionPolicy(const PrecisionPolicy& policy);
+
+  // Bytes saved by the precision policy on the current data
+  qint64 getSavedBytes() const;
+
+  // Evictable parts are the ones no representation shows
+  void addRepresentation();
+  void removeRepresentation();
+  int getNofRepresentations() const;
+
+  // Display data shared by every representation of the part (in any plot),
+  // it lives as long as one of them uses it. GUI thread only.
+  std::shared_ptr<PartBanding> getBanding(
+    const QString& datasetName,
+    int association,
+    int nofBands);
+  std::shared_ptr<LODProxySet> getSurfaceLOD();
+
+  // Cell locator for probing, created and built in background by the first
+  // call and rebuilt whenever the geometry of the part changes. Dropped when
+  // the part is evicted. GUI thread only.
+  std::shared_ptr<PartLocator> getLocator();
+  bool hasLocator() const;
+
 protected:
   void updateData();
+  void updateLocator();
+  void ensureLoaded();
 
   QString m_partName;
+  QString m_dataSource;
+  int     m_timeStep;
+  int     m_nofRepresentations;
+  bool    m_evicted;
+  bool    m_external;
+  PrecisionPolicy m_precision;
+  qint64          m_savedBytes;
+  ArrayRangeEngine m_rangeEngine;
   vtkSmartPointer<vtkDataSet>     m_data;
   vtkSmartPointer<vtkPassThrough> m_inputFilter;
+  vtkSmartPointer<vtkGeometryFilter> m_surfaceFilter;
+
+  // Kept while evicted
+  std::vector<ArrayRange> m_pointRanges;
+  std::vector<ArrayRange> m_cellRanges;
+  double                  m_bounds[6];
+  vtkIdType               m_nofCells;
+
+  QHash<QString, std::weak_ptr<PartBanding>> m_bandings;
+  std::weak_ptr<LODProxySet>                 m_surfaceLOD;
+  std::shared_ptr<PartLocator>               m_locator;
 };
 
 #endif // GEOMETRYPART_H
@@ -23,17 +23,42 @@
 #include "GeometryPartRepresentation.h"
 
 #include "GeometryPart.h"
+#include "LODProxySet.h"
+#include "PartBatch.h"
 #include "MyVTKApplication.h"
+#include "PartBanding.h"
+#include "RedrawScheduler.h"
+#include "Tracer.h"
 
+#include <vtkAlgorithm.h>
+#include <vtkAlgorithmOutput.h>
 #include <vtkAssignAttribute.h>
-#include <vtkBandedPolyDataContourFilter.h>
 #include <vtkCellData.h>
-#include <vtkGeometryFilter.h>
+#include <vtkDataSet.h>
 #include <vtkPointData.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
-#include <vtkUnstructuredGrid.h>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+// Output of the port without executing its pipeline
+vtkPolyData* portData(vtkAlgorithmOutput* port)
+{
+  if( !port || !port->GetProducer() )
+  {
+    return nullptr;
+  }
+
+  return vtkPolyData::SafeDownCast(
+    port->GetProducer()->GetOutputDataObject(port->GetIndex()));
+}
+
+}
 
 //------------------------------------------------------------------------------
 
@@ -52,11 +77,47 @@ GeometryPartRepresentation::GeometryPartRepresentation(
   m_showSolid(true),
   m_showDataset(false),
   m_showDatasetLines(false),
-  m_modified(false),
+  m_validDataset(false),
+  m_culled(false),
+  m_changes(0),
+  m_bandsRange{0.0, 0.0},
+  m_solidMapper(vtkSmartPointer<vtkPolyDataMapper>::New()),
+  m_datasetMapper(vtkSmartPointer<vtkPolyDataMapper>::New()),
+  m_datasetLinesMapper(vtkSmartPointer<vtkPolyDataMapper>::New()),
+  m_lodFraction(1.0),
   m_solidActor(vtkSmartPointer<vtkActor>::New()),
   m_datasetActor(vtkSmartPointer<vtkActor>::New()),
-  m_datasetLinesActor(vtkSmartPointer<vtkActor>::New())
+  m_datasetLinesActor(vtkSmartPointer<vtkActor>::New()),
+  m_batch(nullptr),
+  m_batchPart(-1)
 {
+  // The pipeline is built once, property changes only touch the stage they
+  // affect and VTK re-executes what is downstream of it on the next render.
+  // Everything up to the mappers belongs to the part and is shared with the
+  // representations of the same part in other plots.
+  //
+  //   part surface --> solid mapper
+  //                \-> part banding --> dataset mapper
+  //                                 \-> dataset lines mapper
+  if( auto validPart = m_geomPart.lock() )
+  {
+    // Shown parts stay resident, the port reads an evicted part again
+    validPart->addRepresentation();
+
+    m_solidMapper->SetInputConnection(validPart->getSurfacePort());
+
+    m_solidLOD = validPart->getSurfaceLOD();
+
+    connect(m_solidLOD.get(), SIGNAL(ready()), this, SLOT(applyLOD()));
+  }
+
+  m_datasetMapper->SetScalarModeToUseCellData();
+  m_datasetLinesMapper->ScalarVisibilityOff();
+
+  m_solidActor->SetMapper(m_solidMapper);
+  m_datasetActor->SetMapper(m_datasetMapper);
+  m_datasetLinesActor->SetMapper(m_datasetLinesMapper);
+
   m_solidActor->VisibilityOff();
   m_datasetActor->VisibilityOff();
   m_datasetLinesActor->VisibilityOff();
@@ -68,180 +129,204 @@ GeometryPartRepresentation::GeometryPartRepresentation(
     m_renderer->AddActor(m_datasetLinesActor);
   }
 
+  m_datasetLinesActor->GetProperty()->SetColor(
+    m_contoursColor.redF(),
+    m_contoursColor.greenF(),
+    m_contoursColor.blueF());
+
   updateSolidPartActor();
 }
 
 //------------------------------------------------------------------------------
 
-void GeometryPartRepresentation::updateSolidPartActor()
+GeometryPartRepresentation::~GeometryPartRepresentation()
 {
-  if( m_geomPart.expired() )
+  if( m_scheduler )
   {
-    return;
+    m_scheduler->unschedule(this);
   }
 
-  m_datasetActor->VisibilityOff();
+  if( auto validPart = m_geomPart.lock() )
+  {
+    validPart->removeRepresentation();
+  }
 
-  vtkSmartPointer<vtkGeometryFilter> gFilter =
-    vtkSmartPointer<vtkGeometryFilter>::New();
+  if( m_batch )
+  {
+    m_batch->removePart(m_batchPart);
+  }
+
+  if( m_renderer )
+  {
+    m_renderer->RemoveActor(m_solidActor);
+    m_renderer->RemoveActor(m_datasetActor);
+    m_renderer->RemoveActor(m_datasetLinesActor);
+  }
+}
 
-  gFilter->SetInputConnection(m_geomPart.lock()->getGeometryPort());
+//------------------------------------------------------------------------------
 
-  vtkSmartPointer<vtkPolyDataMapper> mapper =
-    vtkSmartPointer<vtkPolyDataMapper>::New();
+void GeometryPartRepresentation::updateSolidPartActor()
+{
+  TRACE_SCOPE("GeometryPartRepresentation::updateSolidPartActor");
 
-  mapper->SetInputConnection(gFilter->GetOutputPort());
+  if( m_geomPart.expired() )
+  {
+    return;
+  }
 
-  m_solidActor->SetMapper(mapper);
   m_solidActor->GetProperty()->SetColor(
     m_solidColor.redF(),
     m_solidColor.greenF(),
     m_solidColor.blueF() );
 
-  m_solidActor->VisibilityOn();
-
-  m_oldVisibility[0] = true;
-  m_oldVisibility[1] = false;
-  m_oldVisibility[2] = false;
+  updateVisibility();
 }
 
 //------------------------------------------------------------------------------
 
 void GeometryPartRepresentation::updateDatasetPartActor()
 {
+  TRACE_SCOPE("GeometryPartRepresentation::updateDatasetPartActor");
+
   if( m_geomPart.expired() )
   {
     return;
   }
 
-  auto validPart = m_geomPart.lock();
+  updateDatasetAssignment();
+  updateBands();
 
-  if( m_showDataset )
-  {
-    vtkSmartPointer<vtkGeometryFilter> gFilter;
+  m_datasetLinesActor->GetProperty()->SetColor(
+    m_contoursColor.redF(),
+    m_contoursColor.greenF(),
+    m_contoursColor.blueF());
 
-    if( vtkUnstructuredGrid::SafeDownCast(validPart->getGeometryData()) )
-    {
-      gFilter =
-        vtkSmartPointer<vtkGeometryFilter>::New();
+  updateVisibility();
 
-      gFilter->SetInputConnection(validPart->getGeometryPort());
-    }
+//  m_datasetActor->GetProperty()->EdgeVisibilityOn();
+//  m_datasetActor->GetProperty()->SetEdgeColor(0.0, 0.0, 0.0);
 
+}
 
-    vtkSmartPointer<vtkAssignAttribute> assigner =
-      vtkSmartPointer<vtkAssignAttribute>::New();
+//------------------------------------------------------------------------------
 
-    if( validPart->getGeometryData()->GetPointData()
-      ->HasArray(qPrintable(m_datasetInfo.first)) )
-    {
-      if( gFilter )
-      {
-        assigner->SetInputConnection(gFilter->GetOutputPort());
-      }
-      else
-      {
-        assigner->SetInputConnection(validPart->getGeometryPort());
-      }
-
-      assigner->Assign(
-        qPrintable(m_datasetInfo.first),
-        vtkDataSetAttributes::SCALARS,
-        vtkAssignAttribute::POINT_DATA);
-    }
-    else if( validPart->getGeometryData()->GetCellData()
-      ->HasArray(qPrintable(m_datasetInfo.first)) )
-    {
-      if( gFilter )
-      {
-        assigner->SetInputConnection(gFilter->GetOutputPort());
-      }
-      else
-      {
-        assigner->SetInputConnection(validPart->getGeometryPort());
-      }
-
-      assigner->Assign(
-        qPrintable(m_datasetInfo.first),
-        vtkDataSetAttributes::SCALARS,
-        vtkAssignAttribute::CELL_DATA);
-    }
-    else
-    {
-      updateSolidPartActor();
-    }
+bool GeometryPartRepresentation::updateDatasetAssignment()
+{
+  auto validPart = m_geomPart.lock();
 
+  m_validDataset = false;
 
-    vtkSmartPointer<vtkBandedPolyDataContourFilter> contours =
-      vtkSmartPointer<vtkBandedPolyDataContourFilter>::New();
+  if( !validPart || !m_datasetInfo.isValid() )
+  {
+    setBanding(nullptr);
+    return false;
+  }
 
-    contours->SetInputConnection( assigner->GetOutputPort() );
-    contours->GenerateValues(
-      m_nofBands,
-      m_datasetInfo.second[0],
-      m_datasetInfo.second[1]);
-    contours->ClippingOff();
-    contours->SetClipTolerance(0.0);
-    contours->SetScalarModeToValue();
-    contours->GenerateContourEdgesOn();
+  const bool pointData =
+    (m_datasetInfo.getAssociation() == DatasetRegistry::POINT_DATA);
 
-    vtkSmartPointer<vtkPolyDataMapper> mapper =
-      vtkSmartPointer<vtkPolyDataMapper>::New();
+  vtkDataSetAttributes* att = pointData?
+    static_cast<vtkDataSetAttributes*>(
+      validPart->getGeometryData()->GetPointData()) :
+    static_cast<vtkDataSetAttributes*>(
+      validPart->getGeometryData()->GetCellData());
 
-    mapper->SetInputConnection(contours->GetOutputPort());
-    mapper->SetScalarRange(m_datasetInfo.second[0], m_datasetInfo.second[1]);
-    mapper->SetScalarModeToUseCellData();
+  if( !att->HasArray(m_datasetInfo.getKey()) )
+  {
+    setBanding(nullptr);
+    return false;
+  }
 
-    m_datasetActor->SetMapper(mapper);
+  const int association = pointData?
+    vtkAssignAttribute::POINT_DATA : vtkAssignAttribute::CELL_DATA;
 
-    if( m_showDatasetLines )
-    {
-      vtkSmartPointer<vtkPolyDataMapper> mapper2 =
-        vtkSmartPointer<vtkPolyDataMapper>::New();
+  setBanding(validPart->getBanding(
+    m_datasetInfo.getName(),
+    association,
+    m_nofBands));
 
-      mapper2->SetInputData(contours->GetContourEdgesOutput());
+  m_validDataset = true;
+  return true;
+}
 
-      m_datasetLinesActor->SetMapper(mapper2);
-      m_datasetLinesActor->GetProperty()->SetColor(
-        m_contoursColor.redF(),
-        m_contoursColor.greenF(),
-        m_contoursColor.blueF());
+//------------------------------------------------------------------------------
 
-      m_datasetLinesActor->VisibilityOn();
-      m_oldVisibility[2] = true;
-    }
-    else
-    {
-      m_datasetLinesActor->VisibilityOff();
-      m_oldVisibility[2] = false;
-    }
+void GeometryPartRepresentation::setBanding(
+  std::shared_ptr<PartBanding> banding)
+{
+  if( m_banding == banding )
+  {
+    return;
+  }
+
+  if( m_banding )
+  {
+    disconnect(m_banding->getLOD(), SIGNAL(ready()), this, SLOT(applyLOD()));
+  }
+
+  m_banding = banding;
+  m_datasetLODMappers.clear();
 
-    m_solidActor->VisibilityOff();
-    m_datasetActor->VisibilityOn();
+  if( m_banding )
+  {
+    m_datasetMapper->SetInputConnection(m_banding->getBandsPort());
+    m_datasetLinesMapper->SetInputConnection(m_banding->getEdgesPort());
 
-    m_oldVisibility[0] = false;
-    m_oldVisibility[1] = true;
+    connect(m_banding->getLOD(), SIGNAL(ready()), this, SLOT(applyLOD()));
   }
   else
   {
-    m_datasetActor->VisibilityOff();
-    m_datasetLinesActor->VisibilityOff();
+    m_datasetMapper->RemoveAllInputConnections(0);
+    m_datasetLinesMapper->RemoveAllInputConnections(0);
+  }
+}
 
-    m_oldVisibility[1] = false;
-    m_oldVisibility[2] = false;
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::updateBands()
+{
+  if( !m_validDataset || !m_banding )
+  {
+    return;
   }
 
+  const double* range = m_datasetInfo.getRange();
 
+  m_banding->setRange(range);
 
-//  m_datasetActor->GetProperty()->EdgeVisibilityOn();
-//  m_datasetActor->GetProperty()->SetEdgeColor(0.0, 0.0, 0.0);
+  m_bandsRange[0] = range[0];
+  m_bandsRange[1] = range[1];
 
+  m_datasetMapper->SetScalarRange(range[0], range[1]);
 }
 
 //------------------------------------------------------------------------------
 
+void GeometryPartRepresentation::updateVisibility()
+{
+  const bool showDataset = m_showDataset && m_validDataset;
+  const bool showSolid   = m_showSolid || !showDataset;
+  const bool showLines   = showDataset && m_showDatasetLines;
+
+  m_solidActor->SetVisibility(showSolid && !m_culled);
+  m_datasetActor->SetVisibility(showDataset && !m_culled);
+  m_datasetLinesActor->SetVisibility(showLines && !m_culled);
 
-const QPair<QString, double*>& GeometryPartRepresentation::getDatasetInfo() const
+  m_oldVisibility[0] = showSolid;
+  m_oldVisibility[1] = showDataset;
+  m_oldVisibility[2] = showLines;
+
+  if( m_batch )
+  {
+    updateBatch();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+
+const DatasetHandle& GeometryPartRepresentation::getDatasetInfo() const
 {
   return m_datasetInfo;
 }
@@ -291,15 +376,13 @@ bool GeometryPartRepresentation::isShowDatasetLines() const
 
 //------------------------------------------------------------------------------
 
-void GeometryPartRepresentation::setDatasetInfo(
-  const QPair<QString, double*>& info)
+void GeometryPartRepresentation::setDatasetInfo(const DatasetHandle& info)
 {
   if( m_datasetInfo != info )
   {
     m_datasetInfo = info;
-    m_modified = true;
 
-    qApp->postEvent(this, new QEvent(RedrawEvent));
+    markModified(DATASET_CHANGED | VISIBILITY_CHANGED);
   }
 }
 
@@ -310,9 +393,8 @@ void GeometryPartRepresentation::setNofBands(int nofBands)
   if( m_nofBands != nofBands )
   {
     m_nofBands = nofBands;
-    m_modified = true;
 
-    qApp->postEvent(this, new QEvent(RedrawEvent));
+    markModified(BANDS_CHANGED);
   }
 }
 
@@ -323,9 +405,8 @@ void GeometryPartRepresentation::setSolidColor(const QColor& color)
   if( m_solidColor != color )
   {
     m_solidColor = color;
-    m_modified = true;
 
-    qApp->postEvent(this, new QEvent(RedrawEvent));
+    markModified(SOLID_COLOR_CHANGED);
   }
 }
 
@@ -336,9 +417,8 @@ void GeometryPartRepresentation::setContoursColor(const QColor& color)
   if( m_contoursColor != color )
   {
     m_contoursColor = color;
-    m_modified = true;
 
-    qApp->postEvent(this, new QEvent(RedrawEvent));
+    markModified(CONTOURS_COLOR_CHANGED);
   }
 }
 
@@ -348,9 +428,8 @@ void GeometryPartRepresentation::setShowSolid(bool on)
 {
   m_showSolid = on;
   m_showDataset = !on;
-  m_modified = true;
 
-  qApp->postEvent(this, new QEvent(RedrawEvent));
+  markModified(VISIBILITY_CHANGED);
 }
 
 //------------------------------------------------------------------------------
@@ -359,9 +438,8 @@ void GeometryPartRepresentation::setShowDataset(bool on)
 {
   m_showDataset = on;
   m_showSolid = !on;
-  m_modified = true;
 
-  qApp->postEvent(this, new QEvent(RedrawEvent));
+  markModified(VISIBILITY_CHANGED);
 }
 
 //------------------------------------------------------------------------------
@@ -369,31 +447,419 @@ void GeometryPartRepresentation::setShowDataset(bool on)
 void GeometryPartRepresentation::setShowDatasetLines(bool on)
 {
   m_showDatasetLines = on;
-  m_modified = true;
 
-  qApp->postEvent(this, new QEvent(RedrawEvent));
+  markModified(VISIBILITY_CHANGED);
 }
 
 //------------------------------------------------------------------------------
 
 void GeometryPartRepresentation::customEvent(QEvent* ev)
 {
-  if( (ev->type() == RedrawEvent) && m_modified )
+  TRACE_SCOPE("GeometryPartRepresentation::customEvent");
+
+  if( (ev->type() == RedrawEvent) && m_changes )
+  {
+    applyChanges();
+    updatePipeline();
+    updateLODProxies();
+  }
+
+  QObject::customEvent(ev);
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::markModified(unsigned int changes)
+{
+  const bool firstChange = (m_changes == 0);
+
+  m_changes |= changes;
+
+  if( m_scheduler )
+  {
+    m_scheduler->schedule(this);
+  }
+  else if( firstChange )
+  {
+    // A pending RedrawEvent already applies everything marked until then
+    qApp->postEvent(this, new QEvent(RedrawEvent));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::setRedrawScheduler(RedrawScheduler* scheduler)
+{
+  if( m_scheduler == scheduler )
+  {
+    return;
+  }
+
+  if( m_scheduler )
+  {
+    m_scheduler->unschedule(this);
+  }
+
+  m_scheduler = scheduler;
+
+  if( m_scheduler && m_changes )
+  {
+    m_scheduler->schedule(this);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryPartRepresentation::hasPendingChanges() const
+{
+  return m_changes != 0;
+}
+
+//------------------------------------------------------------------------------
+
+std::weak_ptr<GeometryPart> GeometryPartRepresentation::getGeometryPart() const
+{
+  return m_geomPart;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::geometryChanged()
+{
+  markModified(GEOMETRY_CHANGED);
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::updatePipeline()
+{
+  TRACE_SCOPE("GeometryPartRepresentation::updatePipeline");
+
+  // Only runs VTK filters, no actor or render window is touched, so it may be
+  // called from a worker thread as long as no other thread updates a
+  // representation of the same part.
+  if( m_datasetActor->GetVisibility() && m_banding )
+  {
+    m_banding->update();
+  }
+  else if( m_solidActor->GetVisibility() )
+  {
+    if( auto validPart = m_geomPart.lock() )
+    {
+      validPart->getSurfaceData();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::applyChanges()
+{
+  TRACE_SCOPE("GeometryPartRepresentation::applyChanges");
+
+  const unsigned int changes = m_changes;
+  m_changes = 0;
+
+  if( m_geomPart.expired() )
+  {
+    return;
+  }
+
+  if( changes & SOLID_COLOR_CHANGED )
+  {
+    m_solidActor->GetProperty()->SetColor(
+      m_solidColor.redF(),
+      m_solidColor.greenF(),
+      m_solidColor.blueF() );
+  }
+
+  if( changes & CONTOURS_COLOR_CHANGED )
+  {
+    m_datasetLinesActor->GetProperty()->SetColor(
+      m_contoursColor.redF(),
+      m_contoursColor.greenF(),
+      m_contoursColor.blueF());
+  }
+
+  // The bands are shared per dataset and number of bands. New data may not
+  // have the dataset anymore.
+  if( changes & (DATASET_CHANGED | BANDS_CHANGED | GEOMETRY_CHANGED) )
+  {
+    updateDatasetAssignment();
+  }
+
+  // The registry range may also have grown since the last update
+  if( changes & (DATASET_CHANGED | BANDS_CHANGED | VISIBILITY_CHANGED |
+                 GEOMETRY_CHANGED) )
+  {
+    updateBands();
+  }
+
+  if( changes & (DATASET_CHANGED | VISIBILITY_CHANGED | GEOMETRY_CHANGED) )
+  {
+    updateVisibility();
+  }
+
+  applyLOD();
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryPartRepresentation::isCulled() const
+{
+  return m_culled;
+}
+
+//------------------------------------------------------------------------------
+
+bool GeometryPartRepresentation::isShown() const
+{
+  return (m_oldVisibility[0] || m_oldVisibility[1]) && !m_culled;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::setCulled(bool culled)
+{
+  if( m_culled == culled )
+  {
+    return;
+  }
+
+  m_culled = culled;
+
+  m_solidActor->SetVisibility(m_oldVisibility[0] && !m_culled);
+  m_datasetActor->SetVisibility(m_oldVisibility[1] && !m_culled);
+
+  // The composite mappers do not execute the part pipelines, a part coming
+  // into view needs its data as its own mappers would have on render
+  if( m_batch && !m_culled )
+  {
+    updatePipeline();
+  }
+
+  // The contour edges also depend on the level of detail
+  applyLOD();
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::updateLODProxies()
+{
+  TRACE_SCOPE("GeometryPartRepresentation::updateLODProxies");
+
+  auto validPart = m_geomPart.lock();
+
+  // Only parts of at most PartBatch::GetMaxPartCells() cells are batched,
+  // they are always drawn at full resolution
+  if( !validPart || m_batch )
+  {
+    return;
+  }
+
+  if( m_solidActor->GetVisibility() && m_solidLOD )
+  {
+    m_solidLOD->update(validPart->getSurfaceData());
+  }
+
+  if( m_datasetActor->GetVisibility() && m_banding )
+  {
+    m_banding->getLOD()->update(m_banding->getBandsData());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+double GeometryPartRepresentation::getLODFraction() const
+{
+  return m_lodFraction;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::setLODFraction(double fraction)
+{
+  if( m_lodFraction != fraction )
+  {
+    m_lodFraction = fraction;
+
+    applyLOD();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::applyLOD()
+{
+  if( m_batch )
   {
-    m_modified = false;
+    updateBatch();
+    return;
+  }
+
+  vtkPolyDataMapper* solidMapper = m_solidMapper.Get();
 
-    if( m_showSolid )
+  if( m_solidLOD )
+  {
+    const int level = m_solidLOD->selectLevel(m_lodFraction);
+
+    if( level >= 0 )
     {
-      updateSolidPartActor();
+      solidMapper = getLODMapper(m_solidLOD.get(), level, m_solidLODMappers);
     }
-    else if( m_showDataset )
+  }
+
+  if( m_solidActor->GetMapper() != solidMapper )
+  {
+    m_solidActor->SetMapper(solidMapper);
+  }
+
+  vtkPolyDataMapper* datasetMapper = m_datasetMapper.Get();
+  int datasetLevel = -1;
+
+  if( m_banding )
+  {
+    datasetLevel = m_banding->getLOD()->selectLevel(m_lodFraction);
+
+    if( datasetLevel >= 0 )
     {
-      updateDatasetPartActor();
+      datasetMapper = getLODMapper(
+        m_banding->getLOD(),
+        datasetLevel,
+        m_datasetLODMappers);
+
+      datasetMapper->SetScalarModeToUseCellData();
+      datasetMapper->SetScalarRange(m_bandsRange);
     }
   }
 
-  QObject::customEvent(ev);
+  if( m_datasetActor->GetMapper() != datasetMapper )
+  {
+    m_datasetActor->SetMapper(datasetMapper);
+  }
+
+  // The contour edges have no proxy, they are left out while moving
+  m_datasetLinesActor->SetVisibility(
+    m_oldVisibility[2] && !m_culled && (datasetLevel < 0));
+}
+
+//------------------------------------------------------------------------------
+
+vtkPolyDataMapper* GeometryPartRepresentation::getLODMapper(
+  LODProxySet* lod,
+  int level,
+  std::vector<vtkSmartPointer<vtkPolyDataMapper>>& mappers)
+{
+  // The proxies are shared, the mappers (and so the GPU buffers) belong to
+  // the render window of this representation
+  mappers.resize(lod->getNofLevels());
+
+  vtkSmartPointer<vtkPolyDataMapper>& mapper = mappers[level];
+
+  if( !mapper )
+  {
+    mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+  }
+
+  if( mapper->GetInput() != lod->getProxy(level) )
+  {
+    mapper->SetInputData(lod->getProxy(level));
+  }
+
+  return mapper;
+}
+
+//------------------------------------------------------------------------------
+
+PartBatch* GeometryPartRepresentation::getBatch() const
+{
+  return m_batch;
+}
+
+//------------------------------------------------------------------------------
+
+void GeometryPartRepresentation::setBatch(PartBatch* batch, int part)
+{
+  if( m_batch == batch )
+  {
+    return;
+  }
+
+  if( m_batch )
+  {
+    m_batch->removePart(m_batchPart);
+  }
+
+  m_batch     = batch;
+  m_batchPart = part;
+
+  if( m_renderer )
+  {
+    if( m_batch )
+    {
+      m_renderer->RemoveActor(m_solidActor);
+      m_renderer->RemoveActor(m_datasetActor);
+      m_renderer->RemoveActor(m_datasetLinesActor);
+    }
+    else
+    {
+      m_renderer->AddActor(m_solidActor);
+      m_renderer->AddActor(m_datasetActor);
+      m_renderer->AddActor(m_datasetLinesActor);
+    }
+  }
+
+  if( m_batch )
+  {
+    updateBatch();
+    updatePipeline();
+  }
+  else
+  {
+    applyLOD();
+  }
 }
 
 //------------------------------------------------------------------------------
 
+void GeometryPartRepresentation::updateBatch()
+{
+  auto validPart = m_geomPart.lock();
+
+  if( !validPart )
+  {
+    return;
+  }
+
+  // The blocks are the outputs of the part pipelines, filled by
+  // updatePipeline(). The batch ignores what did not change.
+  m_batch->setBlockData(
+    m_batchPart, PartBatch::SOLID,
+    portData(validPart->getSurfacePort()));
+
+  m_batch->setBlockData(
+    m_batchPart, PartBatch::DATASET,
+    m_banding? portData(m_banding->getBandsPort()) : nullptr);
+
+  m_batch->setBlockData(
+    m_batchPart, PartBatch::DATASET_LINES,
+    m_banding? portData(m_banding->getEdgesPort()) : nullptr);
+
+  m_batch->setBlockColor(m_batchPart, PartBatch::SOLID, m_solidColor);
+  m_batch->setBlockColor(
+    m_batchPart, PartBatch::DATASET_LINES, m_contoursColor);
+
+  m_batch->setBlockVisibility(
+    m_batchPart, PartBatch::SOLID, m_oldVisibility[0] && !m_culled);
+  m_batch->setBlockVisibility(
+    m_batchPart, PartBatch::DATASET, m_oldVisibility[1] && !m_culled);
+  m_batch->setBlockVisibility(
+    m_batchPart, PartBatch::DATASET_LINES, m_oldVisibility[2] && !m_culled);
+
+  if( m_validDataset )
+  {
+    m_batch->setScalarRange(m_bandsRange);
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -23,22 +23,30 @@
 #ifndef GEOMETRYPARTREPRESENTATION_H
 #define GEOMETRYPARTREPRESENTATION_H
 
+#include "DatasetRegistry.h"
+
 #include <QColor>
 #include <QEvent>
 #include <QList>
 #include <QObject>
-#include <QPair>
+#include <QPointer>
 #include <QString>
 
 #include <vtkSmartPointer.h>
 #include <vtkWeakPointer.h>
 
 #include <memory>
+#include <vector>
 
 class vtkActor;
+class vtkPolyDataMapper;
 class vtkRenderer;
 
 class GeometryPart;
+class LODProxySet;
+class PartBatch;
+class PartBanding;
+class RedrawScheduler;
 
 class GeometryPartRepresentation : public QObject
 {
@@ -57,11 +65,32 @@ public:
     std::weak_ptr<GeometryPart> geomPart,
     vtkWeakPointer<vtkRenderer> ren,
     QObject* parent = 0 );
+  virtual ~GeometryPartRepresentation();
 
   void updateSolidPartActor();
   void updateDatasetPartActor();
 
-  const QPair<QString, double*>& getDatasetInfo() const;
+  // With a scheduler, changes are collected and applied once per frame by the
+  // scheduler, otherwise every change posts a RedrawEvent to this object.
+  void setRedrawScheduler(RedrawScheduler* scheduler);
+
+  bool hasPendingChanges() const;
+  void applyChanges();
+  void updatePipeline();
+
+  std::weak_ptr<GeometryPart> getGeometryPart() const;
+
+  // The data of the part has been replaced, e.g. by another time step
+  void geometryChanged();
+
+  // Level of detail: with a fraction below 1 the actors draw the finest
+  // proxy with at most that fraction of the full resolution cells, once the
+  // proxies have been built in background by updateLODProxies().
+  void updateLODProxies();
+  double getLODFraction() const;
+  void setLODFraction(double fraction);
+
+  const DatasetHandle& getDatasetInfo() const;
   int getNofBands() const;
   const QColor& getSolidColor() const;
   const QColor& getContoursColor() const;
@@ -70,7 +99,7 @@ public:
   bool isShowDataset() const;
   bool isShowDatasetLines() const;
 
-  void setDatasetInfo(const QPair<QString, double*>& info);
+  void setDatasetInfo(const DatasetHandle& info);
   void setNofBands(int nofBands);
   void setSolidColor(const QColor& color);
   void setContoursColor(const QColor& color);
@@ -78,20 +107,59 @@ public:
   void setShowDataset(bool);
   void setShowDatasetLines(bool);
 
+  // Culled representations hide their actors whatever they show, the plot
+  // culls the parts outside of the view before every frame
+  bool isCulled() const;
+  void setCulled(bool culled);
+
+  // Draws its solid or its bands in the next frame, as of the last applied
+  // changes
+  bool isShown() const;
+
+  // Batched representations draw through the blocks of their part in the
+  // batch instead of their own actors. The batch belongs to the plot and
+  // outlives its representations.
+  PartBatch* getBatch() const;
+  void setBatch(PartBatch* batch, int part);
 
 signals:
 
 public slots:
 
 protected slots:
+  void applyLOD();
 
 protected:
+  enum Changes
+  {
+    SOLID_COLOR_CHANGED    = 0x01,
+    CONTOURS_COLOR_CHANGED = 0x02,
+    BANDS_CHANGED          = 0x04,
+    DATASET_CHANGED        = 0x08,
+    VISIBILITY_CHANGED     = 0x10,
+    GEOMETRY_CHANGED       = 0x20
+  };
+
   virtual void customEvent(QEvent *);
 
+  void markModified(unsigned int changes);
+
+  bool updateDatasetAssignment();
+  void setBanding(std::shared_ptr<PartBanding> banding);
+  void updateBands();
+  void updateVisibility();
+  void updateBatch();
+
+  vtkPolyDataMapper* getLODMapper(
+    LODProxySet* lod,
+    int level,
+    std::vector<vtkSmartPointer<vtkPolyDataMapper>>& mappers);
+
   vtkWeakPointer<vtkRenderer> m_renderer;
   std::weak_ptr<GeometryPart> m_geomPart;
+  QPointer<RedrawScheduler>   m_scheduler;
 
-  QPair<QString, double*> m_datasetInfo;
+  DatasetHandle m_datasetInfo;
   QColor  m_solidColor;
   QColor  m_contoursColor;
 
@@ -101,11 +169,29 @@ protected:
   bool   m_showSolid;
   bool   m_showDataset;
   bool   m_showDatasetLines;
-  bool   m_modified;
+  bool   m_validDataset;
+  bool   m_culled;
+
+  unsigned int m_changes;
+  double       m_bandsRange[2];
+
+  std::shared_ptr<PartBanding> m_banding;
+  std::shared_ptr<LODProxySet> m_solidLOD;
+
+  vtkSmartPointer<vtkPolyDataMapper> m_solidMapper;
+  vtkSmartPointer<vtkPolyDataMapper> m_datasetMapper;
+  vtkSmartPointer<vtkPolyDataMapper> m_datasetLinesMapper;
+
+  std::vector<vtkSmartPointer<vtkPolyDataMapper>> m_solidLODMappers;
+  std::vector<vtkSmartPointer<vtkPolyDataMapper>> m_datasetLODMappers;
+  double                                          m_lodFraction;
 
   vtkSmartPointer<vtkActor> m_solidActor;
   vtkSmartPointer<vtkActor> m_datasetActor;
   vtkSmartPointer<vtkActor> m_datasetLinesActor;
+
+  PartBatch* m_batch;
+  int        m_batchPart;
 };
 
 #endif // GEOMETRYPARTREPRESENTATION_H
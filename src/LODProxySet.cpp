@@ -0,0 +1,311 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "LODProxySet.h"
+
+#include "Tracer.h"
+
+#include <QtConcurrentRun>
+
+#include <vtkPolyData.h>
+#include <vtkQuadricClustering.h>
+
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+
+vtkIdType        LODProxySet::s_minNofCells = 200000;
+QList<vtkIdType> LODProxySet::s_budgets =
+  QList<vtkIdType>() << 1000000 << 250000 << 50000;
+
+//------------------------------------------------------------------------------
+
+LODProxySet::LODProxySet(QObject* parent)
+  :
+  QObject(parent),
+  m_copyCellData(false),
+  m_fullNofCells(0),
+  m_sourceTime(0),
+  m_buildTime(0),
+  m_buildNofCells(0)
+{
+  connect(&m_watcher, SIGNAL(finished()), this, SLOT(proxiesBuilt()));
+}
+
+//------------------------------------------------------------------------------
+
+LODProxySet::~LODProxySet()
+{
+  // The task only holds its own shallow copy of the source, nothing to wait
+}
+
+//------------------------------------------------------------------------------
+
+vtkIdType LODProxySet::GetMinNofCells()
+{
+  return s_minNofCells;
+}
+
+//------------------------------------------------------------------------------
+
+void LODProxySet::SetMinNofCells(vtkIdType nofCells)
+{
+  s_minNofCells = nofCells;
+}
+
+//------------------------------------------------------------------------------
+
+QList<vtkIdType> LODProxySet::GetBudgets()
+{
+  return s_budgets;
+}
+
+//------------------------------------------------------------------------------
+
+void LODProxySet::SetBudgets(const QList<vtkIdType>& budgets)
+{
+  s_budgets = budgets;
+}
+
+//------------------------------------------------------------------------------
+
+LODProxySet::Proxies LODProxySet::Build(
+  vtkSmartPointer<vtkPolyData> source,
+  const QList<vtkIdType>& budgets,
+  bool copyCellData)
+{
+  TRACE_SCOPE("LODProxySet::Build");
+
+  Proxies proxies;
+
+  vtkIdType previousNofCells = source->GetNumberOfCells();
+
+  for( vtkIdType budget : budgets )
+  {
+    // A level is only worth its memory if it halves the previous one
+    if( 2 * budget > previousNofCells )
+    {
+      continue;
+    }
+
+    // A surface crossing n^3 bins leaves roughly 2 triangles on each of the
+    // ~6n^2 occupied bins. The divisions are re-balanced to cubic bins.
+    const int divisions = std::max(2,
+      static_cast<int>(std::sqrt(static_cast<double>(budget) / 12.0)));
+
+    vtkSmartPointer<vtkQuadricClustering> clustering =
+      vtkSmartPointer<vtkQuadricClustering>::New();
+
+    clustering->SetInputData(source);
+    clustering->SetNumberOfDivisions(divisions, divisions, divisions);
+    clustering->AutoAdjustNumberOfDivisionsOn();
+    clustering->UseInputPointsOff();
+    clustering->SetCopyCellData(copyCellData? 1 : 0);
+    clustering->Update();
+
+    vtkSmartPointer<vtkPolyData> proxy = clustering->GetOutput();
+
+    if( proxy->GetNumberOfCells() == 0 )
+    {
+      break;
+    }
+
+    proxies << proxy;
+    previousNofCells = proxy->GetNumberOfCells();
+  }
+
+  return proxies;
+}
+
+//------------------------------------------------------------------------------
+
+void LODProxySet::update(vtkPolyData* source)
+{
+  if( !source || (source->GetMTime() == m_sourceTime) )
+  {
+    return;
+  }
+
+  m_sourceTime = source->GetMTime();
+
+  if( source->GetNumberOfCells() < s_minNofCells )
+  {
+    clear();
+    return;
+  }
+
+  if( m_watcher.isRunning() )
+  {
+    // Only the latest source matters, it is built when the current task ends
+    m_queuedSource = vtkSmartPointer<vtkPolyData>::New();
+    m_queuedSource->ShallowCopy(source);
+    return;
+  }
+
+  startBuild(source);
+}
+
+//------------------------------------------------------------------------------
+
+void LODProxySet::clear()
+{
+  m_proxies.clear();
+  m_nofCells.clear();
+  m_fullNofCells = 0;
+  m_queuedSource = nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+void LODProxySet::setCopyCellData(bool on)
+{
+  m_copyCellData = on;
+}
+
+//------------------------------------------------------------------------------
+
+bool LODProxySet::isReady() const
+{
+  return !m_proxies.empty();
+}
+
+//------------------------------------------------------------------------------
+
+vtkIdType LODProxySet::getFullNofCells() const
+{
+  return m_fullNofCells;
+}
+
+//------------------------------------------------------------------------------
+
+int LODProxySet::getNofLevels() const
+{
+  return static_cast<int>(m_proxies.size());
+}
+
+//------------------------------------------------------------------------------
+
+vtkIdType LODProxySet::getNofCells(int level) const
+{
+  return m_nofCells[level];
+}
+
+//------------------------------------------------------------------------------
+
+vtkPolyData* LODProxySet::getProxy(int level) const
+{
+  return m_proxies[level];
+}
+
+//------------------------------------------------------------------------------
+
+qint64 LODProxySet::getMemorySize() const
+{
+  qint64 kiBytes = 0;
+
+  for( const auto& proxy : m_proxies )
+  {
+    kiBytes += proxy? proxy->GetActualMemorySize() : 0;
+  }
+
+  return kiBytes * 1024;
+}
+
+//------------------------------------------------------------------------------
+
+int LODProxySet::selectLevel(double fraction) const
+{
+  if( fraction >= 1.0 )
+  {
+    return -1;
+  }
+
+  const double maxNofCells = fraction * m_fullNofCells;
+
+  for( size_t level = 0; level < m_nofCells.size(); ++level )
+  {
+    if( m_nofCells[level] <= maxNofCells )
+    {
+      return static_cast<int>(level);
+    }
+  }
+
+  // Nothing is small enough, the coarsest level is still the best choice
+  return m_nofCells.empty()? -1 : static_cast<int>(m_nofCells.size()) - 1;
+}
+
+//------------------------------------------------------------------------------
+
+void LODProxySet::startBuild(vtkPolyData* source)
+{
+  // The pipeline keeps producing new outputs in the GUI thread, the task
+  // works on its own shallow copy
+  vtkSmartPointer<vtkPolyData> snapshot = vtkSmartPointer<vtkPolyData>::New();
+  snapshot->ShallowCopy(source);
+
+  m_buildTime     = m_sourceTime;
+  m_buildNofCells = snapshot->GetNumberOfCells();
+
+  m_watcher.setFuture(QtConcurrent::run(
+    &LODProxySet::Build,
+    snapshot,
+    s_budgets,
+    m_copyCellData));
+}
+
+//------------------------------------------------------------------------------
+
+void LODProxySet::proxiesBuilt()
+{
+  if( m_queuedSource )
+  {
+    // The result is already outdated, build the latest source instead
+    vtkSmartPointer<vtkPolyData> source = m_queuedSource;
+    m_queuedSource = nullptr;
+
+    startBuild(source);
+    return;
+  }
+
+  // The source went below the minimum size while this was being built
+  if( m_buildTime != m_sourceTime )
+  {
+    return;
+  }
+
+  const Proxies proxies = m_watcher.result();
+
+  m_proxies.clear();
+  m_nofCells.clear();
+  m_fullNofCells = m_buildNofCells;
+
+  for( const vtkSmartPointer<vtkPolyData>& proxy : proxies )
+  {
+    m_proxies.push_back(proxy);
+    m_nofCells.push_back(proxy->GetNumberOfCells());
+  }
+
+  emit ready();
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef LODPROXYSET_H
+#define LODPROXYSET_H
+
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <vector>
+
+class vtkPolyData;
+
+// Decimated stand-ins of a polydata, used while the camera is moving. The
+// proxies are built with quadric clustering at a few triangle budgets on a
+// worker thread. A set belongs to the part, not to a plot, every plot draws
+// the same proxies with mappers of its own.
+class LODProxySet : public QObject
+{
+  Q_OBJECT
+public:
+  typedef QList<vtkSmartPointer<vtkPolyData>> Proxies;
+
+  explicit LODProxySet(QObject* parent = 0);
+  virtual ~LODProxySet();
+
+  // Sources with fewer cells than this are always drawn at full resolution
+  static vtkIdType GetMinNofCells();
+  static void SetMinNofCells(vtkIdType nofCells);
+
+  // Target number of cells of every level, from the finest to the coarsest
+  static QList<vtkIdType> GetBudgets();
+  static void SetBudgets(const QList<vtkIdType>& budgets);
+
+  static Proxies Build(
+    vtkSmartPointer<vtkPolyData> source,
+    const QList<vtkIdType>& budgets,
+    bool copyCellData);
+
+  // Rebuilds the proxies in background if the (already updated) source has
+  // changed since the last build. Must be called from the GUI thread.
+  void update(vtkPolyData* source);
+  void clear();
+
+  void setCopyCellData(bool on);
+
+  bool isReady() const;
+  vtkIdType getFullNofCells() const;
+  int getNofLevels() const;
+  vtkIdType getNofCells(int level) const;
+  vtkPolyData* getProxy(int level) const;
+
+  // Bytes of the proxies built
+  qint64 getMemorySize() const;
+
+  // Finest level drawing at most fraction * full cells, -1 for full
+  // resolution (no proxy needed or none small enough yet)
+  int selectLevel(double fraction) const;
+
+signals:
+  void ready();
+
+protected slots:
+  void proxiesBuilt();
+
+protected:
+  void startBuild(vtkPolyData* source);
+
+  QFutureWatcher<Proxies> m_watcher;
+  bool                    m_copyCellData;
+
+  std::vector<vtkSmartPointer<vtkPolyData>> m_proxies;
+  std::vector<vtkIdType>                    m_nofCells;
+  vtkIdType                                 m_fullNofCells;
+
+  // Source modification times of the last update and of the running build
+  vtkMTimeType                 m_sourceTime;
+  vtkMTimeType                 m_buildTime;
+  vtkSmartPointer<vtkPolyData> m_queuedSource;
+  vtkIdType                    m_buildNofCells;
+
+  static vtkIdType        s_minNofCells;
+  static QList<vtkIdType> s_budgets;
+};
+
+#endif // LODPROXYSET_H
@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef LIVESEGMENT_H
+#define LIVESEGMENT_H
+
+// Layout of the POSIX shared-memory segment a solver updates for
+// LiveSource, also used by the stand-in producer (producer/). Plain C++ so
+// a solver can include it as is. Offsets are from the start of the segment.
+//
+//   LiveSegmentHeader
+//   LivePartRecord  x m_nofParts
+//   ... point, connectivity, cell type and field buffers
+//
+// The producer makes m_generation odd while it writes and even again when
+// it is done. A part is remapped by the viewer only when its m_topology
+// changes, otherwise only its values are refreshed.
+//
+// Rules for the producer, the viewer reads the buffers it wraps between two
+// generations without any lock:
+// - Points and field values may be overwritten in place.
+// - A new topology (connectivity, cell types, number of points or cells) is
+//   written to buffers no part record points at, and the records are then
+//   pointed at them. Buffers of the previous topology are left as they are
+//   until the next topology change of the part, see producer/ for a layout
+//   with two banks.
+// - The segment may grow but never shrink, also across restarts of the
+//   producer: reading a page past the end of a shrunk object raises SIGBUS
+//   in the viewer.
+//
+// The viewer copies connectivity and cell types when a topology changes and
+// rejects ids outside of the points of the part.
+
+#include <cstdint>
+
+const char     LiveSegmentMagic[8] = {'Q', 'V', 'T', 'K', 'L', 'I', 'V', 'E'};
+const uint32_t LiveSegmentVersion  = 1;
+const int      LiveNameSize        = 64;
+
+struct LiveSegmentHeader
+{
+  char     m_magic[8];
+  uint32_t m_version;
+  uint32_t m_idTypeSize;          // 8, connectivity is int64
+  uint64_t m_segmentSize;
+  uint64_t m_generation;
+  uint32_t m_nofParts;
+  uint32_t m_padding;
+  double   m_time;
+};
+
+struct LivePartRecord
+{
+  char     m_name[LiveNameSize];
+  uint64_t m_topology;
+  uint64_t m_nofPoints;
+  uint64_t m_nofCells;
+  uint64_t m_pointsOffset;        // float x, y, z per point
+  uint64_t m_connectivityOffset;  // int64 number of points and ids per cell
+  uint64_t m_connectivitySize;    // int64 values
+  uint64_t m_cellTypesOffset;     // uint8 VTK cell type per cell
+  uint32_t m_nofFields;
+  uint32_t m_padding;
+  uint64_t m_fieldsOffset;        // LiveFieldRecord x m_nofFields
+};
+
+struct LiveFieldRecord
+{
+  enum Association
+  {
+    POINT_DATA = 0,
+    CELL_DATA  = 1
+  };
+
+  char     m_name[LiveNameSize];
+  uint32_t m_association;
+  uint32_t m_nofComponents;
+  uint64_t m_offset;              // float values
+};
+
+inline uint64_t LoadLiveGeneration(const LiveSegmentHeader* header)
+{
+  return __atomic_load_n(&header->m_generation, __ATOMIC_ACQUIRE);
+}
+
+inline void StoreLiveGeneration(LiveSegmentHeader* header, uint64_t generation)
+{
+  __atomic_store_n(&header->m_generation, generation, __ATOMIC_RELEASE);
+}
+
+#endif // LIVESEGMENT_H
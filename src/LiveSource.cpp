@@ -0,0 +1,503 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "LiveSource.h"
+
+#include "ExternalArray.h"
+#include "Geometry.h"
+#include "GeometryPart.h"
+#include "LiveSegment.h"
+#include "Tracer.h"
+
+#include <vtkType.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstring>
+
+//------------------------------------------------------------------------------
+
+// Read only mapping of the segment, shared by the arrays wrapping it
+class LiveSource::Mapping
+{
+public:
+  explicit Mapping(const QString& segmentName)
+    :
+    m_data(nullptr),
+    m_size(0)
+  {
+    const int fd = shm_open(segmentName.toLocal8Bit().constData(), O_RDONLY, 0);
+
+    if( fd < 0 )
+    {
+      return;
+    }
+
+    struct stat info;
+
+    if( (fstat(fd, &info) == 0) &&
+        (info.st_size >= static_cast<off_t>(sizeof(LiveSegmentHeader))) )
+    {
+      void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+      if( data != MAP_FAILED )
+      {
+        m_data = static_cast<char*>(data);
+        m_size = info.st_size;
+      }
+    }
+
+    close(fd);
+  }
+
+  ~Mapping()
+  {
+    if( m_data )
+    {
+      munmap(m_data, m_size);
+    }
+  }
+
+  bool isValid() const
+  {
+    return m_data != nullptr;
+  }
+
+  char* getData() const
+  {
+    return m_data;
+  }
+
+  quint64 getSize() const
+  {
+    return m_size;
+  }
+
+protected:
+  char*   m_data;
+  quint64 m_size;
+
+private:
+  Mapping(const Mapping&) = delete;
+  void operator=(const Mapping&) = delete;
+};
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+QString recordName(const char* name)
+{
+  return QString::fromUtf8(
+    name, static_cast<int>(qstrnlen(name, LiveNameSize)));
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+LiveSource::LiveSource(const QString& segmentName, Geometry* geometry)
+  :
+  QObject(geometry),
+  m_geometry(geometry),
+  m_segmentName(segmentName),
+  m_generation(0),
+  m_rewrapParts(false)
+{
+  // shm_open names start with a slash
+  if( !m_segmentName.startsWith('/') )
+  {
+    m_segmentName.prepend('/');
+  }
+
+  m_timer.setInterval(50);
+
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(poll()));
+}
+
+//------------------------------------------------------------------------------
+
+LiveSource::~LiveSource()
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool LiveSource::attach()
+{
+  if( !remap() )
+  {
+    qWarning("Could not map the live segment '%s'", qPrintable(m_segmentName));
+    return false;
+  }
+
+  const LiveSegmentHeader* header = getHeader();
+
+  if( (std::memcmp(header->m_magic, LiveSegmentMagic, 8) != 0) ||
+      (header->m_version != LiveSegmentVersion) ||
+      (header->m_idTypeSize != sizeof(vtkIdType)) )
+  {
+    qWarning("'%s' is not a compatible live segment",
+      qPrintable(m_segmentName));
+
+    m_mapping.reset();
+    return false;
+  }
+
+  poll();
+
+  m_timer.start();
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+int LiveSource::getPollInterval() const
+{
+  return m_timer.interval();
+}
+
+//------------------------------------------------------------------------------
+
+void LiveSource::setPollInterval(int msecs)
+{
+  m_timer.setInterval(msecs);
+}
+
+//------------------------------------------------------------------------------
+
+quint64 LiveSource::getGeneration() const
+{
+  return m_generation;
+}
+
+//------------------------------------------------------------------------------
+
+void LiveSource::poll()
+{
+  if( !m_mapping && !remap() )
+  {
+    return;
+  }
+
+  const quint64 generation = LoadLiveGeneration(getHeader());
+
+  // Odd while the producer writes
+  if( (generation & 1) || (generation == m_generation) )
+  {
+    return;
+  }
+
+  TRACE_SCOPE("LiveSource::poll");
+
+  if( (getHeader()->m_segmentSize != m_mapping->getSize()) && !remap() )
+  {
+    return;
+  }
+
+  QVector<LivePartRecord>           parts;
+  QVector<QVector<LiveFieldRecord>> fields;
+
+  // Records torn by a concurrent write are read again at the next poll
+  if( !readRecords(parts, fields) ||
+      (LoadLiveGeneration(getHeader()) != generation) )
+  {
+    return;
+  }
+
+  m_generation = generation;
+
+  QList<int> changedParts;
+
+  for( int i = 0; i < parts.size(); ++i )
+  {
+    const LivePartRecord& record = parts[i];
+
+    if( i >= m_topologies.size() )
+    {
+      std::unique_ptr<GeometryPart> part =
+        std::unique_ptr<GeometryPart>(new GeometryPart());
+
+      part->setPartName(recordName(record.m_name));
+
+      ExternalMesh mesh;
+
+      // Parts are kept in the order of the segment
+      if( !createMesh(record, fields[i], mesh) ||
+          !part->setExternalData(mesh) )
+      {
+        break;
+      }
+
+      m_topologies << record.m_topology;
+      m_geometry->addPart(std::move(part));
+      continue;
+    }
+
+    if( m_rewrapParts || (record.m_topology != m_topologies[i]) )
+    {
+      std::shared_ptr<GeometryPart> part = m_geometry->getPart(i).lock();
+      ExternalMesh mesh;
+
+      if( !part || !createMesh(record, fields[i], mesh) ||
+          !part->setExternalData(mesh) )
+      {
+        continue;
+      }
+
+      m_topologies[i] = record.m_topology;
+    }
+
+    changedParts << i;
+  }
+
+  m_rewrapParts = false;
+
+  m_geometry->partsDataChanged(changedParts);
+}
+
+//------------------------------------------------------------------------------
+
+bool LiveSource::remap()
+{
+  std::shared_ptr<Mapping> mapping = std::make_shared<Mapping>(m_segmentName);
+
+  if( !mapping->isValid() )
+  {
+    return false;
+  }
+
+  // The previous mapping lives on in the arrays still wrapping it, the
+  // parts move to the new one at the next generation
+  m_mapping     = mapping;
+  m_rewrapParts = true;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+const LiveSegmentHeader* LiveSource::getHeader() const
+{
+  return reinterpret_cast<const LiveSegmentHeader*>(m_mapping->getData());
+}
+
+//------------------------------------------------------------------------------
+
+bool LiveSource::readRecords(
+  QVector<LivePartRecord>& parts,
+  QVector<QVector<LiveFieldRecord>>& fields) const
+{
+  const LiveSegmentHeader* header = getHeader();
+  const char*              base   = m_mapping->getData();
+
+  const quint64 nofParts = header->m_nofParts;
+
+  if( !isInSegment(
+        sizeof(LiveSegmentHeader),
+        nofParts,
+        sizeof(LivePartRecord),
+        8) )
+  {
+    return false;
+  }
+
+  parts.resize(static_cast<int>(nofParts));
+  fields.resize(static_cast<int>(nofParts));
+
+  std::memcpy(
+    parts.data(),
+    base + sizeof(LiveSegmentHeader),
+    nofParts * sizeof(LivePartRecord));
+
+  for( int i = 0; i < parts.size(); ++i )
+  {
+    const LivePartRecord& part = parts[i];
+
+    const bool valid =
+      isInSegment(part.m_pointsOffset,
+        part.m_nofPoints, 3 * sizeof(float), sizeof(float)) &&
+      isInSegment(part.m_connectivityOffset,
+        part.m_connectivitySize, sizeof(vtkIdType), sizeof(vtkIdType)) &&
+      isInSegment(part.m_cellTypesOffset, part.m_nofCells, 1, 1) &&
+      isInSegment(part.m_fieldsOffset,
+        part.m_nofFields, sizeof(LiveFieldRecord), 8);
+
+    if( !valid )
+    {
+      qWarning("Invalid part %d in the live segment '%s'",
+        i, qPrintable(m_segmentName));
+      return false;
+    }
+
+    fields[i].resize(static_cast<int>(part.m_nofFields));
+
+    std::memcpy(
+      fields[i].data(),
+      base + part.m_fieldsOffset,
+      part.m_nofFields * sizeof(LiveFieldRecord));
+
+    for( const LiveFieldRecord& field : fields[i] )
+    {
+      const quint64 nofTuples =
+        (field.m_association == LiveFieldRecord::POINT_DATA)?
+          part.m_nofPoints : part.m_nofCells;
+
+      if( (field.m_nofComponents == 0) ||
+          (field.m_nofComponents > quint64(INT_MAX)) ||
+          !isInSegment(field.m_offset,
+            nofTuples,
+            quint64(field.m_nofComponents) * sizeof(float),
+            sizeof(float)) )
+      {
+        qWarning("Invalid field '%s' in the live segment '%s'",
+          qPrintable(recordName(field.m_name)),
+          qPrintable(m_segmentName));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool LiveSource::isInSegment(
+  quint64 offset,
+  quint64 count,
+  quint64 elementSize,
+  quint64 alignment) const
+{
+  // Divided rather than multiplied, the counts come from the producer and
+  // their product with the element size may wrap
+  return ((offset % alignment) == 0) &&
+    (offset <= m_mapping->getSize()) &&
+    (count <= (m_mapping->getSize() - offset) / elementSize);
+}
+
+//------------------------------------------------------------------------------
+
+bool LiveSource::createMesh(
+  const LivePartRecord& part,
+  const QVector<LiveFieldRecord>& fields,
+  ExternalMesh& mesh) const
+{
+  TRACE_SCOPE("LiveSource::createMesh");
+
+  char* base = m_mapping->getData();
+
+  // The topology is copied, so the ids checked here are the ids VTK reads
+  // even if the producer breaks the rules of LiveSegment.h
+  const quint64 size = part.m_connectivitySize;
+
+  // Freed with the last array wrapping them, or with the mesh if it is
+  // rejected
+  std::shared_ptr<vtkIdType> connectivity(
+    new vtkIdType[size], std::default_delete<vtkIdType[]>());
+  std::shared_ptr<unsigned char> cellTypes(
+    new unsigned char[part.m_nofCells],
+    std::default_delete<unsigned char[]>());
+
+  std::memcpy(connectivity.get(), base + part.m_connectivityOffset,
+    size * sizeof(vtkIdType));
+  std::memcpy(cellTypes.get(), base + part.m_cellTypesOffset,
+    part.m_nofCells);
+
+  const vtkIdType nofPoints = static_cast<vtkIdType>(part.m_nofPoints);
+  quint64 location = 0;
+
+  for( quint64 c = 0; c < part.m_nofCells; ++c )
+  {
+    const vtkIdType nofCellPoints =
+      (location < size)? connectivity.get()[location] : -1;
+
+    if( (nofCellPoints < 0) ||
+        (static_cast<quint64>(nofCellPoints) >= size - location) )
+    {
+      qWarning("Invalid connectivity in the live segment '%s'",
+        qPrintable(m_segmentName));
+      return false;
+    }
+
+    for( vtkIdType p = 1; p <= nofCellPoints; ++p )
+    {
+      const vtkIdType id = connectivity.get()[location + p];
+
+      if( (id < 0) || (id >= nofPoints) )
+      {
+        qWarning("Point id %lld out of range in the live segment '%s'",
+          static_cast<long long>(id), qPrintable(m_segmentName));
+        return false;
+      }
+    }
+
+    location += nofCellPoints + 1;
+  }
+
+  // Every wrapped buffer keeps the mapping alive
+  std::shared_ptr<Mapping> mapping = m_mapping;
+  auto keepMapping = [mapping](void*) {};
+
+  mesh.m_nofCells = static_cast<vtkIdType>(part.m_nofCells);
+
+  mesh.m_points.m_data          = base + part.m_pointsOffset;
+  mesh.m_points.m_dataType      = VTK_FLOAT;
+  mesh.m_points.m_nofTuples     = static_cast<vtkIdType>(part.m_nofPoints);
+  mesh.m_points.m_nofComponents = 3;
+  mesh.m_points.m_deleter       = keepMapping;
+
+  mesh.m_connectivity.m_data      = connectivity.get();
+  mesh.m_connectivity.m_dataType  = VTK_ID_TYPE;
+  mesh.m_connectivity.m_nofTuples = static_cast<vtkIdType>(size);
+  mesh.m_connectivity.m_deleter   = [connectivity](void*) {};
+
+  mesh.m_cellTypes.m_data      = cellTypes.get();
+  mesh.m_cellTypes.m_dataType  = VTK_UNSIGNED_CHAR;
+  mesh.m_cellTypes.m_nofTuples = static_cast<vtkIdType>(part.m_nofCells);
+  mesh.m_cellTypes.m_deleter   = [cellTypes](void*) {};
+
+  for( const LiveFieldRecord& field : fields )
+  {
+    const bool pointData = (field.m_association == LiveFieldRecord::POINT_DATA);
+
+    ExternalBuffer buffer;
+    buffer.m_data          = base + field.m_offset;
+    buffer.m_dataType      = VTK_FLOAT;
+    buffer.m_nofTuples     = static_cast<vtkIdType>(
+      pointData? part.m_nofPoints : part.m_nofCells);
+    buffer.m_nofComponents = static_cast<int>(field.m_nofComponents);
+    buffer.m_deleter       = keepMapping;
+
+    (pointData? mesh.m_pointFields : mesh.m_cellFields)
+      << qMakePair(recordName(field.m_name), buffer);
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
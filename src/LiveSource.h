@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef LIVESOURCE_H
+#define LIVESOURCE_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+
+struct ExternalMesh;
+struct LiveFieldRecord;
+struct LivePartRecord;
+struct LiveSegmentHeader;
+
+class Geometry;
+
+// Follows a POSIX shared-memory segment updated by a solver on the same node
+// (see LiveSegment.h). Every part of the segment is a GeometryPart of the
+// target Geometry wrapping the mapped points and fields without copying them.
+// When the generation of the segment advances the parts are refreshed, and
+// only the ones whose topology changed are wrapped again, with a checked
+// copy of their connectivity. The source is owned by the
+// Geometry.
+//
+// Values are read in place: a frame drawn while the solver writes may show
+// a mix of two generations.
+class LiveSource : public QObject
+{
+  Q_OBJECT
+public:
+  explicit LiveSource(const QString& segmentName, Geometry* geometry);
+  virtual ~LiveSource();
+
+  // Maps the segment and publishes its parts, then polls it
+  bool attach();
+
+  int getPollInterval() const;
+  void setPollInterval(int msecs);
+
+  quint64 getGeneration() const;
+
+protected slots:
+  void poll();
+
+protected:
+  class Mapping;
+
+  bool remap();
+  const LiveSegmentHeader* getHeader() const;
+
+  bool readRecords(
+    QVector<LivePartRecord>& parts,
+    QVector<QVector<LiveFieldRecord>>& fields) const;
+  // count elements of elementSize bytes from offset
+  bool isInSegment(
+    quint64 offset,
+    quint64 count,
+    quint64 elementSize,
+    quint64 alignment) const;
+
+  // Wraps points and fields, copies and checks the topology
+  bool createMesh(
+    const LivePartRecord& part,
+    const QVector<LiveFieldRecord>& fields,
+    ExternalMesh& mesh) const;
+
+  Geometry*                m_geometry;
+  QString                  m_segmentName;
+  QTimer                   m_timer;
+  std::shared_ptr<Mapping> m_mapping;
+  quint64                  m_generation;
+  QVector<quint64>         m_topologies;
+  bool                     m_rewrapParts;
+};
+
+#endif // LIVESOURCE_H
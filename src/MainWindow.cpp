@@ -27,7 +27,10 @@
 #include <iostream>
 
 //Qt Includes
+#include <QFileDialog>
 #include <QHBoxLayout>
+#include <QInputDialog>
+#include <QStatusBar>
 
 //VTK Includes
 #include <vtkDebugLeaks.h>
@@ -36,7 +39,11 @@
 #include "AboutDialog.h"
 #include "Geometry.h"
 #include "GeometryFactory.h"
+#include "PartCache.h"
 #include "PlotHD.h"
+#include "PlotPool.h"
+#include "TimeSeriesPlayer.h"
+#include "Tracer.h"
 
 MainWindow* MainWindow::m_winInstance = nullptr;
 
@@ -64,6 +71,25 @@ MainWindow::MainWindow(QWidget *parent) :
     m_ui->m_removeGeomBtn, SIGNAL(pressed()),
     this,                  SLOT(removeGeometry()));
 
+  connect(
+    m_ui->action_Open, SIGNAL(triggered(bool)),
+    this,              SLOT(openGeometry()));
+
+  connect(
+    m_ui->action_AttachLiveSolver, SIGNAL(triggered(bool)),
+    this,                          SLOT(attachLiveSolver()));
+
+  connect(
+    m_ui->action_PlayTimeSteps, SIGNAL(toggled(bool)),
+    this,                       SLOT(playTimeSteps(bool)));
+
+  // Started from QTVTK_TRACE, stopping it from the menu saves it
+  m_ui->action_RecordTrace->setChecked(Tracer::IsEnabled());
+
+  connect(
+    m_ui->action_RecordTrace, SIGNAL(toggled(bool)),
+    this,                     SLOT(recordTrace(bool)));
+
   connect(
     m_ui->action_About, SIGNAL(triggered(bool)),
     this,               SLOT(showAboutDialog()));
@@ -82,10 +108,16 @@ MainWindow::~MainWindow()
 
 void MainWindow::addPlot()
 {
-  m_plotList.append(new PlotHD(m_ui->m_plotsWidget));
+  m_plotList.append(PlotPool::Acquire(m_ui->m_plotsWidget));
 
   m_ui->m_plotsWidget->layout()->addWidget(m_plotList.last());
 
+  // Recycled plots are already connected
+  connect(
+    m_plotList.last(), SIGNAL(probed(QString)),
+    statusBar(),       SLOT(showMessage(QString)),
+    Qt::UniqueConnection);
+
   if( m_geomList.isEmpty() )
   {
     addGeometry();
@@ -104,7 +136,7 @@ void MainWindow::removePlot()
     return;
   }
 
-  m_plotList.last()->deleteLater();
+  PlotPool::Release(m_plotList.last());
   m_plotList.pop_back();
 
 //  vtkDebugLeaks::PrintCurrentLeaks();
@@ -120,6 +152,94 @@ void MainWindow::addGeometry()
 //  vtkDebugLeaks::PrintCurrentLeaks();
 }
 
+void MainWindow::openGeometry()
+{
+  const QString fileName = QFileDialog::getOpenFileName(
+    this,
+    tr("Open Geometry"),
+    QString(),
+    tr("VTK files (*.vtu *.vtp *.vtm *.vtk *.pvd)"));
+
+  if( fileName.isEmpty() )
+  {
+    return;
+  }
+
+  std::unique_ptr<Geometry> geom =
+    GeometryFactory::CreateGeometryFromFile(fileName);
+
+  if( !geom )
+  {
+    std::cout << "Unsupported geometry file: "
+              << qPrintable(fileName) << std::endl;
+    return;
+  }
+
+  connect(
+    geom.get(), SIGNAL(loadProgress(int, int)),
+    this,       SLOT(showLoadProgress(int, int)));
+
+  connect(
+    geom.get(), SIGNAL(loadFinished()),
+    this,       SLOT(showLoadFinished()));
+
+  m_geomList.append(std::shared_ptr<Geometry>(std::move(geom)));
+}
+
+void MainWindow::attachLiveSolver()
+{
+  const QString segmentName = QInputDialog::getText(
+    this,
+    tr("Attach Live Solver"),
+    tr("Shared memory segment:"),
+    QLineEdit::Normal,
+    QString("/qtvtk_live"));
+
+  if( segmentName.isEmpty() )
+  {
+    return;
+  }
+
+  std::unique_ptr<Geometry> geom =
+    GeometryFactory::CreateLiveGeometry(segmentName);
+
+  if( !geom )
+  {
+    statusBar()->showMessage(
+      tr("Could not attach to '%1'").arg(segmentName), 3000);
+    return;
+  }
+
+  statusBar()->showMessage(
+    tr("Attached to '%1', %2 parts").arg(segmentName).arg(geom->getNofParts()),
+    3000);
+
+  m_geomList.append(std::shared_ptr<Geometry>(std::move(geom)));
+}
+
+void MainWindow::showLoadProgress(int loadedParts, int totalParts)
+{
+  statusBar()->showMessage(
+    tr("Loading geometry: %1/%2 parts").arg(loadedParts).arg(totalParts));
+}
+
+void MainWindow::showLoadFinished()
+{
+  QString message = tr("Geometry loaded, %1 parts resident in %2 MB")
+    .arg(PartCache::GetNofResidentParts())
+    .arg(PartCache::GetResidentBytes() / (1024.0 * 1024.0), 0, 'f', 1);
+
+  Geometry* geom = qobject_cast<Geometry*>(sender());
+
+  if( geom && (geom->getSavedBytes() > 0) )
+  {
+    message += tr(", %1 MB saved in single precision")
+      .arg(geom->getSavedBytes() / (1024.0 * 1024.0), 0, 'f', 1);
+  }
+
+  statusBar()->showMessage(message, 3000);
+}
+
 void MainWindow::removeGeometry()
 {
   if( m_geomList.isEmpty() )
@@ -172,6 +292,8 @@ void MainWindow::removeAllPlots()
     delete plt;
   }
   m_plotList.clear();
+
+  PlotPool::Clear();
 }
 
 void MainWindow::removeAllGeometries()
@@ -184,6 +306,66 @@ void MainWindow::removeAllGeometries()
   m_geomList.clear();
 }
 
+void MainWindow::playTimeSteps(bool on)
+{
+  // The most recently opened transient geometry is played
+  for( int i = m_geomList.size() - 1; i >= 0; --i )
+  {
+    if( TimeSeriesPlayer* player = m_geomList[i]->getTimeSeriesPlayer() )
+    {
+      if( on )
+      {
+        player->play();
+      }
+      else
+      {
+        player->pause();
+      }
+
+      return;
+    }
+  }
+
+  if( on )
+  {
+    statusBar()->showMessage(tr("No transient geometry opened"), 3000);
+    m_ui->action_PlayTimeSteps->setChecked(false);
+  }
+}
+
+void MainWindow::recordTrace(bool on)
+{
+  if( on )
+  {
+    Tracer::Clear();
+    Tracer::SetEnabled(true);
+
+    statusBar()->showMessage(tr("Recording trace"));
+    return;
+  }
+
+  Tracer::SetEnabled(false);
+
+  statusBar()->clearMessage();
+
+  const QString fileName = QFileDialog::getSaveFileName(
+    this,
+    tr("Save Trace"),
+    QString("trace.json"),
+    tr("Chrome trace (*.json)"));
+
+  if( fileName.isEmpty() )
+  {
+    return;
+  }
+
+  if( Tracer::WriteChromeTrace(fileName) )
+  {
+    statusBar()->showMessage(
+      tr("%1 trace events written").arg(Tracer::GetNofEvents()), 3000);
+  }
+}
+
 void MainWindow::showAboutDialog()
 {
   AboutDialog* dialog = new AboutDialog();
@@ -50,8 +50,14 @@ protected slots:
   void addPlot();
   void removePlot();
   void addGeometry();
+  void openGeometry();
+  void attachLiveSolver();
   void removeGeometry();
+  void playTimeSteps(bool on);
+  void recordTrace(bool on);
   void showAboutDialog();
+  void showLoadProgress(int loadedParts, int totalParts);
+  void showLoadFinished();
 
 protected:
   MainWindow(QWidget* parent = 0);
@@ -0,0 +1,431 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "MemoryGrowthDriver.h"
+
+#include "MainWindow.h"
+#include "PlotPool.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <vtkDebugLeaks.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+#include <unistd.h>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+// Net number of VTK objects constructed while it is installed, from any
+// thread. PrintCurrentLeaks() writes to cerr, it cannot be captured.
+class ObjectCounter : public vtkDebugLeaksObserver
+{
+public:
+  ObjectCounter()
+    :
+    m_count(0)
+  {
+  }
+
+  virtual void ConstructingObject(vtkObjectBase*) VTK_OVERRIDE
+  {
+    ++m_count;
+  }
+
+  virtual void DestructingObject(vtkObjectBase*) VTK_OVERRIDE
+  {
+    --m_count;
+  }
+
+  std::atomic<int> m_count;
+};
+
+ObjectCounter s_objectCounter;
+
+// Least squares slope of y over x, the growth per cycle
+double fitSlope(const QList<double>& x, const QList<double>& y)
+{
+  const int n = x.size();
+
+  if( n < 2 )
+  {
+    return 0.0;
+  }
+
+  double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+
+  for( int i = 0; i < n; ++i )
+  {
+    sx  += x[i];
+    sy  += y[i];
+    sxx += x[i] * x[i];
+    sxy += x[i] * y[i];
+  }
+
+  const double denominator = n * sxx - sx * sx;
+
+  return (denominator != 0.0)? (n * sxy - sx * sy) / denominator : 0.0;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+MemoryGrowthDriver::Options::Options()
+  :
+  m_nofCycles(1000),
+  m_nofWarmupCycles(20),
+  m_sampleInterval(10),
+  m_settleMsec(20),
+  m_maxBytesPerCycle(4096.0),
+  m_maxObjectsPerCycle(0.01),
+  m_maxMsecPerCycle(250.0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+MemoryGrowthDriver::MemoryGrowthDriver(const Options& options)
+  :
+  m_options(options)
+{
+}
+
+//------------------------------------------------------------------------------
+
+qint64 MemoryGrowthDriver::GetResidentSetSize()
+{
+  // Second field of statm: resident pages
+  QFile statm("/proc/self/statm");
+
+  if( !statm.open(QIODevice::ReadOnly) )
+  {
+    return -1;
+  }
+
+  const QList<QByteArray> fields = statm.readAll().split(' ');
+
+  if( fields.size() < 2 )
+  {
+    return -1;
+  }
+
+  return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+}
+
+//------------------------------------------------------------------------------
+
+int MemoryGrowthDriver::CountVTKObjects()
+{
+#ifdef VTK_DEBUG_LEAKS
+  return s_objectCounter.m_count;
+#else
+  return -1;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+int MemoryGrowthDriver::run(MainWindow& window)
+{
+  m_samples.clear();
+
+  // Counts from here, only the growth over the cycles is used
+  s_objectCounter.m_count = 0;
+  vtkDebugLeaks::SetDebugLeaksObserver(&s_objectCounter);
+
+  window.show();
+  settle();
+
+  double totalMsec       = 0.0;
+  double totalSettleMsec = 0.0;
+  int    timedCycles     = 0;
+
+  for( int cycle = 1; cycle <= m_options.m_nofCycles; ++cycle )
+  {
+    double settleMsec = 0.0;
+    const double cycleMsec = runCycle(window, settleMsec);
+
+    if( cycle > m_options.m_nofWarmupCycles )
+    {
+      totalMsec       += cycleMsec;
+      totalSettleMsec += settleMsec;
+      ++timedCycles;
+    }
+
+    if( (cycle % m_options.m_sampleInterval == 0) ||
+        (cycle == m_options.m_nofCycles) )
+    {
+      Sample sample;
+      sample.m_cycle         = cycle;
+      sample.m_rss           = GetResidentSetSize();
+      sample.m_nofVTKObjects = CountVTKObjects();
+      sample.m_cycleMsec     = cycleMsec;
+      sample.m_settleMsec    = settleMsec;
+
+      m_samples << sample;
+
+      std::fprintf(stderr,
+        "cycle %d: rss %lld, %d vtk objects, %.2f ms (settle %.1f ms)\n",
+        sample.m_cycle,
+        static_cast<long long>(sample.m_rss),
+        sample.m_nofVTKObjects,
+        sample.m_cycleMsec,
+        sample.m_settleMsec);
+    }
+  }
+
+  vtkDebugLeaks::SetDebugLeaksObserver(nullptr);
+
+  // Growth per cycle, fitted over the samples after the warm-up
+  QList<double> cycles, rss, objects;
+
+  for( const Sample& sample : m_samples )
+  {
+    if( sample.m_cycle > m_options.m_nofWarmupCycles )
+    {
+      cycles  << sample.m_cycle;
+      rss     << sample.m_rss;
+      objects << sample.m_nofVTKObjects;
+    }
+  }
+
+  const double bytesPerCycle   = fitSlope(cycles, rss);
+  const double objectsPerCycle = fitSlope(cycles, objects);
+  const double msecPerCycle    =
+    (timedCycles > 0)? totalMsec / timedCycles : 0.0;
+  const double settleMsecPerCycle =
+    (timedCycles > 0)? totalSettleMsec / timedCycles : 0.0;
+
+  const bool countObjects = !m_samples.isEmpty() &&
+    (m_samples.first().m_nofVTKObjects >= 0);
+
+  const bool bytesOk   = bytesPerCycle <= m_options.m_maxBytesPerCycle;
+  const bool objectsOk = !countObjects ||
+    (objectsPerCycle <= m_options.m_maxObjectsPerCycle);
+  const bool msecOk    = msecPerCycle <= m_options.m_maxMsecPerCycle;
+
+  std::printf("cycles: %d (warm-up %d)\n",
+    m_options.m_nofCycles, m_options.m_nofWarmupCycles);
+  std::printf("bytes/cycle: %.1f (max %.1f) %s\n",
+    bytesPerCycle, m_options.m_maxBytesPerCycle, bytesOk? "OK" : "FAILED");
+
+  if( countObjects )
+  {
+    std::printf("vtk objects/cycle: %.3f (max %.3f) %s\n",
+      objectsPerCycle, m_options.m_maxObjectsPerCycle,
+      objectsOk? "OK" : "FAILED");
+  }
+  else
+  {
+    std::printf("vtk objects/cycle: not checked, VTK built without "
+                "VTK_DEBUG_LEAKS\n");
+    std::fprintf(stderr, "WARNING: the VTK object growth is not checked, "
+                 "VTK was built without VTK_DEBUG_LEAKS\n");
+  }
+
+  std::printf("ms/cycle: %.2f (max %.2f) %s\n",
+    msecPerCycle, m_options.m_maxMsecPerCycle, msecOk? "OK" : "FAILED");
+  std::printf("settle ms/cycle: %.2f (not checked)\n", settleMsecPerCycle);
+  std::printf("plots created: %d, reused: %d (pool of %d)\n",
+    PlotPool::GetNofCreations(), PlotPool::GetNofReuses(),
+    PlotPool::GetCapacity());
+
+  std::fflush(stdout);
+
+  if( !m_options.m_outputFile.isEmpty() && !writeSamples() )
+  {
+    return 1;
+  }
+
+  return (bytesOk && objectsOk && msecOk)? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+
+const QList<MemoryGrowthDriver::Sample>& MemoryGrowthDriver::getSamples() const
+{
+  return m_samples;
+}
+
+//------------------------------------------------------------------------------
+
+int MemoryGrowthDriver::Main(const QStringList& arguments)
+{
+  Options options;
+
+  for( int i = 1; i + 1 < arguments.size(); ++i )
+  {
+    const QString& arg   = arguments[i];
+    const QString  value = arguments[i + 1];
+
+    if( arg == "--memory-cycles" )
+    {
+      options.m_nofCycles = value.toInt();
+    }
+    else if( arg == "--warmup-cycles" )
+    {
+      options.m_nofWarmupCycles = value.toInt();
+    }
+    else if( arg == "--sample-interval" )
+    {
+      options.m_sampleInterval = value.toInt();
+    }
+    else if( arg == "--settle-ms" )
+    {
+      options.m_settleMsec = value.toInt();
+    }
+    else if( arg == "--max-bytes-per-cycle" )
+    {
+      options.m_maxBytesPerCycle = value.toDouble();
+    }
+    else if( arg == "--max-objects-per-cycle" )
+    {
+      options.m_maxObjectsPerCycle = value.toDouble();
+    }
+    else if( arg == "--max-ms-per-cycle" )
+    {
+      options.m_maxMsecPerCycle = value.toDouble();
+    }
+    else if( arg == "--output" )
+    {
+      options.m_outputFile = value;
+    }
+    else
+    {
+      continue;
+    }
+
+    ++i;
+  }
+
+  options.m_nofCycles      = std::max(options.m_nofCycles, 1);
+  options.m_sampleInterval = std::max(options.m_sampleInterval, 1);
+
+  MainWindow& window = MainWindow::GetWindowInstance();
+
+  MemoryGrowthDriver driver(options);
+  const int result = driver.run(window);
+
+  window.removeAllPlots();
+  window.removeAllGeometries();
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+
+double MemoryGrowthDriver::runCycle(MainWindow& window, double& settleMsec)
+{
+  // Only the slots and the events they post are timed, settling waits a
+  // fixed time which would hide the cost of the cycle
+  QElapsedTimer timer;
+  double cycleMsec = 0.0;
+
+  // The MainWindow slots are protected, they are called like the menu does
+  timer.start();
+  QMetaObject::invokeMethod(&window, "addGeometry", Qt::DirectConnection);
+  QMetaObject::invokeMethod(&window, "addPlot", Qt::DirectConnection);
+  deliverEvents();
+  cycleMsec  += timer.nsecsElapsed() / 1.0e6;
+  settleMsec += settle();
+
+  timer.start();
+  QMetaObject::invokeMethod(&window, "removePlot", Qt::DirectConnection);
+  deliverEvents();
+  cycleMsec  += timer.nsecsElapsed() / 1.0e6;
+  settleMsec += settle();
+
+  timer.start();
+  QMetaObject::invokeMethod(&window, "removeGeometry", Qt::DirectConnection);
+  deliverEvents();
+  cycleMsec  += timer.nsecsElapsed() / 1.0e6;
+  settleMsec += settle();
+
+  return cycleMsec;
+}
+
+//------------------------------------------------------------------------------
+
+void MemoryGrowthDriver::deliverEvents()
+{
+  // One pass over the events already posted, without waiting for new ones
+  QApplication::processEvents();
+  QApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+//------------------------------------------------------------------------------
+
+double MemoryGrowthDriver::settle()
+{
+  // Lets the redraw scheduler tick and the plots paint, plots removed over
+  // the pool capacity are deleted with deleteLater() which needs the deferred
+  // deletes delivered
+  QElapsedTimer timer;
+  timer.start();
+
+  do
+  {
+    QApplication::processEvents(QEventLoop::AllEvents, 5);
+    QApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+  }
+  while( timer.elapsed() < m_options.m_settleMsec );
+
+  return timer.nsecsElapsed() / 1.0e6;
+}
+
+//------------------------------------------------------------------------------
+
+bool MemoryGrowthDriver::writeSamples() const
+{
+  QFile file(m_options.m_outputFile);
+
+  if( !file.open(QIODevice::WriteOnly | QIODevice::Text) )
+  {
+    qWarning("Could not write '%s'", qPrintable(m_options.m_outputFile));
+    return false;
+  }
+
+  QTextStream out(&file);
+  out << "cycle,rss_bytes,vtk_objects,cycle_ms,settle_ms\n";
+
+  for( const Sample& sample : m_samples )
+  {
+    out << sample.m_cycle << ","
+        << sample.m_rss << ","
+        << sample.m_nofVTKObjects << ","
+        << sample.m_cycleMsec << ","
+        << sample.m_settleMsec << "\n";
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,96 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef MEMORYGROWTHDRIVER_H
+#define MEMORYGROWTHDRIVER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class MainWindow;
+
+// Automated version of the add/remove plot test of the README: runs the
+// MainWindow addGeometry/addPlot/removePlot/removeGeometry cycle many times
+// and samples the resident set size, the live VTK objects (vtkDebugLeaks)
+// and the cycle time. The cycle time is the slot calls and the delivery of
+// the events they post, the settling between them is reported apart. The
+// growth per cycle is fitted over the cycles after the warm-up and checked
+// against thresholds, so it can gate a build.
+class MemoryGrowthDriver
+{
+public:
+  struct Options
+  {
+    Options();
+
+    int     m_nofCycles;
+    int     m_nofWarmupCycles;
+    int     m_sampleInterval;
+    int     m_settleMsec;
+    double  m_maxBytesPerCycle;
+    double  m_maxObjectsPerCycle;
+    double  m_maxMsecPerCycle;
+    QString m_outputFile;
+  };
+
+  struct Sample
+  {
+    int    m_cycle;
+    qint64 m_rss;
+    int    m_nofVTKObjects;
+    double m_cycleMsec;
+    double m_settleMsec;
+  };
+
+  explicit MemoryGrowthDriver(const Options& options);
+
+  // Returns 0 if every threshold holds
+  int run(MainWindow& window);
+
+  const QList<Sample>& getSamples() const;
+
+  static qint64 GetResidentSetSize();
+
+  // Net number of VTK objects constructed since run() started, -1 if VTK
+  // was built without debug leaks
+  static int CountVTKObjects();
+
+  // Entry point of the --memory-cycles command line mode
+  static int Main(const QStringList& arguments);
+
+protected:
+  // Returns the msec of the slot calls and of the delivery of the events
+  // they posted, the msec spent settling are added to settleMsec
+  double runCycle(MainWindow& window, double& settleMsec);
+
+  void deliverEvents();
+
+  // Returns the msec spent
+  double settle();
+  bool writeSamples() const;
+
+  Options       m_options;
+  QList<Sample> m_samples;
+};
+
+#endif // MEMORYGROWTHDRIVER_H
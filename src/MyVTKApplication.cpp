@@ -22,14 +22,31 @@
 
 #include "MyVTKApplication.h"
 
+#include "Geometry.h"
 #include "MainWindow.h"
+#include "PartBatch.h"
+#include "PartCache.h"
+#include "PlotHD.h"
+#include "PlotPool.h"
+#include "Tracer.h"
 
 MyVTKApplication::MyVTKApplication(int& argc, char** argv, bool isGUI) :
   QApplication(argc, argv, isGUI)
 {
-  connect(
-    this, SIGNAL(aboutToQuit()),
-    this, SLOT(cleanPlotsOnExit()) );
+  Tracer::StartFromEnvironment();
+  PartCache::SetupFromEnvironment();
+  PlotPool::SetupFromEnvironment();
+  PlotHD::SetupFromEnvironment();
+  PartBatch::SetupFromEnvironment();
+  Geometry::SetDefaultPrecisionPolicy(PrecisionPolicy::FromEnvironment());
+
+  // Without GUI there is no MainWindow to clean, see BatchRenderer
+  if( isGUI )
+  {
+    connect(
+      this, SIGNAL(aboutToQuit()),
+      this, SLOT(cleanPlotsOnExit()) );
+  }
 }
 
 
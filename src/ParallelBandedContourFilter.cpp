@@ -0,0 +1,428 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "ParallelBandedContourFilter.h"
+
+#include "Tracer.h"
+
+#include <vtkAppendPolyData.h>
+#include <vtkDataArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMP.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+// Sorts the cells in slabs along the longest axis of the input, with about
+// the same number of cells in every slab
+class ChunkPartitioner
+{
+public:
+  static const int NofBins = 4096;
+
+  ChunkPartitioner(vtkPolyData* source, int nofChunks)
+    :
+    m_source(source),
+    m_nofChunks(nofChunks),
+    m_axis(0)
+  {
+    double bounds[6];
+    m_source->GetBounds(bounds);
+
+    for( int i = 1; i < 3; ++i )
+    {
+      if( (bounds[2*i + 1] - bounds[2*i]) >
+          (bounds[2*m_axis + 1] - bounds[2*m_axis]) )
+      {
+        m_axis = i;
+      }
+    }
+
+    m_origin = bounds[2*m_axis];
+    m_length = bounds[2*m_axis + 1] - bounds[2*m_axis];
+  }
+
+  // Bin of every cell, computed in parallel from the cell centroids
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double x[3];
+
+    for( vtkIdType cellId = begin; cellId < end; ++cellId )
+    {
+      vtkIdType  nofPoints = 0;
+      vtkIdType* points    = nullptr;
+
+      m_source->GetCellPoints(cellId, nofPoints, points);
+
+      double center = 0.0;
+
+      for( vtkIdType i = 0; i < nofPoints; ++i )
+      {
+        m_source->GetPoint(points[i], x);
+        center += x[m_axis];
+      }
+
+      center = (nofPoints > 0)? center / nofPoints : m_origin;
+
+      const int bin = (m_length > 0.0)?
+        static_cast<int>((center - m_origin) / m_length * NofBins) : 0;
+
+      m_bins[cellId] =
+        static_cast<short>(std::min(std::max(bin, 0), NofBins - 1));
+    }
+  }
+
+  std::vector<std::vector<vtkIdType>> partition()
+  {
+    const vtkIdType nofCells = m_source->GetNumberOfCells();
+
+    m_bins.resize(nofCells);
+    vtkSMPTools::For(0, nofCells, *this);
+
+    // Slab boundaries at the histogram quantiles
+    std::vector<vtkIdType> histogram(NofBins, 0);
+
+    for( vtkIdType cellId = 0; cellId < nofCells; ++cellId )
+    {
+      ++histogram[m_bins[cellId]];
+    }
+
+    std::vector<int> chunkOfBin(NofBins);
+    vtkIdType count = 0;
+
+    for( int bin = 0; bin < NofBins; ++bin )
+    {
+      chunkOfBin[bin] = static_cast<int>(
+        std::min<vtkIdType>(count * m_nofChunks / nofCells, m_nofChunks - 1));
+
+      count += histogram[bin];
+    }
+
+    std::vector<std::vector<vtkIdType>> chunks(m_nofChunks);
+
+    for( auto& chunk : chunks )
+    {
+      chunk.reserve(nofCells / m_nofChunks + 1);
+    }
+
+    for( vtkIdType cellId = 0; cellId < nofCells; ++cellId )
+    {
+      chunks[chunkOfBin[m_bins[cellId]]].push_back(cellId);
+    }
+
+    return chunks;
+  }
+
+protected:
+  vtkPolyData*       m_source;
+  int                m_nofChunks;
+  int                m_axis;
+  double             m_origin;
+  double             m_length;
+  std::vector<short> m_bins;
+};
+
+//------------------------------------------------------------------------------
+
+// Bands every chunk with its own (serial) banded contour filter
+class BandChunkFunctor
+{
+public:
+  BandChunkFunctor(
+    vtkBandedPolyDataContourFilter* settings,
+    vtkPolyData* source,
+    const std::vector<std::vector<vtkIdType>>& chunks)
+    :
+    m_settings(settings),
+    m_source(source),
+    m_chunks(chunks),
+    m_bands(chunks.size()),
+    m_edges(chunks.size())
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for( vtkIdType c = begin; c < end; ++c )
+    {
+      if( m_chunks[c].empty() )
+      {
+        continue;
+      }
+
+      TRACE_SCOPE("ParallelBandedContourFilter::bandChunk");
+
+      vtkSmartPointer<vtkBandedPolyDataContourFilter> contours =
+        vtkSmartPointer<vtkBandedPolyDataContourFilter>::New();
+
+      const int nofValues = m_settings->GetNumberOfContours();
+
+      contours->SetNumberOfContours(nofValues);
+
+      for( int i = 0; i < nofValues; ++i )
+      {
+        contours->SetValue(i, m_settings->GetValue(i));
+      }
+
+      contours->SetClipping(m_settings->GetClipping());
+      contours->SetClipTolerance(m_settings->GetClipTolerance());
+      contours->SetScalarMode(m_settings->GetScalarMode());
+      contours->SetGenerateContourEdges(m_settings->GetGenerateContourEdges());
+
+      contours->SetInputData(extractChunk(m_chunks[c]));
+      contours->Update();
+
+      m_bands[c] = contours->GetOutput(0);
+      m_edges[c] = contours->GetOutput(1);
+    }
+  }
+
+  const std::vector<vtkSmartPointer<vtkPolyData>>& getBands() const
+  {
+    return m_bands;
+  }
+
+  const std::vector<vtkSmartPointer<vtkPolyData>>& getEdges() const
+  {
+    return m_edges;
+  }
+
+protected:
+  // Compact copy of the cells of a chunk, with only the points they use and
+  // the active point scalars
+  vtkSmartPointer<vtkPolyData> extractChunk(
+    const std::vector<vtkIdType>& cells) const
+  {
+    std::vector<vtkIdType> globalIds;
+
+    for( vtkIdType cellId : cells )
+    {
+      vtkIdType  nofPoints = 0;
+      vtkIdType* points    = nullptr;
+
+      m_source->GetCellPoints(cellId, nofPoints, points);
+      globalIds.insert(globalIds.end(), points, points + nofPoints);
+    }
+
+    std::sort(globalIds.begin(), globalIds.end());
+    globalIds.erase(
+      std::unique(globalIds.begin(), globalIds.end()),
+      globalIds.end());
+
+    const vtkIdType nofLocalPoints = static_cast<vtkIdType>(globalIds.size());
+
+    vtkPoints* sourcePoints = m_source->GetPoints();
+    vtkDataArray* sourceScalars = m_source->GetPointData()->GetScalars();
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataType(sourcePoints->GetDataType());
+    points->SetNumberOfPoints(nofLocalPoints);
+
+    vtkSmartPointer<vtkDataArray> scalars =
+      vtkSmartPointer<vtkDataArray>::Take(
+        vtkDataArray::CreateDataArray(sourceScalars->GetDataType()));
+
+    scalars->SetName(sourceScalars->GetName());
+    scalars->SetNumberOfComponents(sourceScalars->GetNumberOfComponents());
+    scalars->SetNumberOfTuples(nofLocalPoints);
+
+    double x[3];
+
+    for( vtkIdType i = 0; i < nofLocalPoints; ++i )
+    {
+      sourcePoints->GetPoint(globalIds[i], x);
+      points->SetPoint(i, x);
+
+      scalars->SetTuple(i, globalIds[i], sourceScalars);
+    }
+
+    vtkSmartPointer<vtkPolyData> chunk = vtkSmartPointer<vtkPolyData>::New();
+    chunk->SetPoints(points);
+    chunk->GetPointData()->SetScalars(scalars);
+    chunk->Allocate(static_cast<vtkIdType>(cells.size()));
+
+    std::vector<vtkIdType> localIds;
+
+    for( vtkIdType cellId : cells )
+    {
+      vtkIdType  nofPoints = 0;
+      vtkIdType* cellPoints = nullptr;
+
+      m_source->GetCellPoints(cellId, nofPoints, cellPoints);
+
+      localIds.resize(nofPoints);
+
+      for( vtkIdType i = 0; i < nofPoints; ++i )
+      {
+        localIds[i] = std::lower_bound(
+          globalIds.begin(), globalIds.end(), cellPoints[i]) -
+          globalIds.begin();
+      }
+
+      chunk->InsertNextCell(
+        m_source->GetCellType(cellId),
+        nofPoints,
+        localIds.data());
+    }
+
+    return chunk;
+  }
+
+  vtkBandedPolyDataContourFilter*            m_settings;
+  vtkPolyData*                               m_source;
+  const std::vector<std::vector<vtkIdType>>& m_chunks;
+
+  std::vector<vtkSmartPointer<vtkPolyData>> m_bands;
+  std::vector<vtkSmartPointer<vtkPolyData>> m_edges;
+};
+
+//------------------------------------------------------------------------------
+
+void appendChunks(
+  const std::vector<vtkSmartPointer<vtkPolyData>>& chunks,
+  vtkPolyData* output)
+{
+  vtkSmartPointer<vtkAppendPolyData> append =
+    vtkSmartPointer<vtkAppendPolyData>::New();
+
+  int nofInputs = 0;
+
+  for( const vtkSmartPointer<vtkPolyData>& chunk : chunks )
+  {
+    if( chunk && (chunk->GetNumberOfCells() > 0) )
+    {
+      append->AddInputData(chunk);
+      ++nofInputs;
+    }
+  }
+
+  if( nofInputs == 0 )
+  {
+    output->Initialize();
+    return;
+  }
+
+  append->Update();
+
+  output->ShallowCopy(append->GetOutput());
+}
+
+//------------------------------------------------------------------------------
+
+vtkStandardNewMacro(ParallelBandedContourFilter);
+
+vtkIdType ParallelBandedContourFilter::s_minNofCellsPerChunk = 25000;
+
+//------------------------------------------------------------------------------
+
+ParallelBandedContourFilter::ParallelBandedContourFilter()
+{
+}
+
+//------------------------------------------------------------------------------
+
+ParallelBandedContourFilter::~ParallelBandedContourFilter()
+{
+}
+
+//------------------------------------------------------------------------------
+
+vtkIdType ParallelBandedContourFilter::GetMinNofCellsPerChunk()
+{
+  return s_minNofCellsPerChunk;
+}
+
+//------------------------------------------------------------------------------
+
+void ParallelBandedContourFilter::SetMinNofCellsPerChunk(vtkIdType nofCells)
+{
+  s_minNofCellsPerChunk = std::max<vtkIdType>(nofCells, 1);
+}
+
+//------------------------------------------------------------------------------
+
+int ParallelBandedContourFilter::computeNofChunks(vtkIdType nofCells) const
+{
+#ifdef VTK_SMP_Sequential
+  // The slabs would be banded one after the other, splitting only adds the
+  // partitioning and the append
+  (void)nofCells;
+  return 1;
+#else
+  // A few chunks per thread so uneven slabs still balance out
+  const vtkIdType nofThreads =
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  return static_cast<int>(
+    std::min(4 * nofThreads, nofCells / s_minNofCellsPerChunk));
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+int ParallelBandedContourFilter::RequestData(
+  vtkInformation* request,
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  TRACE_SCOPE("ParallelBandedContourFilter::RequestData");
+
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+
+  const int nofChunks = input? computeNofChunks(input->GetNumberOfCells()) : 0;
+
+  if( (nofChunks < 2) ||
+      !input->GetPoints() ||
+      !input->GetPointData()->GetScalars() ||
+      (this->GetNumberOfContours() < 1) )
+  {
+    return this->Superclass::RequestData(request, inputVector, outputVector);
+  }
+
+  // The cell links are built once here, the workers only read them
+  vtkSmartPointer<vtkPolyData> source = vtkSmartPointer<vtkPolyData>::New();
+  source->ShallowCopy(input);
+  source->BuildCells();
+
+  ChunkPartitioner partitioner(source, nofChunks);
+  const std::vector<std::vector<vtkIdType>> chunks = partitioner.partition();
+
+  BandChunkFunctor bander(this, source, chunks);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(chunks.size()), 1, bander);
+
+  appendChunks(bander.getBands(), vtkPolyData::GetData(outputVector, 0));
+  appendChunks(bander.getEdges(), vtkPolyData::GetData(outputVector, 1));
+
+  return 1;
+}
+
+//------------------------------------------------------------------------------
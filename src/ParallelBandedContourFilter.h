@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PARALLELBANDEDCONTOURFILTER_H
+#define PARALLELBANDEDCONTOURFILTER_H
+
+#include <vtkBandedPolyDataContourFilter.h>
+
+// Drop-in vtkBandedPolyDataContourFilter that splits large inputs in spatial
+// slabs, bands every slab concurrently with vtkSMPTools and appends the slab
+// results into the two usual outputs (bands and contour edges). Inputs below
+// GetMinNofCellsPerChunk() cells, or without point scalars, are banded by
+// the superclass as before, and so is every input when VTK is built with the
+// Sequential vtkSMPTools backend (the default), which runs slabs serially.
+class ParallelBandedContourFilter : public vtkBandedPolyDataContourFilter
+{
+public:
+  static ParallelBandedContourFilter* New();
+  vtkTypeMacro(ParallelBandedContourFilter, vtkBandedPolyDataContourFilter);
+
+  static vtkIdType GetMinNofCellsPerChunk();
+  static void SetMinNofCellsPerChunk(vtkIdType nofCells);
+
+protected:
+  ParallelBandedContourFilter();
+  ~ParallelBandedContourFilter();
+
+  int RequestData(
+    vtkInformation* request,
+    vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) VTK_OVERRIDE;
+
+  int computeNofChunks(vtkIdType nofCells) const;
+
+  static vtkIdType s_minNofCellsPerChunk;
+
+private:
+  ParallelBandedContourFilter(const ParallelBandedContourFilter&) = delete;
+  void operator=(const ParallelBandedContourFilter&) = delete;
+};
+
+#endif // PARALLELBANDEDCONTOURFILTER_H
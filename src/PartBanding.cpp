@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PartBanding.h"
+
+#include "LODProxySet.h"
+#include "ParallelBandedContourFilter.h"
+#include "Tracer.h"
+
+#include <vtkAlgorithmOutput.h>
+#include <vtkAssignAttribute.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkPolyData.h>
+
+//------------------------------------------------------------------------------
+
+PartBanding::PartBanding(
+  vtkAlgorithmOutput* surface,
+  const QString& datasetName,
+  int association,
+  int nofBands)
+  :
+  m_assigner(vtkSmartPointer<vtkAssignAttribute>::New()),
+  m_contours(vtkSmartPointer<ParallelBandedContourFilter>::New()),
+  m_lod(new LODProxySet()),
+  m_nofBands(nofBands),
+  m_range{0.0, 0.0}
+{
+  m_assigner->SetInputConnection(surface);
+  m_assigner->Assign(
+    datasetName.toLatin1().constData(),
+    vtkDataSetAttributes::SCALARS,
+    association);
+
+  m_contours->SetInputConnection(m_assigner->GetOutputPort());
+  m_contours->ClippingOff();
+  m_contours->SetClipTolerance(0.0);
+  m_contours->SetScalarModeToValue();
+  m_contours->GenerateContourEdgesOn();
+
+  // Proxies of the bands keep the band value of every cell
+  m_lod->setCopyCellData(true);
+}
+
+//------------------------------------------------------------------------------
+
+PartBanding::~PartBanding()
+{
+}
+
+//------------------------------------------------------------------------------
+
+vtkAlgorithmOutput* PartBanding::getBandsPort()
+{
+  return m_contours->GetOutputPort(0);
+}
+
+//------------------------------------------------------------------------------
+
+vtkAlgorithmOutput* PartBanding::getEdgesPort()
+{
+  return m_contours->GetOutputPort(1);
+}
+
+//------------------------------------------------------------------------------
+
+vtkPolyData* PartBanding::getBandsData()
+{
+  return m_contours->GetOutput();
+}
+
+//------------------------------------------------------------------------------
+
+int PartBanding::getNofBands() const
+{
+  return m_nofBands;
+}
+
+//------------------------------------------------------------------------------
+
+const double* PartBanding::getRange() const
+{
+  return m_range;
+}
+
+//------------------------------------------------------------------------------
+
+void PartBanding::setRange(const double range[2])
+{
+  // GenerateValues() always marks the filter modified, every representation
+  // sharing the bands calls this with the same registry range
+  if( (m_contours->GetNumberOfContours() == m_nofBands) &&
+      (m_range[0] == range[0]) &&
+      (m_range[1] == range[1]) )
+  {
+    return;
+  }
+
+  m_range[0] = range[0];
+  m_range[1] = range[1];
+
+  m_contours->GenerateValues(m_nofBands, range[0], range[1]);
+}
+
+//------------------------------------------------------------------------------
+
+void PartBanding::update()
+{
+  TRACE_SCOPE("PartBanding::update");
+
+  m_contours->Update();
+}
+
+//------------------------------------------------------------------------------
+
+LODProxySet* PartBanding::getLOD()
+{
+  return m_lod.get();
+}
+
+//------------------------------------------------------------------------------
+
+qint64 PartBanding::getMemorySize() const
+{
+  // The contour filter makes new points, nothing is shared with the surface
+  qint64 kiBytes = 0;
+
+  for( int port = 0; port < m_contours->GetNumberOfOutputPorts(); ++port )
+  {
+    if( vtkDataObject* output = m_contours->GetOutputDataObject(port) )
+    {
+      kiBytes += output->GetActualMemorySize();
+    }
+  }
+
+  return kiBytes * 1024 + m_lod->getMemorySize();
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PARTBANDING_H
+#define PARTBANDING_H
+
+#include <QString>
+
+#include <vtkSmartPointer.h>
+
+#include <memory>
+
+class vtkAlgorithmOutput;
+class vtkAssignAttribute;
+class vtkPolyData;
+
+class LODProxySet;
+class ParallelBandedContourFilter;
+
+// Bands of a part surface for one dataset and number of bands, with their
+// contour edges and LOD proxies. GeometryPart hands the same instance to
+// every representation asking for the same settings, whatever plot it
+// belongs to, so this data exists once per part and not once per plot.
+class PartBanding
+{
+public:
+  PartBanding(
+    vtkAlgorithmOutput* surface,
+    const QString& datasetName,
+    int association,
+    int nofBands);
+  ~PartBanding();
+
+  vtkAlgorithmOutput* getBandsPort();
+  vtkAlgorithmOutput* getEdgesPort();
+  vtkPolyData* getBandsData();
+
+  int getNofBands() const;
+  const double* getRange() const;
+  void setRange(const double range[2]);
+
+  // Executes the filters, see GeometryPartRepresentation::updatePipeline()
+  void update();
+
+  LODProxySet* getLOD();
+
+  // Bytes of the bands, edges and proxies
+  qint64 getMemorySize() const;
+
+protected:
+  vtkSmartPointer<vtkAssignAttribute>          m_assigner;
+  vtkSmartPointer<ParallelBandedContourFilter> m_contours;
+  std::unique_ptr<LODProxySet>                 m_lod;
+
+  int    m_nofBands;
+  double m_range[2];
+};
+
+#endif // PARTBANDING_H
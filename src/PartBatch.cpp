@@ -0,0 +1,311 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PartBatch.h"
+
+#include "Tracer.h"
+
+#include <vtkActor.h>
+#include <vtkCompositeDataDisplayAttributes.h>
+#include <vtkCompositePolyDataMapper2.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+int       s_minNofParts  = 256;
+vtkIdType s_maxPartCells = 20000;
+int       s_chunkSize    = 256;
+
+// The blocks are leaves right under the root, which has flat index 0
+unsigned int flatIndex(int block)
+{
+  return static_cast<unsigned int>(block) + 1;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+PartBatch::PartBatch(vtkRenderer* ren)
+  :
+  m_renderer(ren),
+  m_chunkSize(s_chunkSize),
+  m_scalarRange{0.0, 1.0}
+{
+}
+
+//------------------------------------------------------------------------------
+
+PartBatch::~PartBatch()
+{
+  if( !m_renderer )
+  {
+    return;
+  }
+
+  for( auto& chunk : m_chunks )
+  {
+    for( int layer = 0; layer < NOF_LAYERS; ++layer )
+    {
+      m_renderer->RemoveActor(chunk->m_actors[layer]);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+int PartBatch::GetMinNofParts()
+{
+  return s_minNofParts;
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::SetMinNofParts(int nofParts)
+{
+  s_minNofParts = std::max(nofParts, 0);
+}
+
+//------------------------------------------------------------------------------
+
+vtkIdType PartBatch::GetMaxPartCells()
+{
+  return s_maxPartCells;
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::SetMaxPartCells(vtkIdType nofCells)
+{
+  s_maxPartCells = std::max<vtkIdType>(nofCells, 0);
+}
+
+//------------------------------------------------------------------------------
+
+int PartBatch::GetChunkSize()
+{
+  return s_chunkSize;
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::SetChunkSize(int nofParts)
+{
+  s_chunkSize = std::max(nofParts, 1);
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::SetupFromEnvironment()
+{
+  bool ok = false;
+  const int nofParts = qgetenv("QTVTK_BATCH_PARTS").toInt(&ok);
+
+  if( ok )
+  {
+    SetMinNofParts(nofParts);
+  }
+
+  const vtkIdType nofCells =
+    qgetenv("QTVTK_BATCH_PART_CELLS").toLongLong(&ok);
+
+  if( ok )
+  {
+    SetMaxPartCells(nofCells);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+PartBatch::Chunk& PartBatch::getChunk(int part)
+{
+  const size_t index = static_cast<size_t>(part / m_chunkSize);
+
+  if( index >= m_chunks.size() )
+  {
+    m_chunks.resize(index + 1);
+  }
+
+  std::unique_ptr<Chunk>& chunk = m_chunks[index];
+
+  if( chunk )
+  {
+    return *chunk;
+  }
+
+  TRACE_SCOPE("PartBatch::getChunk");
+
+  chunk.reset(new Chunk());
+
+  for( int layer = 0; layer < NOF_LAYERS; ++layer )
+  {
+    chunk->m_blocks[layer]     = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+    chunk->m_attributes[layer] =
+      vtkSmartPointer<vtkCompositeDataDisplayAttributes>::New();
+    chunk->m_mappers[layer]    =
+      vtkSmartPointer<vtkCompositePolyDataMapper2>::New();
+    chunk->m_actors[layer]     = vtkSmartPointer<vtkActor>::New();
+
+    chunk->m_blocks[layer]->SetNumberOfBlocks(m_chunkSize);
+
+    chunk->m_colors[layer].resize(m_chunkSize);
+    chunk->m_visible[layer].assign(m_chunkSize, false);
+    chunk->m_nofVisible[layer] = 0;
+
+    // Blocks without attribute inherit the visibility of the root
+    chunk->m_attributes[layer]->SetBlockVisibility(0, false);
+
+    vtkCompositePolyDataMapper2* mapper = chunk->m_mappers[layer];
+    mapper->SetInputDataObject(chunk->m_blocks[layer]);
+    mapper->SetCompositeDataDisplayAttributes(chunk->m_attributes[layer]);
+
+    chunk->m_actors[layer]->SetMapper(mapper);
+    chunk->m_actors[layer]->VisibilityOff();
+
+    if( m_renderer )
+    {
+      m_renderer->AddActor(chunk->m_actors[layer]);
+    }
+  }
+
+  // Same mapper settings as the per part actors
+  chunk->m_mappers[DATASET]->SetScalarModeToUseCellData();
+  chunk->m_mappers[DATASET]->SetScalarRange(m_scalarRange);
+  chunk->m_mappers[DATASET_LINES]->ScalarVisibilityOff();
+
+  return *chunk;
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::setBlockData(int part, Layer layer, vtkPolyData* data)
+{
+  Chunk& chunk = getChunk(part);
+  const int block = part % m_chunkSize;
+
+  if( chunk.m_blocks[layer]->GetBlock(block) == data )
+  {
+    return;
+  }
+
+  // Only the buffers of this chunk are rebuilt on the next render
+  chunk.m_blocks[layer]->SetBlock(block, data);
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::setBlockVisibility(int part, Layer layer, bool visible)
+{
+  Chunk& chunk = getChunk(part);
+  const int block = part % m_chunkSize;
+
+  if( chunk.m_visible[layer][block] == visible )
+  {
+    return;
+  }
+
+  chunk.m_visible[layer][block] = visible;
+  chunk.m_nofVisible[layer] += visible? 1 : -1;
+
+  chunk.m_attributes[layer]->SetBlockVisibility(flatIndex(block), visible);
+  chunk.m_attributes[layer]->Modified();
+
+  // Chunks with every part hidden or culled are not drawn at all
+  chunk.m_actors[layer]->SetVisibility(chunk.m_nofVisible[layer] > 0);
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::setBlockColor(int part, Layer layer, const QColor& color)
+{
+  Chunk& chunk = getChunk(part);
+  const int block = part % m_chunkSize;
+
+  if( chunk.m_colors[layer][block] == color )
+  {
+    return;
+  }
+
+  chunk.m_colors[layer][block] = color;
+
+  const double rgb[3] = {color.redF(), color.greenF(), color.blueF()};
+
+  chunk.m_attributes[layer]->SetBlockColor(flatIndex(block), rgb);
+  chunk.m_attributes[layer]->Modified();
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::setScalarRange(const double range[2])
+{
+  if( (m_scalarRange[0] == range[0]) && (m_scalarRange[1] == range[1]) )
+  {
+    return;
+  }
+
+  m_scalarRange[0] = range[0];
+  m_scalarRange[1] = range[1];
+
+  for( auto& chunk : m_chunks )
+  {
+    if( chunk )
+    {
+      chunk->m_mappers[DATASET]->SetScalarRange(m_scalarRange);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartBatch::removePart(int part)
+{
+  for( int layer = 0; layer < NOF_LAYERS; ++layer )
+  {
+    setBlockVisibility(part, static_cast<Layer>(layer), false);
+    setBlockData(part, static_cast<Layer>(layer), nullptr);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+int PartBatch::getNofChunks() const
+{
+  return static_cast<int>(std::count_if(
+    m_chunks.begin(), m_chunks.end(),
+    [](const std::unique_ptr<Chunk>& chunk) { return chunk != nullptr; }));
+}
+
+//------------------------------------------------------------------------------
+
+int PartBatch::getNofActors() const
+{
+  return getNofChunks() * NOF_LAYERS;
+}
+
+//------------------------------------------------------------------------------
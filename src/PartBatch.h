@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PARTBATCH_H
+#define PARTBATCH_H
+
+#include <QColor>
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+#include <vtkWeakPointer.h>
+
+#include <memory>
+#include <vector>
+
+class vtkActor;
+class vtkCompositeDataDisplayAttributes;
+class vtkCompositePolyDataMapper2;
+class vtkMultiBlockDataSet;
+class vtkPolyData;
+class vtkRenderer;
+
+// Draws the parts of a geometry in one plot through composite mappers
+// instead of three actors per part. The parts are split into chunks of
+// GetChunkSize() blocks, every chunk has one actor per layer whose mapper
+// draws a multiblock with one block per part. Colors and visibility are
+// block attributes, so changing them touches no buffer, and replacing the
+// data of a part only rebuilds the buffers of its chunk.
+//
+// The GeometryPartRepresentation of every part keeps its state and pushes
+// it with the setters below, see GeometryPartRepresentation::setBatch().
+class PartBatch
+{
+public:
+  enum Layer
+  {
+    SOLID = 0,
+    DATASET,
+    DATASET_LINES,
+    NOF_LAYERS
+  };
+
+  explicit PartBatch(vtkRenderer* ren);
+  ~PartBatch();
+
+  // Geometries reaching this number of small parts in a plot are batched,
+  // 0 turns batching off
+  static int GetMinNofParts();
+  static void SetMinNofParts(int nofParts);
+
+  // Only parts with at most this number of cells are batched, the larger
+  // ones keep their own actors and their levels of detail
+  static vtkIdType GetMaxPartCells();
+  static void SetMaxPartCells(vtkIdType nofCells);
+
+  static int GetChunkSize();
+  static void SetChunkSize(int nofParts);
+
+  // QTVTK_BATCH_PARTS=<parts> sets the minimum number of parts,
+  // QTVTK_BATCH_PART_CELLS=<cells> the maximum size of a batched part
+  static void SetupFromEnvironment();
+
+  // All of them do nothing when the block already has the value
+  void setBlockData(int part, Layer layer, vtkPolyData* data);
+  void setBlockVisibility(int part, Layer layer, bool visible);
+  void setBlockColor(int part, Layer layer, const QColor& color);
+
+  // The dataset layer maps the band values of every block with it
+  void setScalarRange(const double range[2]);
+
+  // Empties and hides the blocks of the part
+  void removePart(int part);
+
+  int getNofChunks() const;
+  int getNofActors() const;
+
+protected:
+  struct Chunk
+  {
+    vtkSmartPointer<vtkMultiBlockDataSet>              m_blocks[NOF_LAYERS];
+    vtkSmartPointer<vtkCompositeDataDisplayAttributes> m_attributes[NOF_LAYERS];
+    vtkSmartPointer<vtkCompositePolyDataMapper2>       m_mappers[NOF_LAYERS];
+    vtkSmartPointer<vtkActor>                          m_actors[NOF_LAYERS];
+
+    std::vector<QColor> m_colors[NOF_LAYERS];
+    std::vector<bool>   m_visible[NOF_LAYERS];
+    int                 m_nofVisible[NOF_LAYERS];
+  };
+
+  Chunk& getChunk(int part);
+
+  vtkWeakPointer<vtkRenderer> m_renderer;
+  int                         m_chunkSize;
+  double                      m_scalarRange[2];
+
+  std::vector<std::unique_ptr<Chunk>> m_chunks;
+};
+
+#endif // PARTBATCH_H
@@ -0,0 +1,371 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PartCache.h"
+
+#include "GeometryPart.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <iterator>
+#include <list>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+struct CacheEntry
+{
+  std::list<GeometryPart*>::iterator m_position;
+  std::weak_ptr<GeometryPart>        m_part;
+  QThread*                           m_thread;
+  qint64                             m_bytes;
+};
+
+// Parts are tracked from their publication in a Geometry until they are
+// deleted, the front of the list is the least recently used one
+struct CacheState
+{
+  CacheState()
+    :
+    m_budget(0),
+    m_deferredLoading(false),
+    m_residentBytes(0),
+    m_nofLoads(0),
+    m_nofEvictions(0)
+  {
+  }
+
+  QMutex                              m_mutex;
+  std::list<GeometryPart*>            m_lru;
+  QHash<GeometryPart*, CacheEntry>    m_entries;
+  qint64                              m_budget;
+  bool                                m_deferredLoading;
+  qint64                              m_residentBytes;
+  int                                 m_nofLoads;
+  int                                 m_nofEvictions;
+};
+
+CacheState& getState()
+{
+  static CacheState state;
+  return state;
+}
+
+void setBytes(CacheState& state, CacheEntry& entry, qint64 bytes)
+{
+  state.m_residentBytes += bytes - entry.m_bytes;
+  entry.m_bytes = bytes;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+qint64 PartCache::GetBudget()
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+  return state.m_budget;
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::SetBudget(qint64 bytes)
+{
+  {
+    CacheState& state = getState();
+
+    QMutexLocker locker(&state.m_mutex);
+    state.m_budget = qMax(bytes, qint64(0));
+  }
+
+  EnforceBudget();
+}
+
+//------------------------------------------------------------------------------
+
+bool PartCache::IsDeferredLoading()
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+  return state.m_deferredLoading;
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::SetDeferredLoading(bool on)
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+  state.m_deferredLoading = on;
+}
+
+//------------------------------------------------------------------------------
+
+qint64 PartCache::GetResidentBytes()
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+  return state.m_residentBytes;
+}
+
+//------------------------------------------------------------------------------
+
+int PartCache::GetNofResidentParts()
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+
+  int nofParts = 0;
+
+  for( const CacheEntry& entry : state.m_entries )
+  {
+    if( entry.m_bytes > 0 )
+    {
+      ++nofParts;
+    }
+  }
+
+  return nofParts;
+}
+
+//------------------------------------------------------------------------------
+
+int PartCache::GetNofLoads()
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+  return state.m_nofLoads;
+}
+
+//------------------------------------------------------------------------------
+
+int PartCache::GetNofEvictions()
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+  return state.m_nofEvictions;
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::Add(const std::shared_ptr<GeometryPart>& part)
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+
+  if( state.m_entries.contains(part.get()) )
+  {
+    return;
+  }
+
+  CacheEntry entry;
+  entry.m_position = state.m_lru.insert(state.m_lru.end(), part.get());
+  entry.m_part     = part;
+  entry.m_thread   = QThread::currentThread();
+  entry.m_bytes    = 0;
+
+  setBytes(state, state.m_entries.insert(part.get(), entry).value(),
+    part->getMemorySize());
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::Touch(const std::vector<std::shared_ptr<GeometryPart>>& parts)
+{
+  // Sizes walk the derived data, they are taken outside of the lock
+  std::vector<qint64> sizes;
+  sizes.reserve(parts.size());
+
+  for( const std::shared_ptr<GeometryPart>& part : parts )
+  {
+    sizes.push_back(part->getMemorySize());
+  }
+
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+
+  for( size_t i = 0; i < parts.size(); ++i )
+  {
+    auto it = state.m_entries.find(parts[i].get());
+
+    if( it != state.m_entries.end() )
+    {
+      setBytes(state, *it, sizes[i]);
+      state.m_lru.splice(state.m_lru.end(), state.m_lru, it->m_position);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::Remove(GeometryPart* part)
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+
+  auto it = state.m_entries.find(part);
+
+  if( it != state.m_entries.end() )
+  {
+    state.m_residentBytes -= it->m_bytes;
+    state.m_lru.erase(it->m_position);
+    state.m_entries.erase(it);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::Loaded(GeometryPart* part)
+{
+  const qint64 bytes = part->getMemorySize();
+
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+
+  // Parts still being read by the loader are not tracked yet
+  auto it = state.m_entries.find(part);
+
+  if( it != state.m_entries.end() )
+  {
+    setBytes(state, *it, bytes);
+    state.m_lru.splice(state.m_lru.end(), state.m_lru, it->m_position);
+
+    ++state.m_nofLoads;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::Evicted(GeometryPart* part)
+{
+  CacheState& state = getState();
+
+  QMutexLocker locker(&state.m_mutex);
+
+  auto it = state.m_entries.find(part);
+
+  if( it != state.m_entries.end() )
+  {
+    setBytes(state, *it, 0);
+
+    ++state.m_nofEvictions;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::EnforceBudget()
+{
+  QCoreApplication* app = QCoreApplication::instance();
+
+  if( !app || (QThread::currentThread() != app->thread()) )
+  {
+    return;
+  }
+
+  CacheState& state = getState();
+
+  // Candidates are collected first, evicting calls back into the cache. The
+  // most recently used part is kept: it is the one being loaded or published.
+  // They are held weakly, a part deleted meanwhile is skipped.
+  std::vector<std::weak_ptr<GeometryPart>> candidates;
+
+  {
+    QMutexLocker locker(&state.m_mutex);
+
+    if( (state.m_budget <= 0) || (state.m_residentBytes <= state.m_budget) )
+    {
+      return;
+    }
+
+    for( auto it = state.m_lru.begin(); it != state.m_lru.end(); ++it )
+    {
+      if( std::next(it) == state.m_lru.end() )
+      {
+        break;
+      }
+
+      auto entry = state.m_entries.constFind(*it);
+
+      if( (entry->m_bytes > 0) && (entry->m_thread == app->thread()) )
+      {
+        candidates.push_back(entry->m_part);
+      }
+    }
+  }
+
+  for( const std::weak_ptr<GeometryPart>& candidate : candidates )
+  {
+    if( GetResidentBytes() <= GetBudget() )
+    {
+      break;
+    }
+
+    std::shared_ptr<GeometryPart> part = candidate.lock();
+
+    if( part && part->canEvict() )
+    {
+      part->evict();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartCache::SetupFromEnvironment()
+{
+  bool ok = false;
+  const double budgetMB = qgetenv("QTVTK_PART_BUDGET").toDouble(&ok);
+
+  if( ok && (budgetMB > 0.0) )
+  {
+    SetBudget(static_cast<qint64>(budgetMB * 1024.0 * 1024.0));
+  }
+
+  const QByteArray deferred = qgetenv("QTVTK_DEFERRED_PARTS");
+
+  if( !deferred.isEmpty() && (deferred != "0") )
+  {
+    SetDeferredLoading(true);
+  }
+}
+
+//------------------------------------------------------------------------------
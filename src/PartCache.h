@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PARTCACHE_H
+#define PARTCACHE_H
+
+#include <QtGlobal>
+
+#include <memory>
+#include <vector>
+
+class GeometryPart;
+
+// Keeps the data of the parts that can be read again from their file (see
+// GeometryPart::setDataSource) under a memory budget. The least recently
+// used parts without representation are evicted when a part is loaded or
+// published over the budget, only their ranges and bounds stay resident.
+class PartCache
+{
+public:
+  // Bytes, 0 is no limit
+  static qint64 GetBudget();
+  static void SetBudget(qint64 bytes);
+
+  // Parts read from files are published without data, it is read when the
+  // first representation of the part is created
+  static bool IsDeferredLoading();
+  static void SetDeferredLoading(bool on);
+
+  static qint64 GetResidentBytes();
+  static int GetNofResidentParts();
+  static int GetNofLoads();
+  static int GetNofEvictions();
+
+  // Bookkeeping of Geometry and GeometryPart, parts are tracked from their
+  // publication in a Geometry and belong to the thread publishing them
+  static void Add(const std::shared_ptr<GeometryPart>& part);
+  static void Remove(GeometryPart* part);
+  static void Loaded(GeometryPart* part);
+  static void Evicted(GeometryPart* part);
+
+  // Marks the parts as the most recently used ones and updates their bytes,
+  // which grow with their bandings, proxies and locator. Called once per
+  // batch of representation updates, not from the part accessors.
+  static void Touch(const std::vector<std::shared_ptr<GeometryPart>>& parts);
+
+  // Only runs in the GUI thread and only evicts parts published by it, parts
+  // of other threads (see BatchRenderer) may be executing their pipelines
+  static void EnforceBudget();
+
+  // QTVTK_PART_BUDGET=<MB> sets the budget, QTVTK_DEFERRED_PARTS=1 turns on
+  // the deferred loading
+  static void SetupFromEnvironment();
+};
+
+#endif // PARTCACHE_H
@@ -0,0 +1,445 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PartHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+// Parts per leaf
+const int LeafSize = 4;
+
+enum Classification
+{
+  OUTSIDE,
+  CROSSING,
+  INSIDE
+};
+
+Classification classify(
+  const double bounds[6],
+  const PartHierarchy::ViewVolume& volume)
+{
+  Classification result = INSIDE;
+
+  for( int p = 0; p < 4; ++p )
+  {
+    const double* plane = volume.m_planes + 4 * p;
+
+    // Corners of the box farthest along and against the plane normal
+    double farthest = plane[3];
+    double nearest  = plane[3];
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+      const double lo = plane[axis] * bounds[2*axis];
+      const double hi = plane[axis] * bounds[2*axis + 1];
+
+      farthest += std::max(lo, hi);
+      nearest  += std::min(lo, hi);
+    }
+
+    if( farthest < 0.0 )
+    {
+      return OUTSIDE;
+    }
+
+    if( nearest < 0.0 )
+    {
+      result = CROSSING;
+    }
+  }
+
+  return result;
+}
+
+bool isTooSmall(const double bounds[6], const PartHierarchy::ViewVolume& volume)
+{
+  if( volume.m_minPixels <= 0.0 )
+  {
+    return false;
+  }
+
+  double diagonal2 = 0.0;
+  double distance2 = 0.0;
+
+  for( int axis = 0; axis < 3; ++axis )
+  {
+    const double lo = bounds[2*axis];
+    const double hi = bounds[2*axis + 1];
+    const double eye = volume.m_eye[axis];
+
+    diagonal2 += (hi - lo) * (hi - lo);
+
+    // Distance to the nearest point of the box, the children of a box are
+    // never closer, so the test is conservative for the whole subtree
+    const double d = (eye < lo)? lo - eye : ((eye > hi)? eye - hi : 0.0);
+    distance2 += d * d;
+  }
+
+  double pixels = std::sqrt(diagonal2) * volume.m_pixelsPerUnit;
+
+  if( !volume.m_parallel )
+  {
+    if( distance2 <= 0.0 )
+    {
+      return false;
+    }
+
+    pixels /= std::sqrt(distance2);
+  }
+
+  return pixels < volume.m_minPixels;
+}
+
+// Slab test of the segment against the box, t is where the segment enters it
+bool intersectRay(
+  const double bounds[6],
+  const double origin[3],
+  const double direction[3],
+  double& t)
+{
+  double tMin = 0.0;
+  double tMax = 1.0;
+
+  for( int axis = 0; axis < 3; ++axis )
+  {
+    const double lo = bounds[2*axis];
+    const double hi = bounds[2*axis + 1];
+
+    if( direction[axis] == 0.0 )
+    {
+      if( (origin[axis] < lo) || (origin[axis] > hi) )
+      {
+        return false;
+      }
+
+      continue;
+    }
+
+    double t0 = (lo - origin[axis]) / direction[axis];
+    double t1 = (hi - origin[axis]) / direction[axis];
+
+    if( t0 > t1 )
+    {
+      std::swap(t0, t1);
+    }
+
+    tMin = std::max(tMin, t0);
+    tMax = std::min(tMax, t1);
+
+    if( tMin > tMax )
+    {
+      return false;
+    }
+  }
+
+  t = tMin;
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+PartHierarchy::ViewVolume::ViewVolume()
+  :
+  m_planes{0.0},
+  m_eye{0.0, 0.0, 0.0},
+  m_parallel(false),
+  m_pixelsPerUnit(1.0),
+  m_minPixels(0.0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+PartHierarchy::PartHierarchy()
+  :
+  m_nofParts(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+void PartHierarchy::build(const std::vector<double>& bounds)
+{
+  clear();
+
+  m_nofParts   = static_cast<int>(bounds.size() / 6);
+  m_partBounds = bounds;
+
+  for( int i = 0; i < m_nofParts; ++i )
+  {
+    const double* partBounds = &bounds[6*i];
+
+    if( (partBounds[0] <= partBounds[1]) &&
+        (partBounds[2] <= partBounds[3]) &&
+        (partBounds[4] <= partBounds[5]) )
+    {
+      m_partIds.push_back(i);
+    }
+  }
+
+  if( m_partIds.empty() )
+  {
+    return;
+  }
+
+  // A binary tree with leaves of up to LeafSize parts
+  m_nodes.reserve(2 * (m_partIds.size() / LeafSize + 1));
+  m_nodes.resize(1);
+
+  buildNode(0, 0, static_cast<int>(m_partIds.size()));
+}
+
+//------------------------------------------------------------------------------
+
+void PartHierarchy::clear()
+{
+  m_nodes.clear();
+  m_partIds.clear();
+  m_partBounds.clear();
+  m_nofParts = 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool PartHierarchy::isEmpty() const
+{
+  return m_nodes.empty();
+}
+
+//------------------------------------------------------------------------------
+
+int PartHierarchy::getNofParts() const
+{
+  return m_nofParts;
+}
+
+//------------------------------------------------------------------------------
+
+int PartHierarchy::getNofNodes() const
+{
+  return static_cast<int>(m_nodes.size());
+}
+
+//------------------------------------------------------------------------------
+
+void PartHierarchy::findVisible(
+  const ViewVolume& volume,
+  std::vector<int>& parts) const
+{
+  parts.clear();
+
+  if( !m_nodes.empty() )
+  {
+    visit(0, volume, false, parts);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartHierarchy::findAlongRay(
+  const double origin[3],
+  const double direction[3],
+  std::vector<RayHit>& hits) const
+{
+  hits.clear();
+
+  if( m_nodes.empty() )
+  {
+    return;
+  }
+
+  visitRay(0, origin, direction, hits);
+
+  std::sort(hits.begin(), hits.end(),
+    [](const RayHit& a, const RayHit& b)
+    {
+      return a.m_t < b.m_t;
+    });
+}
+
+//------------------------------------------------------------------------------
+
+void PartHierarchy::buildNode(int nodeId, int begin, int end)
+{
+  double bounds[6];
+  double centerBounds[6];
+
+  for( int i = begin; i < end; ++i )
+  {
+    const double* partBounds = &m_partBounds[6 * m_partIds[i]];
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+      const double lo = partBounds[2*axis];
+      const double hi = partBounds[2*axis + 1];
+      const double center = 0.5 * (lo + hi);
+
+      bounds[2*axis]           =
+        (i == begin)? lo : std::min(bounds[2*axis], lo);
+      bounds[2*axis + 1]       =
+        (i == begin)? hi : std::max(bounds[2*axis + 1], hi);
+      centerBounds[2*axis]     =
+        (i == begin)? center : std::min(centerBounds[2*axis], center);
+      centerBounds[2*axis + 1] =
+        (i == begin)? center : std::max(centerBounds[2*axis + 1], center);
+    }
+  }
+
+  std::copy(bounds, bounds + 6, m_nodes[nodeId].m_bounds);
+
+  if( end - begin <= LeafSize )
+  {
+    m_nodes[nodeId].m_first = begin;
+    m_nodes[nodeId].m_count = end - begin;
+    return;
+  }
+
+  int splitAxis = 0;
+
+  for( int axis = 1; axis < 3; ++axis )
+  {
+    if( centerBounds[2*axis + 1] - centerBounds[2*axis] >
+        centerBounds[2*splitAxis + 1] - centerBounds[2*splitAxis] )
+    {
+      splitAxis = axis;
+    }
+  }
+
+  const int middle = (begin + end) / 2;
+  const std::vector<double>& partBounds = m_partBounds;
+
+  std::nth_element(
+    m_partIds.begin() + begin,
+    m_partIds.begin() + middle,
+    m_partIds.begin() + end,
+    [&partBounds, splitAxis](int a, int b)
+    {
+      return partBounds[6*a + 2*splitAxis] + partBounds[6*a + 2*splitAxis + 1] <
+             partBounds[6*b + 2*splitAxis] + partBounds[6*b + 2*splitAxis + 1];
+    });
+
+  // The children are next to each other, the vector may grow meanwhile
+  const int firstChild = static_cast<int>(m_nodes.size());
+  m_nodes.resize(firstChild + 2);
+
+  m_nodes[nodeId].m_first = firstChild;
+  m_nodes[nodeId].m_count = 0;
+
+  buildNode(firstChild, begin, middle);
+  buildNode(firstChild + 1, middle, end);
+}
+
+//------------------------------------------------------------------------------
+
+void PartHierarchy::visit(
+  int nodeId,
+  const ViewVolume& volume,
+  bool inside,
+  std::vector<int>& parts) const
+{
+  const Node& node = m_nodes[nodeId];
+
+  if( !inside )
+  {
+    const Classification classification = classify(node.m_bounds, volume);
+
+    if( classification == OUTSIDE )
+    {
+      return;
+    }
+
+    inside = (classification == INSIDE);
+  }
+
+  if( isTooSmall(node.m_bounds, volume) )
+  {
+    return;
+  }
+
+  if( node.m_count == 0 )
+  {
+    visit(node.m_first, volume, inside, parts);
+    visit(node.m_first + 1, volume, inside, parts);
+    return;
+  }
+
+  for( int i = node.m_first; i < node.m_first + node.m_count; ++i )
+  {
+    const int     partId     = m_partIds[i];
+    const double* partBounds = &m_partBounds[6 * partId];
+
+    if( (inside || (classify(partBounds, volume) != OUTSIDE)) &&
+        !isTooSmall(partBounds, volume) )
+    {
+      parts.push_back(partId);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PartHierarchy::visitRay(
+  int nodeId,
+  const double origin[3],
+  const double direction[3],
+  std::vector<RayHit>& hits) const
+{
+  const Node& node = m_nodes[nodeId];
+  double t = 0.0;
+
+  if( !intersectRay(node.m_bounds, origin, direction, t) )
+  {
+    return;
+  }
+
+  if( node.m_count == 0 )
+  {
+    visitRay(node.m_first, origin, direction, hits);
+    visitRay(node.m_first + 1, origin, direction, hits);
+    return;
+  }
+
+  for( int i = node.m_first; i < node.m_first + node.m_count; ++i )
+  {
+    const int partId = m_partIds[i];
+
+    if( intersectRay(&m_partBounds[6 * partId], origin, direction, t) )
+    {
+      RayHit hit;
+      hit.m_part = partId;
+      hit.m_t    = t;
+
+      hits.push_back(hit);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PARTHIERARCHY_H
+#define PARTHIERARCHY_H
+
+#include <vector>
+
+// Bounding volume hierarchy over the bounds of the parts of a geometry. The
+// parts are split at the median of their centers along the longest axis
+// until a few are left per leaf. A view query descends only the boxes that
+// cross the view frustum, boxes fully inside it are taken without further
+// plane tests. A ray query descends only the boxes the ray enters.
+class PartHierarchy
+{
+public:
+  struct ViewVolume
+  {
+    ViewVolume();
+
+    // Left, right, bottom and top planes of the frustum (a, b, c, d), the
+    // inside is positive (see vtkCamera::GetFrustumPlanes)
+    double m_planes[16];
+    double m_eye[3];
+    bool   m_parallel;
+    // Pixels of one world unit at unit distance, or at any distance with a
+    // parallel projection
+    double m_pixelsPerUnit;
+    // Boxes projecting smaller than this are left out, 0 keeps them all
+    double m_minPixels;
+  };
+
+  struct RayHit
+  {
+    int    m_part;
+    // Where the ray enters the part bounds, from 0 at the origin to 1 at
+    // origin + direction
+    double m_t;
+  };
+
+  PartHierarchy();
+
+  // Bounds of every part, 6 values per part. Parts with empty bounds are
+  // never visible.
+  void build(const std::vector<double>& bounds);
+  void clear();
+
+  bool isEmpty() const;
+  int getNofParts() const;
+  int getNofNodes() const;
+
+  // Indices of the parts at least partly inside the view volume
+  void findVisible(const ViewVolume& volume, std::vector<int>& parts) const;
+
+  // Parts whose bounds the segment from origin to origin + direction
+  // crosses, nearest entry first
+  void findAlongRay(
+    const double origin[3],
+    const double direction[3],
+    std::vector<RayHit>& hits) const;
+
+protected:
+  struct Node
+  {
+    double m_bounds[6];
+    // Leaves list m_count parts from m_first in m_partIds, inner nodes have
+    // their children at m_first and m_first + 1
+    int    m_first;
+    int    m_count;
+  };
+
+  void buildNode(int nodeId, int begin, int end);
+  void visit(
+    int nodeId,
+    const ViewVolume& volume,
+    bool inside,
+    std::vector<int>& parts) const;
+  void visitRay(
+    int nodeId,
+    const double origin[3],
+    const double direction[3],
+    std::vector<RayHit>& hits) const;
+
+  std::vector<Node>   m_nodes;
+  std::vector<int>    m_partIds;
+  std::vector<double> m_partBounds;
+  int                 m_nofParts;
+};
+
+#endif // PARTHIERARCHY_H
@@ -0,0 +1,431 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PartLocator.h"
+
+#include "Tracer.h"
+
+#include <QtConcurrentRun>
+
+#include <vtkCell.h>
+#include <vtkCellData.h>
+#include <vtkCellTreeLocator.h>
+#include <vtkDataArray.h>
+#include <vtkDataSet.h>
+#include <vtkGenericCell.h>
+#include <vtkIdList.h>
+#include <vtkPointData.h>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+
+int PartLocator::s_cellsPerBucket = 8;
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+void fillCell(vtkGenericCell* cell, const double* weights, ProbeResult& result)
+{
+  vtkIdList* pointIds = cell->GetPointIds();
+  const vtkIdType nofPoints = pointIds->GetNumberOfIds();
+
+  result.m_pointIds.assign(
+    pointIds->GetPointer(0),
+    pointIds->GetPointer(0) + nofPoints);
+  result.m_weights.assign(weights, weights + nofPoints);
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+ProbeResult::ProbeResult()
+  :
+  m_cellId(-1),
+  m_position{0.0, 0.0, 0.0},
+  m_t(0.0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool ProbeResult::isValid() const
+{
+  return m_cellId >= 0;
+}
+
+//------------------------------------------------------------------------------
+
+PartLocator::PartLocator(QObject* parent)
+  :
+  QObject(parent),
+  m_tolerance(0.0)
+{
+  connect(&m_watcher, SIGNAL(finished()), this, SLOT(locatorBuilt()));
+}
+
+//------------------------------------------------------------------------------
+
+PartLocator::~PartLocator()
+{
+  // The task only holds its own shallow copy of the source, nothing to wait
+}
+
+//------------------------------------------------------------------------------
+
+int PartLocator::GetCellsPerBucket()
+{
+  return s_cellsPerBucket;
+}
+
+//------------------------------------------------------------------------------
+
+void PartLocator::SetCellsPerBucket(int nofCells)
+{
+  s_cellsPerBucket = std::max(nofCells, 1);
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkCellTreeLocator> PartLocator::Build(
+  vtkSmartPointer<vtkDataSet> source,
+  int cellsPerBucket)
+{
+  TRACE_SCOPE("PartLocator::Build");
+
+  vtkSmartPointer<vtkCellTreeLocator> locator =
+    vtkSmartPointer<vtkCellTreeLocator>::New();
+
+  locator->SetDataSet(source);
+  locator->SetNumberOfCellsPerNode(cellsPerBucket);
+  locator->BuildLocator();
+
+  return locator;
+}
+
+//------------------------------------------------------------------------------
+
+bool PartLocator::FindCell(
+  vtkCellTreeLocator* tree,
+  double tolerance,
+  const double point[3],
+  ProbeResult& result)
+{
+  result = ProbeResult();
+
+  if( !tree )
+  {
+    return false;
+  }
+
+  double position[3] = {point[0], point[1], point[2]};
+  double pcoords[3];
+  double weights[VTK_CELL_SIZE];
+
+  vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
+
+  const vtkIdType cellId = tree->FindCell(
+    position,
+    tolerance * tolerance,
+    cell,
+    pcoords,
+    weights);
+
+  if( cellId < 0 )
+  {
+    return false;
+  }
+
+  result.m_cellId = cellId;
+  std::copy(position, position + 3, result.m_position);
+  fillCell(cell, weights, result);
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool PartLocator::Interpolate(
+  vtkDataSet* data,
+  const ProbeResult& result,
+  const char* arrayName,
+  DatasetRegistry::Association association,
+  std::vector<double>& values)
+{
+  values.clear();
+
+  if( !data || !result.isValid() )
+  {
+    return false;
+  }
+
+  if( association == DatasetRegistry::CELL_DATA )
+  {
+    vtkDataArray* arr = data->GetCellData()->GetArray(arrayName);
+
+    if( !arr || (result.m_cellId >= arr->GetNumberOfTuples()) )
+    {
+      return false;
+    }
+
+    values.resize(arr->GetNumberOfComponents());
+
+    for( size_t c = 0; c < values.size(); ++c )
+    {
+      values[c] = arr->GetComponent(result.m_cellId, static_cast<int>(c));
+    }
+
+    return true;
+  }
+
+  vtkDataArray* arr = data->GetPointData()->GetArray(arrayName);
+
+  if( !arr )
+  {
+    return false;
+  }
+
+  values.assign(arr->GetNumberOfComponents(), 0.0);
+
+  for( size_t i = 0; i < result.m_pointIds.size(); ++i )
+  {
+    const vtkIdType pointId = result.m_pointIds[i];
+
+    if( pointId >= arr->GetNumberOfTuples() )
+    {
+      values.clear();
+      return false;
+    }
+
+    for( size_t c = 0; c < values.size(); ++c )
+    {
+      values[c] += result.m_weights[i] *
+        arr->GetComponent(pointId, static_cast<int>(c));
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+void PartLocator::update(vtkDataSet* source)
+{
+  if( !source || (source->GetNumberOfCells() == 0) )
+  {
+    clear();
+    return;
+  }
+
+  if( m_watcher.isRunning() )
+  {
+    // Only the latest source matters, it is built when the current task ends
+    m_queuedSource.TakeReference(source->NewInstance());
+    m_queuedSource->ShallowCopy(source);
+    return;
+  }
+
+  startBuild(source);
+}
+
+//------------------------------------------------------------------------------
+
+void PartLocator::clear()
+{
+  m_locator      = nullptr;
+  m_data         = nullptr;
+  m_buildData    = nullptr;
+  m_queuedSource = nullptr;
+  m_tolerance    = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+qint64 PartLocator::getMemorySize() const
+{
+  if( !m_locator || !m_data )
+  {
+    return 0;
+  }
+
+  // vtkCellTreeLocator does not report its size: one leaf entry per cell,
+  // two nodes per bucket, and the bounds of every cell when they are cached
+  const qint64 nofCells   = m_data->GetNumberOfCells();
+  const qint64 nofBuckets =
+    nofCells / std::max(m_locator->GetNumberOfCellsPerNode(), 1) + 1;
+
+  qint64 bytes = nofCells * sizeof(unsigned int) + 2 * nofBuckets * 16;
+
+  if( m_locator->GetCacheCellBounds() )
+  {
+    bytes += nofCells * 6 * sizeof(double);
+  }
+
+  return bytes;
+}
+
+//------------------------------------------------------------------------------
+
+bool PartLocator::isReady() const
+{
+  return m_locator != nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+bool PartLocator::isBuilding() const
+{
+  return m_buildData != nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+vtkDataSet* PartLocator::getData() const
+{
+  return m_data;
+}
+
+//------------------------------------------------------------------------------
+
+vtkCellTreeLocator* PartLocator::getTree() const
+{
+  return m_locator;
+}
+
+//------------------------------------------------------------------------------
+
+double PartLocator::getTolerance() const
+{
+  return m_tolerance;
+}
+
+//------------------------------------------------------------------------------
+
+bool PartLocator::findCell(const double point[3], ProbeResult& result) const
+{
+  return FindCell(m_locator, m_tolerance, point, result);
+}
+
+//------------------------------------------------------------------------------
+
+bool PartLocator::intersectRay(
+  const double p0[3],
+  const double p1[3],
+  ProbeResult& result) const
+{
+  result = ProbeResult();
+
+  if( !m_locator )
+  {
+    return false;
+  }
+
+  double a0[3] = {p0[0], p0[1], p0[2]};
+  double a1[3] = {p1[0], p1[1], p1[2]};
+  double t = 0.0;
+  double x[3];
+  double pcoords[3];
+  int    subId = 0;
+  vtkIdType cellId = -1;
+
+  vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
+
+  if( !m_locator->IntersectWithLine(
+        a0, a1, m_tolerance, t, x, pcoords, subId, cellId, cell) ||
+      (cellId < 0) )
+  {
+    return false;
+  }
+
+  // The intersection only gives the parametric coordinates
+  double location[3];
+  double weights[VTK_CELL_SIZE];
+  cell->EvaluateLocation(subId, pcoords, location, weights);
+
+  result.m_cellId = cellId;
+  result.m_t      = t;
+  std::copy(x, x + 3, result.m_position);
+  fillCell(cell, weights, result);
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool PartLocator::interpolate(
+  const ProbeResult& result,
+  const char* arrayName,
+  DatasetRegistry::Association association,
+  std::vector<double>& values) const
+{
+  return Interpolate(m_data, result, arrayName, association, values);
+}
+
+//------------------------------------------------------------------------------
+
+void PartLocator::startBuild(vtkDataSet* source)
+{
+  // The part keeps producing new outputs in the GUI thread, the task works
+  // on its own shallow copy
+  m_buildData.TakeReference(source->NewInstance());
+  m_buildData->ShallowCopy(source);
+
+  m_watcher.setFuture(QtConcurrent::run(
+    &PartLocator::Build,
+    m_buildData,
+    s_cellsPerBucket));
+}
+
+//------------------------------------------------------------------------------
+
+void PartLocator::locatorBuilt()
+{
+  if( m_queuedSource )
+  {
+    // The result is already outdated, build the latest source instead
+    vtkSmartPointer<vtkDataSet> source = m_queuedSource;
+    m_queuedSource = nullptr;
+
+    startBuild(source);
+    return;
+  }
+
+  // Cleared while it was being built
+  if( !m_buildData )
+  {
+    return;
+  }
+
+  m_locator = m_watcher.result();
+  m_data    = m_buildData;
+  m_buildData = nullptr;
+
+  // Relative to the size of the part, like the pickers do
+  m_tolerance = 1.0e-6 * m_data->GetLength();
+
+  emit ready();
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,143 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PARTLOCATOR_H
+#define PARTLOCATOR_H
+
+#include "DatasetRegistry.h"
+
+#include <QFutureWatcher>
+#include <QObject>
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <vector>
+
+class vtkCellTreeLocator;
+class vtkDataSet;
+
+// Cell found by a probe, the weights interpolate the point data of the cell
+// at the probed position
+struct ProbeResult
+{
+  ProbeResult();
+
+  bool isValid() const;
+
+  vtkIdType              m_cellId;
+  double                 m_position[3];
+  // Ray parameter of the hit, 0 at the start and 1 at the end of the ray
+  double                 m_t;
+  std::vector<vtkIdType> m_pointIds;
+  std::vector<double>    m_weights;
+};
+
+// Static cell tree of a part, built on a worker thread from a shallow copy of
+// its data. Point and ray queries descend the tree in logarithmic time and
+// keep being answered by the previous tree while a new one is built, so a
+// probe per mouse move never waits for a build. Must be used from the GUI
+// thread, see GeometryPart::getLocator.
+class PartLocator : public QObject
+{
+  Q_OBJECT
+public:
+  explicit PartLocator(QObject* parent = 0);
+  virtual ~PartLocator();
+
+  // Cells per leaf of the tree
+  static int GetCellsPerBucket();
+  static void SetCellsPerBucket(int nofCells);
+
+  static vtkSmartPointer<vtkCellTreeLocator> Build(
+    vtkSmartPointer<vtkDataSet> source,
+    int cellsPerBucket);
+
+  // Queries of a built tree, they can run concurrently on the same tree.
+  // The tolerance is a distance.
+  static bool FindCell(
+    vtkCellTreeLocator* tree,
+    double tolerance,
+    const double point[3],
+    ProbeResult& result);
+
+  static bool Interpolate(
+    vtkDataSet* data,
+    const ProbeResult& result,
+    const char* arrayName,
+    DatasetRegistry::Association association,
+    std::vector<double>& values);
+
+  // Rebuilds the tree in background for the (already updated) source
+  void update(vtkDataSet* source);
+  void clear();
+
+  bool isReady() const;
+  bool isBuilding() const;
+
+  // The data the current tree was built from, probe results refer to it
+  vtkDataSet* getData() const;
+  vtkCellTreeLocator* getTree() const;
+
+  // Estimated bytes of the tree: its leaves, nodes and cached cell bounds.
+  // The data is shared with the part and not counted.
+  qint64 getMemorySize() const;
+  double getTolerance() const;
+
+  // Cell containing the point
+  bool findCell(const double point[3], ProbeResult& result) const;
+
+  // First cell crossed by the segment p0-p1
+  bool intersectRay(
+    const double p0[3],
+    const double p1[3],
+    ProbeResult& result) const;
+
+  // Components of a point or cell array at the probed position
+  bool interpolate(
+    const ProbeResult& result,
+    const char* arrayName,
+    DatasetRegistry::Association association,
+    std::vector<double>& values) const;
+
+signals:
+  void ready();
+
+protected slots:
+  void locatorBuilt();
+
+protected:
+  void startBuild(vtkDataSet* source);
+
+  QFutureWatcher<vtkSmartPointer<vtkCellTreeLocator>> m_watcher;
+
+  vtkSmartPointer<vtkCellTreeLocator> m_locator;
+  vtkSmartPointer<vtkDataSet>         m_data;
+  double                              m_tolerance;
+
+  vtkSmartPointer<vtkDataSet> m_buildData;
+  vtkSmartPointer<vtkDataSet> m_queuedSource;
+
+  static int s_cellsPerBucket;
+};
+
+#endif // PARTLOCATOR_H
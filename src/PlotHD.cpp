@@ -27,9 +27,13 @@
 #include <vtkAssignAttribute.h>
 #include <vtkAutoInit.h>
 #include <vtkBandedPolyDataContourFilter.h>
+#include <vtkCamera.h>
+#include <vtkCommand.h>
 #include <vtkContourFilter.h>
+#include <vtkEventQtSlotConnect.h>
 #include <vtkGenericOpenGLRenderWindow.h>
 #include <vtkInteractorStyle.h>
+#include <vtkMath.h>
 #include <vtkTDxInteractorStyleCamera.h>
 #include <vtkTDxInteractorStyleSettings.h>
 #include <vtkPolyDataMapper.h>
@@ -38,20 +42,68 @@
 #include <vtkRenderWindow.h>
 #include <vtkRenderWindowInteractor.h>
 
+#include <QVTKInteractor.h>
 #include <QVTKWidget2.h>
 
-#include <QApplication>
 #include <QVBoxLayout>
 
+#include <algorithm>
+#include <cmath>
+
 #include "Geometry.h"
 #include "GeometryPart.h"
 #include "GeometryPartRepresentation.h"
 #include "MainWindow.h"
+#include "PartBatch.h"
+#include "PartLocator.h"
+#include "PlotPool.h"
+#include "RedrawScheduler.h"
+#include "Tracer.h"
 
 VTK_MODULE_INIT(vtkRenderingOpenGL2)
 VTK_MODULE_INIT(vtkInteractionStyle)
 
-PlotHD::PlotHD(QWidget *parent) : QWidget(parent)
+const double DefaultFrameTimeTarget = 1.0 / 15.0;
+
+double PlotHD::s_defaultMinPartPixels = 0.0;
+
+void displayToWorld(
+  vtkRenderer* renderer,
+  double x,
+  double y,
+  double z,
+  double world[3])
+{
+  double point[4];
+
+  renderer->SetDisplayPoint(x, y, z);
+  renderer->DisplayToWorld();
+  renderer->GetWorldPoint(point);
+
+  for( int i = 0; i < 3; ++i )
+  {
+    world[i] = point[i] / point[3];
+  }
+}
+
+// Evicted parts are not read again for it
+bool isSmallPart(GeometryPart& part)
+{
+  return part.getNofCells() <= PartBatch::GetMaxPartCells();
+}
+
+PlotHD::PlotHD(QWidget *parent)
+  :
+  QWidget(parent),
+  m_interacting(false),
+  m_frameTimeTarget(DefaultFrameTimeTarget),
+  m_stillFrameTime(0.0),
+  m_lodFraction(1.0),
+  m_renderBegin(-1),
+  m_culling(true),
+  m_minPartPixels(s_defaultMinPartPixels),
+  m_nofDrawnParts(0),
+  m_nofCulledParts(0)
 {
   QVBoxLayout* lay = new QVBoxLayout(this);
   m_renderWidget = new QVTKWidget2(this);
@@ -64,10 +116,57 @@ PlotHD::PlotHD(QWidget *parent) : QWidget(parent)
   lay->setContentsMargins(0, 0, 0, 0);
 
   m_renderWidget->GetRenderWindow()->AddRenderer(m_renderer);
+
+  // All representations of this plot are brought up to date together and
+  // followed by a single render
+  m_scheduler = new RedrawScheduler(this);
+
+  connect(
+    m_scheduler,    SIGNAL(frameReady()),
+    m_renderWidget, SLOT(update()));
+
+  // Any mouse drag moves the camera, whatever the interactor style is
+  m_connections = vtkSmartPointer<vtkEventQtSlotConnect>::New();
+
+  vtkRenderWindowInteractor* interactor = m_renderWidget->GetInteractor();
+
+  const unsigned long pressEvents[] = {
+    vtkCommand::LeftButtonPressEvent,
+    vtkCommand::MiddleButtonPressEvent,
+    vtkCommand::RightButtonPressEvent };
+
+  const unsigned long releaseEvents[] = {
+    vtkCommand::LeftButtonReleaseEvent,
+    vtkCommand::MiddleButtonReleaseEvent,
+    vtkCommand::RightButtonReleaseEvent };
+
+  for( unsigned long event : pressEvents )
+  {
+    m_connections->Connect(
+      interactor, event, this, SLOT(startInteraction()));
+  }
+
+  for( unsigned long event : releaseEvents )
+  {
+    m_connections->Connect(
+      interactor, event, this, SLOT(endInteraction()));
+  }
+
+  // The render itself runs inside the widget's paintGL, its trace scope is
+  // opened and closed by the renderer events
+  m_connections->Connect(
+    m_renderer, vtkCommand::StartEvent, this, SLOT(frameStarted()));
+
+  m_connections->Connect(
+    m_renderer, vtkCommand::EndEvent, this, SLOT(frameRendered()));
+
+  m_connections->Connect(
+    interactor, vtkCommand::MouseMoveEvent, this, SLOT(probeUnderCursor()));
 }
 
 PlotHD::~PlotHD()
 {
+  m_connections->Disconnect();
 }
 
 void PlotHD::addGeometry(std::weak_ptr<Geometry> geom)
@@ -79,37 +178,206 @@ void PlotHD::addGeometry(std::weak_ptr<Geometry> geom)
 
     geomRep->m_geometry = geom;
 
-    for( auto part : validGeom->getParts() )
+    const QList<std::weak_ptr<GeometryPart>> parts = validGeom->getParts();
+
+    for( int i = 0; i < parts.size(); ++i )
     {
-      if( auto validPart = part.lock() )
+      if( auto validPart = parts[i].lock() )
       {
-        auto geomPartRep = std::unique_ptr<GeometryPartRepresentation>(
-          new GeometryPartRepresentation(
-            validPart,
-            m_renderer.Get(),
-            this));
+        addPartRepresentation(*geomRep, validPart, i);
+      }
+    }
 
-        QPair<QString, double*> info;
-        info.first = "TestField";
-        info.second = new double[2] {0.0, 0.0};
+    // Geometries read in background keep publishing parts after this call
+    connect(
+      validGeom.get(), SIGNAL(partAdded(int)),
+      this,            SLOT(addGeometryPart(int)));
 
-        info.second[0] = validGeom->getPointDatasetsInfo()[info.first][0];
-        info.second[1] = validGeom->getPointDatasetsInfo()[info.first][1];
+    connect(
+      validGeom.get(), SIGNAL(loadFinished()),
+      this,            SLOT(resetView()));
 
-        geomPartRep->setDatasetInfo(info);
+    connect(
+      validGeom.get(), SIGNAL(timeStepChanged(int)),
+      this,            SLOT(updateGeometryData()));
 
-//        geomPartRep->setSolidColor(QColor(Qt::red));
+    connect(
+      validGeom.get(), SIGNAL(dataChanged()),
+      this,            SLOT(updateGeometryData()));
 
-//        geomPartRep->setNofBands(5);
+    m_representations.push_back(std::move(geomRep));
+  }
+}
 
-        qApp->processEvents();
+void PlotHD::addGeometryPart(int index)
+{
+  Geometry* geom = qobject_cast<Geometry*>(sender());
+
+  if( !geom )
+  {
+    return;
+  }
+
+  for( auto& rep : m_representations )
+  {
+    auto validGeom = rep->m_geometry.lock();
+
+    if( validGeom.get() == geom )
+    {
+      if( auto validPart = geom->getPart(index).lock() )
+      {
+        addPartRepresentation(*rep, validPart, index);
 
-        geomRep->m_geometryParts.push_back(std::move(geomPartRep));
+        m_renderWidget->update();
       }
+
+      return;
+    }
+  }
+}
+
+void PlotHD::updateGeometryData()
+{
+  Geometry* geom = qobject_cast<Geometry*>(sender());
+
+  for( auto& rep : m_representations )
+  {
+    if( rep->m_geometry.lock().get() != geom )
+    {
+      continue;
+    }
+
+    // Collected by the scheduler into a single frame
+    for( auto& partRep : rep->m_geometryParts )
+    {
+      partRep->geometryChanged();
+    }
+
+    for( size_t i = 0; i < rep->m_partsByIndex.size(); ++i )
+    {
+      updatePartBatching(*rep, static_cast<int>(i));
+    }
+  }
+}
+
+void PlotHD::resetView()
+{
+  // The camera fits the visible props, culled parts included
+  for( auto& rep : m_representations )
+  {
+    for( auto& partRep : rep->m_geometryParts )
+    {
+      partRep->setCulled(false);
+    }
+  }
+
+  m_renderer->ResetCamera();
+  m_renderWidget->update();
+}
+
+void PlotHD::addPartRepresentation(
+  GeometryRepresentation& geomRep,
+  std::shared_ptr<GeometryPart> part,
+  int index)
+{
+  auto validGeom = geomRep.m_geometry.lock();
+
+  if( !validGeom )
+  {
+    return;
+  }
+
+  auto geomPartRep = std::unique_ptr<GeometryPartRepresentation>(
+    new GeometryPartRepresentation(
+      part,
+      m_renderer.Get(),
+      this));
+
+  geomPartRep->setRedrawScheduler(m_scheduler);
+
+  // Built in background, the part can be probed once it is ready
+  part->getLocator();
+
+  // Looked up once per geometry, the handle reads the live range from the
+  // registry so parts loaded later widen it for every representation.
+  if( !geomRep.m_dataset.isValid() )
+  {
+    geomRep.m_dataset =
+      validGeom->findDataset("TestField", DatasetRegistry::POINT_DATA);
+  }
+
+  if( geomRep.m_dataset.isValid() )
+  {
+    geomPartRep->setDatasetInfo(geomRep.m_dataset);
+  }
+
+//  geomPartRep->setSolidColor(QColor(Qt::red));
+
+//  geomPartRep->setNofBands(5);
+
+  if( index >= static_cast<int>(geomRep.m_partsByIndex.size()) )
+  {
+    geomRep.m_partsByIndex.resize(index + 1, nullptr);
+  }
+
+  geomRep.m_partsByIndex[index] = geomPartRep.get();
+
+  // Large parts keep their own actors, decimated while interacting, a batch
+  // draws every block at full resolution
+  const bool smallPart = isSmallPart(*part);
+
+  if( smallPart )
+  {
+    ++geomRep.m_nofSmallParts;
+  }
+
+  if( geomRep.m_batch && smallPart )
+  {
+    geomPartRep->setBatch(geomRep.m_batch.get(), index);
+  }
+
+  geomRep.m_geometryParts.push_back(std::move(geomPartRep));
+
+  // Geometries read in background reach the threshold while loading, the
+  // small parts shown until then move into the batch
+  const int minNofParts = PartBatch::GetMinNofParts();
+
+  if( !geomRep.m_batch && (minNofParts > 0) &&
+      (geomRep.m_nofSmallParts >= minNofParts) )
+  {
+    TRACE_SCOPE("PlotHD::batchParts");
+
+    geomRep.m_batch.reset(new PartBatch(m_renderer.Get()));
+
+    for( size_t i = 0; i < geomRep.m_partsByIndex.size(); ++i )
+    {
+      updatePartBatching(geomRep, static_cast<int>(i));
     }
   }
 }
 
+void PlotHD::updatePartBatching(GeometryRepresentation& geomRep, int index)
+{
+  GeometryPartRepresentation* partRep = geomRep.m_partsByIndex[index];
+
+  if( !geomRep.m_batch || !partRep )
+  {
+    return;
+  }
+
+  auto part = partRep->getGeometryPart().lock();
+
+  if( !part )
+  {
+    return;
+  }
+
+  // Does nothing when the part already is where it belongs
+  partRep->setBatch(
+    isSmallPart(*part)? geomRep.m_batch.get() : nullptr,
+    index);
+}
+
 bool PlotHD::checkPlotDeletion()
 {
   unsigned int expiredGeoms = 0;
@@ -121,10 +389,458 @@ bool PlotHD::checkPlotDeletion()
 
   if( m_representations.size() == expiredGeoms )
   {
-    delete this;
-    //    this->deleteLater();
+    PlotPool::Release(this);
     return true;
   }
 
   return false;
 }
+
+void PlotHD::returnToPool()
+{
+  PlotPool::Recycle(this);
+}
+
+void PlotHD::reset()
+{
+  TRACE_SCOPE("PlotHD::reset");
+
+  for( auto& rep : m_representations )
+  {
+    if( auto validGeom = rep->m_geometry.lock() )
+    {
+      disconnect(validGeom.get(), 0, this, 0);
+    }
+  }
+
+  // The part representations remove their actors and pending updates
+  m_representations.clear();
+  m_renderer->RemoveAllViewProps();
+
+  // Without camera the renderer creates one and fits it to the parts on the
+  // next render, as it does for a new plot
+  m_renderer->SetActiveCamera(nullptr);
+
+  m_scheduler->resetCounters();
+
+  m_interacting     = false;
+  m_frameTimeTarget = DefaultFrameTimeTarget;
+  m_stillFrameTime  = 0.0;
+  m_lodFraction     = 1.0;
+  m_renderBegin     = -1;
+  m_probeText.clear();
+
+  m_culling        = true;
+  m_minPartPixels  = s_defaultMinPartPixels;
+  m_nofDrawnParts  = 0;
+  m_nofCulledParts = 0;
+}
+
+RedrawScheduler* PlotHD::getRedrawScheduler() const
+{
+  return m_scheduler;
+}
+
+double PlotHD::getFrameTimeTarget() const
+{
+  return m_frameTimeTarget;
+}
+
+void PlotHD::setFrameTimeTarget(double seconds)
+{
+  m_frameTimeTarget = seconds;
+}
+
+void PlotHD::startInteraction()
+{
+  m_interacting = true;
+
+  // Start from the cost of the last full resolution frame, the fraction is
+  // refined with the interactive frames that follow
+  if( m_stillFrameTime > m_frameTimeTarget )
+  {
+    setLODFraction(m_frameTimeTarget / m_stillFrameTime);
+  }
+}
+
+void PlotHD::endInteraction()
+{
+  if( !m_interacting )
+  {
+    return;
+  }
+
+  m_interacting = false;
+
+  if( m_lodFraction < 1.0 )
+  {
+    setLODFraction(1.0);
+    m_renderWidget->update();
+  }
+}
+
+void PlotHD::frameStarted()
+{
+  m_renderBegin = Tracer::IsEnabled() ? Tracer::Now() : -1;
+
+  // Before the renderer collects its visible props
+  cullParts();
+}
+
+void PlotHD::frameRendered()
+{
+  if( m_renderBegin >= 0 )
+  {
+    Tracer::AddEvent("PlotHD::render", m_renderBegin, Tracer::Now());
+    m_renderBegin = -1;
+  }
+
+  const double frameTime = m_renderer->GetLastRenderTimeInSeconds();
+
+  if( !m_interacting )
+  {
+    if( m_lodFraction >= 1.0 )
+    {
+      m_stillFrameTime = frameTime;
+    }
+
+    return;
+  }
+
+  // Still too slow with the current proxies, go coarser for the next frame
+  if( (frameTime > 1.25 * m_frameTimeTarget) && (m_lodFraction > 1.0e-3) )
+  {
+    setLODFraction(m_lodFraction * m_frameTimeTarget / frameTime);
+  }
+}
+
+void PlotHD::setLODFraction(double fraction)
+{
+  m_lodFraction = fraction;
+
+  for( auto& rep : m_representations )
+  {
+    for( auto& partRep : rep->m_geometryParts )
+    {
+      partRep->setLODFraction(fraction);
+    }
+  }
+}
+
+bool PlotHD::isCulling() const
+{
+  return m_culling;
+}
+
+void PlotHD::setCulling(bool on)
+{
+  if( m_culling == on )
+  {
+    return;
+  }
+
+  m_culling = on;
+
+  if( !m_culling )
+  {
+    for( auto& rep : m_representations )
+    {
+      for( auto& partRep : rep->m_geometryParts )
+      {
+        partRep->setCulled(false);
+      }
+    }
+
+    m_nofCulledParts = 0;
+  }
+
+  m_renderWidget->update();
+}
+
+double PlotHD::getMinPartPixels() const
+{
+  return m_minPartPixels;
+}
+
+void PlotHD::setMinPartPixels(double pixels)
+{
+  m_minPartPixels = pixels;
+  m_renderWidget->update();
+}
+
+int PlotHD::getNofDrawnParts() const
+{
+  return m_nofDrawnParts;
+}
+
+int PlotHD::getNofCulledParts() const
+{
+  return m_nofCulledParts;
+}
+
+double PlotHD::GetDefaultMinPartPixels()
+{
+  return s_defaultMinPartPixels;
+}
+
+void PlotHD::SetDefaultMinPartPixels(double pixels)
+{
+  s_defaultMinPartPixels = pixels;
+}
+
+void PlotHD::SetupFromEnvironment()
+{
+  bool ok = false;
+  const double pixels = qgetenv("QTVTK_MIN_PART_PIXELS").toDouble(&ok);
+
+  if( ok )
+  {
+    SetDefaultMinPartPixels(pixels);
+  }
+}
+
+void PlotHD::cullParts()
+{
+  // Without camera the renderer fits a new one to the visible props first
+  if( !m_culling || !m_renderer->IsActiveCameraCreated() )
+  {
+    return;
+  }
+
+  TRACE_SCOPE("PlotHD::cullParts");
+
+  vtkCamera* camera = m_renderer->GetActiveCamera();
+
+  PartHierarchy::ViewVolume volume;
+
+  // Only the side planes, the clipping range follows the visible parts
+  double planes[24];
+  camera->GetFrustumPlanes(m_renderer->GetTiledAspectRatio(), planes);
+  std::copy(planes, planes + 16, volume.m_planes);
+
+  camera->GetPosition(volume.m_eye);
+
+  const int height = std::max(m_renderer->GetSize()[1], 1);
+
+  volume.m_parallel      = camera->GetParallelProjection() != 0;
+  volume.m_minPixels     = m_minPartPixels;
+  volume.m_pixelsPerUnit = volume.m_parallel?
+    height / (2.0 * camera->GetParallelScale()) :
+    height / (2.0 * std::tan(
+      0.5 * vtkMath::RadiansFromDegrees(camera->GetViewAngle())));
+
+  int  nofDrawn  = 0;
+  int  nofCulled = 0;
+  bool uncovered = false;
+
+  std::vector<int>  visibleParts;
+  std::vector<char> visible;
+
+  for( auto& rep : m_representations )
+  {
+    auto validGeom = rep->m_geometry.lock();
+
+    if( !validGeom )
+    {
+      continue;
+    }
+
+    validGeom->getPartHierarchy().findVisible(volume, visibleParts);
+
+    visible.assign(rep->m_partsByIndex.size(), 0);
+
+    for( int index : visibleParts )
+    {
+      if( index < static_cast<int>(visible.size()) )
+      {
+        visible[index] = 1;
+      }
+    }
+
+    for( size_t i = 0; i < rep->m_partsByIndex.size(); ++i )
+    {
+      GeometryPartRepresentation* partRep = rep->m_partsByIndex[i];
+
+      if( !partRep )
+      {
+        continue;
+      }
+
+      const bool culled = !visible[i];
+
+      uncovered = uncovered || (partRep->isCulled() && !culled);
+
+      partRep->setCulled(culled);
+
+      nofCulled += culled? 1 : 0;
+      nofDrawn  += culled? 0 : 1;
+    }
+  }
+
+  // Parts coming into view may lie beyond the far plane computed without them
+  if( uncovered )
+  {
+    m_renderer->ResetCameraClippingRange();
+  }
+
+  m_nofDrawnParts  = nofDrawn;
+  m_nofCulledParts = nofCulled;
+
+  emit partsCulled(nofDrawn, nofCulled);
+}
+
+QString PlotHD::probe(int x, int y)
+{
+  TRACE_SCOPE("PlotHD::probe");
+
+  double p0[3];
+  double p1[3];
+  displayToWorld(m_renderer, x, y, 0.0, p0);
+  displayToWorld(m_renderer, x, y, 1.0, p1);
+
+  double direction[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+
+  // The parts whose bounds the ray enters, of every geometry, nearest first
+  struct Candidate
+  {
+    double                      m_t;
+    GeometryRepresentation*     m_rep;
+    GeometryPartRepresentation* m_partRep;
+  };
+
+  std::vector<Candidate>              candidates;
+  std::vector<PartHierarchy::RayHit>  hits;
+
+  for( auto& rep : m_representations )
+  {
+    auto validGeom = rep->m_geometry.lock();
+
+    if( !validGeom )
+    {
+      continue;
+    }
+
+    validGeom->getPartHierarchy().findAlongRay(p0, direction, hits);
+
+    for( const PartHierarchy::RayHit& hit : hits )
+    {
+      GeometryPartRepresentation* partRep =
+        (hit.m_part < static_cast<int>(rep->m_partsByIndex.size()))?
+          rep->m_partsByIndex[hit.m_part] : nullptr;
+
+      // Hidden and culled parts are not under the cursor
+      if( partRep && partRep->isShown() )
+      {
+        Candidate candidate;
+        candidate.m_t       = hit.m_t;
+        candidate.m_rep     = rep.get();
+        candidate.m_partRep = partRep;
+
+        candidates.push_back(candidate);
+      }
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+    [](const Candidate& a, const Candidate& b)
+    {
+      return a.m_t < b.m_t;
+    });
+
+  ProbeResult                   best;
+  std::shared_ptr<GeometryPart> bestPart;
+  std::shared_ptr<PartLocator>  bestLocator;
+  DatasetHandle                 bestDataset;
+
+  for( const Candidate& candidate : candidates )
+  {
+    // Every part left is entered behind the nearest hit
+    if( bestPart && (candidate.m_t > best.m_t) )
+    {
+      break;
+    }
+
+    auto part = candidate.m_partRep->getGeometryPart().lock();
+
+    if( !part || !part->isLoaded() )
+    {
+      continue;
+    }
+
+    std::shared_ptr<PartLocator> locator = part->getLocator();
+    ProbeResult result;
+
+    if( !locator->intersectRay(p0, p1, result) ||
+        (bestPart && (result.m_t >= best.m_t)) )
+    {
+      continue;
+    }
+
+    best        = result;
+    bestPart    = part;
+    bestLocator = locator;
+    bestDataset = candidate.m_rep->m_dataset;
+  }
+
+  if( !bestPart )
+  {
+    return QString();
+  }
+
+  QString text = bestPart->getPartName().isEmpty()?
+    tr("Unnamed part") : bestPart->getPartName();
+
+  std::vector<double> values;
+
+  if( bestDataset.isValid() &&
+      bestLocator->interpolate(
+        best,
+        bestDataset.getKey(),
+        bestDataset.getAssociation(),
+        values) )
+  {
+    // Vectors are shown by their magnitude, as they are colored
+    double value = values[0];
+
+    if( values.size() > 1 )
+    {
+      value = 0.0;
+
+      for( double component : values )
+      {
+        value += component * component;
+      }
+
+      value = std::sqrt(value);
+    }
+
+    text += tr(": %1 = %2").arg(bestDataset.getName()).arg(value);
+  }
+
+  text += tr(" at (%1, %2, %3)")
+    .arg(best.m_position[0])
+    .arg(best.m_position[1])
+    .arg(best.m_position[2]);
+
+  return text;
+}
+
+void PlotHD::probeUnderCursor()
+{
+  // The camera is moving, nothing stays under the cursor
+  if( m_interacting )
+  {
+    return;
+  }
+
+  const int* position = m_renderWidget->GetInteractor()->GetEventPosition();
+
+  const QString text = probe(position[0], position[1]);
+
+  if( text != m_probeText )
+  {
+    m_probeText = text;
+    emit probed(text);
+  }
+}
+
@@ -23,6 +23,8 @@
 #ifndef PLOTHD_H
 #define PLOTHD_H
 
+#include "DatasetRegistry.h"
+
 #include <QWidget>
 
 #include <vtkSmartPointer.h>
@@ -32,14 +34,25 @@
 class Geometry;
 
 class QVTKWidget2;
+class vtkEventQtSlotConnect;
 class vtkRenderer;
 
+class GeometryPart;
 class GeometryPartRepresentation;
+class PartBatch;
+class RedrawScheduler;
 
 struct GeometryRepresentation
 {
   std::weak_ptr<Geometry>                                  m_geometry;
+  DatasetHandle                                            m_dataset;
+  // Draws the small parts once the geometry has PartBatch::GetMinNofParts()
+  // of them, destroyed after them
+  std::unique_ptr<PartBatch>                               m_batch;
+  int                                                      m_nofSmallParts;
   std::vector<std::unique_ptr<GeometryPartRepresentation>> m_geometryParts;
+  // By part index of the geometry, for the culling
+  std::vector<GeometryPartRepresentation*>                 m_partsByIndex;
 };
 
 class PlotHD : public QWidget
@@ -51,17 +64,101 @@ public:
 
   void addGeometry(std::weak_ptr<Geometry> geom);
 
+  // Releases the plot to the PlotPool once all its geometries are gone
   bool checkPlotDeletion();
 
+  // Drops every geometry and brings the plot back to the state of a new one,
+  // the render widget and the renderer are kept (see PlotPool)
+  void reset();
+
+  RedrawScheduler* getRedrawScheduler() const;
+
+  // While the camera is moving, parts are drawn with decimated proxies when
+  // a full resolution frame takes longer than this target
+  double getFrameTimeTarget() const;
+  void setFrameTimeTarget(double seconds);
+
+  // Before every frame the parts outside of the view frustum, and with a
+  // minimum size the ones projecting smaller than it, are hidden using the
+  // part hierarchy of their geometry
+  bool isCulling() const;
+  void setCulling(bool on);
+  double getMinPartPixels() const;
+  void setMinPartPixels(double pixels);
+
+  // Of the last frame
+  int getNofDrawnParts() const;
+  int getNofCulledParts() const;
+
+  // Minimum size of new plots, 0 culls by the view frustum only
+  static double GetDefaultMinPartPixels();
+  static void SetDefaultMinPartPixels(double pixels);
+
+  // Reads QTVTK_MIN_PART_PIXELS
+  static void SetupFromEnvironment();
+
+  // Part, position and value of the shown dataset under the display
+  // position, empty if no part is there or its locator is still being built.
+  // Only the parts drawn are probed, found along the pick ray with the part
+  // hierarchy of their geometry.
+  QString probe(int x, int y);
+
 signals:
+  // Emitted when the text probed under the mouse changes
+  void probed(const QString& text);
+
+  // Emitted before every frame when culling
+  void partsCulled(int nofDrawnParts, int nofCulledParts);
 
 public slots:
 
+protected slots:
+  void addGeometryPart(int index);
+  void updateGeometryData();
+  void resetView();
+  void startInteraction();
+  void endInteraction();
+  void frameStarted();
+  void frameRendered();
+  void probeUnderCursor();
+
+  // Queued by PlotPool::Release, see PlotPool::Recycle
+  void returnToPool();
+
 protected:
+  void addPartRepresentation(
+    GeometryRepresentation& geomRep,
+    std::shared_ptr<GeometryPart> part,
+    int index);
+
+  // Moves the part in or out of the batch of its geometry after its data
+  // changed size
+  void updatePartBatching(GeometryRepresentation& geomRep, int index);
+
+  void cullParts();
+
+  void setLODFraction(double fraction);
+
   std::vector<std::unique_ptr<GeometryRepresentation>> m_representations;
 
-  QVTKWidget2* m_renderWidget;
+  QVTKWidget2*     m_renderWidget;
+  RedrawScheduler* m_scheduler;
   vtkSmartPointer<vtkRenderer> m_renderer;
+
+  vtkSmartPointer<vtkEventQtSlotConnect> m_connections;
+  bool   m_interacting;
+  double m_frameTimeTarget;
+  double m_stillFrameTime;
+  double m_lodFraction;
+  qint64 m_renderBegin;
+  QString m_probeText;
+
+  bool   m_culling;
+  double m_minPartPixels;
+  int    m_nofDrawnParts;
+  int    m_nofCulledParts;
+
+  static double s_defaultMinPartPixels;
 };
 
 #endif // PLOTHD_H
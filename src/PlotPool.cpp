@@ -0,0 +1,240 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PlotPool.h"
+
+#include "PlotHD.h"
+#include "Tracer.h"
+
+#include <QLayout>
+#include <QList>
+#include <QPointer>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+struct PoolState
+{
+  PoolState()
+    :
+    m_capacity(4),
+    m_nofCreations(0),
+    m_nofReuses(0)
+  {
+  }
+
+  // Idle plots stay children of their last parent, they are deleted with it
+  QList<QPointer<PlotHD>> m_idle;
+  // Released, waiting for their queued recycle
+  QList<QPointer<PlotHD>> m_released;
+  int                     m_capacity;
+  int                     m_nofCreations;
+  int                     m_nofReuses;
+};
+
+PoolState& getState()
+{
+  static PoolState state;
+  return state;
+}
+
+void dropDeleted(PoolState& state)
+{
+  state.m_idle.removeAll(QPointer<PlotHD>());
+  state.m_released.removeAll(QPointer<PlotHD>());
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+int PlotPool::GetCapacity()
+{
+  return getState().m_capacity;
+}
+
+//------------------------------------------------------------------------------
+
+void PlotPool::SetCapacity(int nofPlots)
+{
+  PoolState& state = getState();
+
+  state.m_capacity = qMax(nofPlots, 0);
+
+  dropDeleted(state);
+
+  while( state.m_idle.size() > state.m_capacity )
+  {
+    delete state.m_idle.takeFirst();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+PlotHD* PlotPool::Acquire(QWidget* parent)
+{
+  TRACE_SCOPE("PlotPool::Acquire");
+
+  PoolState& state = getState();
+
+  dropDeleted(state);
+
+  if( state.m_idle.isEmpty() )
+  {
+    ++state.m_nofCreations;
+    return new PlotHD(parent);
+  }
+
+  PlotHD* plot = state.m_idle.takeLast();
+
+  // Reparenting a QGLWidget can recreate its context, plots are normally
+  // taken back by the same container
+  if( plot->parentWidget() != parent )
+  {
+    plot->setParent(parent);
+  }
+
+  plot->show();
+
+  ++state.m_nofReuses;
+
+  return plot;
+}
+
+//------------------------------------------------------------------------------
+
+void PlotPool::Release(PlotHD* plot)
+{
+  if( !plot )
+  {
+    return;
+  }
+
+  TRACE_SCOPE("PlotPool::Release");
+
+  PoolState& state = getState();
+
+  dropDeleted(state);
+
+  if( state.m_released.contains(plot) )
+  {
+    return;
+  }
+
+  if( QWidget* parent = plot->parentWidget() )
+  {
+    if( parent->layout() )
+    {
+      parent->layout()->removeWidget(plot);
+    }
+  }
+
+  plot->hide();
+
+  // The caller may be a slot of the plot still using its representations
+  state.m_released.append(plot);
+
+  QMetaObject::invokeMethod(plot, "returnToPool", Qt::QueuedConnection);
+}
+
+//------------------------------------------------------------------------------
+
+void PlotPool::Recycle(PlotHD* plot)
+{
+  PoolState& state = getState();
+
+  dropDeleted(state);
+
+  if( !state.m_released.removeAll(plot) )
+  {
+    return;
+  }
+
+  TRACE_SCOPE("PlotPool::Recycle");
+
+  if( state.m_idle.size() >= state.m_capacity )
+  {
+    plot->deleteLater();
+    return;
+  }
+
+  plot->reset();
+
+  state.m_idle.append(plot);
+}
+
+//------------------------------------------------------------------------------
+
+void PlotPool::Clear()
+{
+  PoolState& state = getState();
+
+  for( const QPointer<PlotHD>& plot : state.m_idle + state.m_released )
+  {
+    delete plot.data();
+  }
+
+  state.m_idle.clear();
+  state.m_released.clear();
+}
+
+//------------------------------------------------------------------------------
+
+int PlotPool::GetNofIdle()
+{
+  PoolState& state = getState();
+
+  dropDeleted(state);
+
+  return state.m_idle.size();
+}
+
+//------------------------------------------------------------------------------
+
+int PlotPool::GetNofCreations()
+{
+  return getState().m_nofCreations;
+}
+
+//------------------------------------------------------------------------------
+
+int PlotPool::GetNofReuses()
+{
+  return getState().m_nofReuses;
+}
+
+//------------------------------------------------------------------------------
+
+void PlotPool::SetupFromEnvironment()
+{
+  bool ok = false;
+  const int capacity = qgetenv("QTVTK_PLOT_POOL").toInt(&ok);
+
+  if( ok )
+  {
+    SetCapacity(capacity);
+  }
+}
+
+//------------------------------------------------------------------------------
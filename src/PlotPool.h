@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PLOTPOOL_H
+#define PLOTPOOL_H
+
+class PlotHD;
+class QWidget;
+
+// Keeps removed plots with their render widget, OpenGL context and renderer
+// instead of destroying them. A released plot is hidden right away, then
+// reset (see PlotHD::reset) and made idle from the event loop, like a
+// deleteLater(), since the plot may be releasing itself from one of its
+// slots. The next acquired plot takes it back, so opening a plot does not
+// create a new context and memory stays flat across add/remove cycles.
+// GUI thread only.
+class PlotPool
+{
+public:
+  // Idle plots kept, released plots over it are deleted. 0 turns the pool off
+  static int GetCapacity();
+  static void SetCapacity(int nofPlots);
+
+  // Reused plots are moved to parent if they had another one
+  static PlotHD* Acquire(QWidget* parent);
+  static void Release(PlotHD* plot);
+
+  // Resets a released plot and makes it idle, called from the event loop
+  static void Recycle(PlotHD* plot);
+
+  // Deletes the idle plots
+  static void Clear();
+
+  static int GetNofIdle();
+  static int GetNofCreations();
+  static int GetNofReuses();
+
+  // QTVTK_PLOT_POOL=<plots> sets the capacity
+  static void SetupFromEnvironment();
+};
+
+#endif // PLOTPOOL_H
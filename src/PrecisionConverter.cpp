@@ -0,0 +1,221 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PrecisionConverter.h"
+
+#include "Tracer.h"
+
+#include <vtkCellData.h>
+#include <vtkDataSet.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPointSet.h>
+#include <vtkSMPTools.h>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+class DoubleToFloat
+{
+public:
+  DoubleToFloat(const double* source, float* target)
+    :
+    m_source(source),
+    m_target(target)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for( vtkIdType i = begin; i < end; ++i )
+    {
+      m_target[i] = static_cast<float>(m_source[i]);
+    }
+  }
+
+protected:
+  const double* m_source;
+  float*        m_target;
+};
+
+qint64 convertArrays(vtkDataSetAttributes* att, const PrecisionPolicy& policy)
+{
+  qint64 savedBytes = 0;
+
+  for( int i = 0; i < att->GetNumberOfArrays(); ++i )
+  {
+    vtkDataArray* array = att->GetArray(i);
+
+    if( !array || (array->GetDataType() != VTK_DOUBLE) || !array->GetName() ||
+        !policy.convertsArray(QString::fromUtf8(array->GetName())) )
+    {
+      continue;
+    }
+
+    savedBytes += array->GetNumberOfValues() * (sizeof(double) - sizeof(float));
+
+    // Same name, the array replaces the double one at its index so the
+    // active attributes are kept
+    att->AddArray(PrecisionConverter::ToFloat(array));
+  }
+
+  return savedBytes;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+PrecisionPolicy::PrecisionPolicy()
+  :
+  m_singlePoints(false),
+  m_singleArrays(false)
+{
+}
+
+//------------------------------------------------------------------------------
+
+PrecisionPolicy PrecisionPolicy::Single()
+{
+  PrecisionPolicy policy;
+  policy.m_singlePoints = true;
+  policy.m_singleArrays = true;
+
+  return policy;
+}
+
+//------------------------------------------------------------------------------
+
+PrecisionPolicy PrecisionPolicy::FromEnvironment()
+{
+  if( qgetenv("QTVTK_PRECISION").toLower() != "single" )
+  {
+    return PrecisionPolicy();
+  }
+
+  PrecisionPolicy policy = Single();
+
+  const QString arrays = QString::fromLocal8Bit(qgetenv("QTVTK_SINGLE_ARRAYS"));
+  policy.m_arrays = arrays.split(',', QString::SkipEmptyParts);
+
+  return policy;
+}
+
+//------------------------------------------------------------------------------
+
+bool PrecisionPolicy::isNative() const
+{
+  return !m_singlePoints && !m_singleArrays;
+}
+
+//------------------------------------------------------------------------------
+
+bool PrecisionPolicy::convertsArray(const QString& name) const
+{
+  return m_singleArrays && (m_arrays.isEmpty() || m_arrays.contains(name));
+}
+
+//------------------------------------------------------------------------------
+
+bool PrecisionPolicy::operator==(const PrecisionPolicy& other) const
+{
+  return (m_singlePoints == other.m_singlePoints) &&
+         (m_singleArrays == other.m_singleArrays) &&
+         (m_arrays == other.m_arrays);
+}
+
+//------------------------------------------------------------------------------
+
+bool PrecisionPolicy::operator!=(const PrecisionPolicy& other) const
+{
+  return !(*this == other);
+}
+
+//------------------------------------------------------------------------------
+
+qint64 PrecisionConverter::ConvertToSingle(
+  vtkDataSet* data,
+  const PrecisionPolicy& policy)
+{
+  if( !data || policy.isNative() )
+  {
+    return 0;
+  }
+
+  TRACE_SCOPE("PrecisionConverter::ConvertToSingle");
+
+  qint64 savedBytes = 0;
+
+  vtkPointSet* pointSet = vtkPointSet::SafeDownCast(data);
+
+  if( policy.m_singlePoints && pointSet && pointSet->GetPoints() &&
+      (pointSet->GetPoints()->GetDataType() == VTK_DOUBLE) )
+  {
+    vtkDataArray* coords = pointSet->GetPoints()->GetData();
+
+    savedBytes +=
+      coords->GetNumberOfValues() * (sizeof(double) - sizeof(float));
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(ToFloat(coords));
+
+    pointSet->SetPoints(points);
+  }
+
+  if( policy.m_singleArrays )
+  {
+    savedBytes += convertArrays(data->GetPointData(), policy);
+    savedBytes += convertArrays(data->GetCellData(), policy);
+  }
+
+  return savedBytes;
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkFloatArray> PrecisionConverter::ToFloat(vtkDataArray* array)
+{
+  vtkSmartPointer<vtkFloatArray> floatArray =
+    vtkSmartPointer<vtkFloatArray>::New();
+  floatArray->SetName(array->GetName());
+  floatArray->SetNumberOfComponents(array->GetNumberOfComponents());
+  floatArray->SetNumberOfTuples(array->GetNumberOfTuples());
+
+  if( vtkDoubleArray* doubleArray = vtkDoubleArray::SafeDownCast(array) )
+  {
+    DoubleToFloat kernel(doubleArray->GetPointer(0), floatArray->GetPointer(0));
+
+    vtkSMPTools::For(0, doubleArray->GetNumberOfValues(), kernel);
+  }
+  else
+  {
+    floatArray->DeepCopy(array);
+  }
+
+  return floatArray;
+}
+
+//------------------------------------------------------------------------------
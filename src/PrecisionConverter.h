@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PRECISIONCONVERTER_H
+#define PRECISIONCONVERTER_H
+
+#include <QStringList>
+
+#include <vtkSmartPointer.h>
+
+class vtkDataArray;
+class vtkDataSet;
+class vtkFloatArray;
+
+// Storage precision of the parts of a Geometry. Double points and arrays
+// are converted to float when the data is set on a part.
+struct PrecisionPolicy
+{
+  PrecisionPolicy();
+
+  static PrecisionPolicy Single();
+
+  // QTVTK_PRECISION=single, QTVTK_SINGLE_ARRAYS=<name,name,...> restricts
+  // the converted arrays
+  static PrecisionPolicy FromEnvironment();
+
+  bool isNative() const;
+  bool convertsArray(const QString& name) const;
+
+  bool operator==(const PrecisionPolicy& other) const;
+  bool operator!=(const PrecisionPolicy& other) const;
+
+  bool        m_singlePoints;
+  bool        m_singleArrays;
+  QStringList m_arrays;        // Converted arrays, every one when empty
+};
+
+class PrecisionConverter
+{
+public:
+  // Replaces the double points and arrays of data, which must not share its
+  // points and attributes objects with other datasets (see
+  // GeometryPart::setGeometryData). Returns the bytes saved.
+  static qint64 ConvertToSingle(
+    vtkDataSet* data,
+    const PrecisionPolicy& policy);
+
+  // Parallel copy, the array keeps its name and components
+  static vtkSmartPointer<vtkFloatArray> ToFloat(vtkDataArray* array);
+};
+
+#endif // PRECISIONCONVERTER_H
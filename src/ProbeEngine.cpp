@@ -0,0 +1,528 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "ProbeEngine.h"
+
+#include "Geometry.h"
+#include "GeometryPart.h"
+#include "PartLocator.h"
+#include "Tracer.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include <vtkCellTreeLocator.h>
+#include <vtkDataSet.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+// Samples per task, each one descends a cell tree
+const vtkIdType SampleGrain = 256;
+
+// Bins per axis of the part grid
+const int MaxGridSize = 64;
+
+bool contains(const double bounds[6], const double point[3], double tolerance)
+{
+  for( int axis = 0; axis < 3; ++axis )
+  {
+    if( (point[axis] < bounds[2*axis] - tolerance) ||
+        (point[axis] > bounds[2*axis + 1] + tolerance) )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+class ProbeEngine::BuildTrees
+{
+public:
+  void operator()(PartTree& part) const
+  {
+    if( part.m_tree )
+    {
+      return;
+    }
+
+    part.m_tree = PartLocator::Build(
+      part.m_data,
+      PartLocator::GetCellsPerBucket());
+
+    // Relative to the size of the part, like PartLocator
+    part.m_tolerance = 1.0e-6 * part.m_data->GetLength();
+  }
+};
+
+//------------------------------------------------------------------------------
+
+class ProbeEngine::SampleFunctor
+{
+public:
+  SampleFunctor(
+    const ProbeEngine& engine,
+    const QByteArray& arrayName,
+    DatasetRegistry::Association association,
+    ProbeSamples& samples)
+    :
+    m_engine(engine),
+    m_arrayName(arrayName),
+    m_association(association),
+    m_samples(samples)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const size_t nofComponents = m_samples.m_nofComponents;
+
+    ProbeResult         result;
+    std::vector<double> values;
+
+    for( vtkIdType s = begin; s < end; ++s )
+    {
+      const double* point = &m_samples.m_positions[3*s];
+
+      const std::vector<int>* bin = m_engine.findBin(point);
+
+      if( !bin )
+      {
+        continue;
+      }
+
+      for( int p : *bin )
+      {
+        const PartTree& part = m_engine.m_parts[p];
+
+        if( !contains(part.m_bounds, point, part.m_tolerance) ||
+            !PartLocator::FindCell(
+              part.m_tree, part.m_tolerance, point, result) )
+        {
+          continue;
+        }
+
+        m_samples.m_partIds[s] = part.m_index;
+        m_samples.m_cellIds[s] = result.m_cellId;
+
+        // Parts without the field keep NaN
+        if( (nofComponents > 0) &&
+            PartLocator::Interpolate(
+              part.m_data,
+              result,
+              m_arrayName.constData(),
+              m_association,
+              values) &&
+            (values.size() == nofComponents) )
+        {
+          std::copy(values.begin(), values.end(),
+            m_samples.m_values.begin() + nofComponents * s);
+        }
+
+        break;
+      }
+    }
+  }
+
+protected:
+  const ProbeEngine&           m_engine;
+  const QByteArray&            m_arrayName;
+  DatasetRegistry::Association m_association;
+  ProbeSamples&                m_samples;
+};
+
+//------------------------------------------------------------------------------
+
+ProbeSamples::ProbeSamples()
+  :
+  m_nofComponents(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+int ProbeSamples::getNofSamples() const
+{
+  return static_cast<int>(m_partIds.size());
+}
+
+//------------------------------------------------------------------------------
+
+bool ProbeSamples::isValid(int sample) const
+{
+  return m_partIds[sample] >= 0;
+}
+
+//------------------------------------------------------------------------------
+
+ProbeEngine::ProbeEngine(const Geometry& geometry)
+  :
+  // The registry of the geometry keeps changing in the GUI thread as parts
+  // and time steps arrive, queries use a copy
+  m_datasets(std::make_shared<DatasetRegistry>(
+    *geometry.getDatasetRegistry())),
+  m_gridBounds{0.0, -1.0, 0.0, -1.0, 0.0, -1.0},
+  m_gridSize{0, 0, 0}
+{
+  TRACE_SCOPE("ProbeEngine::ProbeEngine");
+
+  // The trees of PartLocator are only touched in the GUI thread
+  QCoreApplication* app = QCoreApplication::instance();
+  const bool guiThread = app && (QThread::currentThread() == app->thread());
+
+  const QList<std::weak_ptr<GeometryPart>> parts = geometry.getParts();
+  int nofEvictedParts = 0;
+
+  for( int i = 0; i < parts.size(); ++i )
+  {
+    auto part = parts[i].lock();
+
+    if( !part )
+    {
+      continue;
+    }
+
+    // Evicted parts are not read again, that would undo the memory budget
+    // of PartCache
+    if( !part->isLoaded() )
+    {
+      ++nofEvictedParts;
+      continue;
+    }
+
+    vtkDataSet* data = part->getGeometryData();
+
+    if( !data || (data->GetNumberOfCells() == 0) )
+    {
+      continue;
+    }
+
+    PartTree tree;
+    tree.m_index     = i;
+    tree.m_tolerance = 0.0;
+
+    if( guiThread && part->hasLocator() )
+    {
+      std::shared_ptr<PartLocator> locator = part->getLocator();
+
+      // A tree being rebuilt is outdated
+      if( locator->isReady() && !locator->isBuilding() )
+      {
+        tree.m_data      = locator->getData();
+        tree.m_tree      = locator->getTree();
+        tree.m_tolerance = locator->getTolerance();
+      }
+    }
+
+    if( !tree.m_tree )
+    {
+      // The pipeline of the part may produce a new output meanwhile
+      tree.m_data.TakeReference(data->NewInstance());
+      tree.m_data->ShallowCopy(data);
+    }
+
+    tree.m_data->GetBounds(tree.m_bounds);
+
+    m_parts.push_back(tree);
+  }
+
+  if( nofEvictedParts > 0 )
+  {
+    qWarning("%d evicted parts are not probed", nofEvictedParts);
+  }
+
+  // Parts share no data, their trees are built concurrently
+  QtConcurrent::blockingMap(m_parts, BuildTrees());
+
+  buildPartGrid();
+}
+
+//------------------------------------------------------------------------------
+
+ProbeEngine::~ProbeEngine()
+{
+}
+
+//------------------------------------------------------------------------------
+
+int ProbeEngine::getNofParts() const
+{
+  return static_cast<int>(m_parts.size());
+}
+
+//------------------------------------------------------------------------------
+
+ProbeSamples ProbeEngine::probePoints(
+  const QString& fieldName,
+  DatasetRegistry::Association association,
+  const std::vector<double>& points) const
+{
+  TRACE_SCOPE("ProbeEngine::probePoints");
+
+  const vtkIdType nofSamples = static_cast<vtkIdType>(points.size() / 3);
+
+  const DatasetHandle dataset(
+    m_datasets,
+    m_datasets->find(fieldName, association));
+
+  if( !dataset.isValid() )
+  {
+    qWarning("No dataset '%s' to probe", qPrintable(fieldName));
+  }
+
+  ProbeSamples samples;
+  samples.m_fieldName     = fieldName;
+  samples.m_nofComponents = dataset.isValid()? dataset.getNofComponents() : 0;
+  samples.m_positions.assign(points.begin(), points.begin() + 3 * nofSamples);
+  samples.m_values.assign(
+    samples.m_nofComponents * nofSamples,
+    std::numeric_limits<double>::quiet_NaN());
+  samples.m_partIds.assign(nofSamples, -1);
+  samples.m_cellIds.assign(nofSamples, -1);
+
+  const QByteArray arrayName =
+    dataset.isValid()? QByteArray(dataset.getKey()) : QByteArray();
+
+  SampleFunctor functor(*this, arrayName, association, samples);
+
+  vtkSMPTools::For(0, nofSamples, SampleGrain, functor);
+
+  return samples;
+}
+
+//------------------------------------------------------------------------------
+
+ProbeSamples ProbeEngine::probeLine(
+  const QString& fieldName,
+  DatasetRegistry::Association association,
+  const std::vector<double>& polyline,
+  int nofSamples) const
+{
+  std::vector<double> arcLengths;
+  const std::vector<double> points =
+    SampleLine(polyline, nofSamples, arcLengths);
+
+  ProbeSamples samples = probePoints(fieldName, association, points);
+  samples.m_arcLengths = arcLengths;
+
+  return samples;
+}
+
+//------------------------------------------------------------------------------
+
+std::vector<double> ProbeEngine::SampleLine(
+  const std::vector<double>& polyline,
+  int nofSamples,
+  std::vector<double>& arcLengths)
+{
+  const int nofPoints = static_cast<int>(polyline.size() / 3);
+
+  std::vector<double> points;
+  arcLengths.clear();
+
+  if( nofPoints == 0 )
+  {
+    return points;
+  }
+
+  // Distance of every polyline point from the start
+  std::vector<double> lengths(nofPoints, 0.0);
+
+  for( int i = 1; i < nofPoints; ++i )
+  {
+    double length2 = 0.0;
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+      const double d = polyline[3*i + axis] - polyline[3*(i - 1) + axis];
+      length2 += d * d;
+    }
+
+    lengths[i] = lengths[i - 1] + std::sqrt(length2);
+  }
+
+  const double totalLength = lengths.back();
+
+  if( (nofPoints == 1) || (totalLength <= 0.0) )
+  {
+    points.assign(polyline.begin(), polyline.begin() + 3);
+    arcLengths.push_back(0.0);
+    return points;
+  }
+
+  nofSamples = std::max(nofSamples, 2);
+
+  points.resize(3 * nofSamples);
+  arcLengths.resize(nofSamples);
+
+  int segment = 1;
+
+  for( int s = 0; s < nofSamples; ++s )
+  {
+    const double length = totalLength * s / (nofSamples - 1);
+
+    while( (segment < nofPoints - 1) && (lengths[segment] < length) )
+    {
+      ++segment;
+    }
+
+    const double segmentLength = lengths[segment] - lengths[segment - 1];
+    const double t = (segmentLength > 0.0)?
+      (length - lengths[segment - 1]) / segmentLength : 0.0;
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+      const double a = polyline[3*(segment - 1) + axis];
+      const double b = polyline[3*segment + axis];
+
+      points[3*s + axis] = a + std::min(t, 1.0) * (b - a);
+    }
+
+    arcLengths[s] = length;
+  }
+
+  return points;
+}
+
+//------------------------------------------------------------------------------
+
+void ProbeEngine::buildPartGrid()
+{
+  m_bins.clear();
+
+  if( m_parts.empty() )
+  {
+    return;
+  }
+
+  for( size_t p = 0; p < m_parts.size(); ++p )
+  {
+    const double* bounds    = m_parts[p].m_bounds;
+    const double  tolerance = m_parts[p].m_tolerance;
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+      const double lo = bounds[2*axis] - tolerance;
+      const double hi = bounds[2*axis + 1] + tolerance;
+
+      m_gridBounds[2*axis] =
+        (p == 0)? lo : std::min(m_gridBounds[2*axis], lo);
+      m_gridBounds[2*axis + 1] =
+        (p == 0)? hi : std::max(m_gridBounds[2*axis + 1], hi);
+    }
+  }
+
+  // About 8 bins per part, a part usually spans a few of them
+  const int size = std::min(MaxGridSize, std::max(1, static_cast<int>(
+    std::ceil(2.0 * std::cbrt(static_cast<double>(m_parts.size()))))));
+
+  for( int axis = 0; axis < 3; ++axis )
+  {
+    const bool flat = m_gridBounds[2*axis + 1] <= m_gridBounds[2*axis];
+    m_gridSize[axis] = flat? 1 : size;
+  }
+
+  m_bins.resize(m_gridSize[0] * m_gridSize[1] * m_gridSize[2]);
+
+  for( size_t p = 0; p < m_parts.size(); ++p )
+  {
+    const double* bounds    = m_parts[p].m_bounds;
+    const double  tolerance = m_parts[p].m_tolerance;
+
+    int first[3];
+    int last[3];
+
+    for( int axis = 0; axis < 3; ++axis )
+    {
+      const double lo     = m_gridBounds[2*axis];
+      const double extent = m_gridBounds[2*axis + 1] - lo;
+      const int    n      = m_gridSize[axis];
+
+      if( extent <= 0.0 )
+      {
+        first[axis] = last[axis] = 0;
+        continue;
+      }
+
+      first[axis] = std::max(0, std::min(n - 1, static_cast<int>(
+        (bounds[2*axis] - tolerance - lo) / extent * n)));
+      last[axis]  = std::max(0, std::min(n - 1, static_cast<int>(
+        (bounds[2*axis + 1] + tolerance - lo) / extent * n)));
+    }
+
+    // Parts are added in order, every bin keeps the lowest index first
+    for( int k = first[2]; k <= last[2]; ++k )
+    {
+      for( int j = first[1]; j <= last[1]; ++j )
+      {
+        for( int i = first[0]; i <= last[0]; ++i )
+        {
+          m_bins[i + m_gridSize[0] * (j + m_gridSize[1] * k)].push_back(
+            static_cast<int>(p));
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+const std::vector<int>* ProbeEngine::findBin(const double point[3]) const
+{
+  if( m_bins.empty() || !contains(m_gridBounds, point, 0.0) )
+  {
+    return nullptr;
+  }
+
+  int index[3];
+
+  for( int axis = 0; axis < 3; ++axis )
+  {
+    const double lo     = m_gridBounds[2*axis];
+    const double extent = m_gridBounds[2*axis + 1] - lo;
+    const int    n      = m_gridSize[axis];
+
+    index[axis] = (extent > 0.0)?
+      std::min(n - 1, static_cast<int>((point[axis] - lo) / extent * n)) : 0;
+  }
+
+  const std::vector<int>& bin =
+    m_bins[index[0] + m_gridSize[0] * (index[1] + m_gridSize[1] * index[2])];
+
+  return bin.empty()? nullptr : &bin;
+}
+
+//------------------------------------------------------------------------------
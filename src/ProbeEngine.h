@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PROBEENGINE_H
+#define PROBEENGINE_H
+
+#include "DatasetRegistry.h"
+
+#include <QString>
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <memory>
+#include <vector>
+
+class vtkCellTreeLocator;
+class vtkDataSet;
+
+class Geometry;
+
+// Values of a field sampled at a batch of points, as flat arrays
+struct ProbeSamples
+{
+  ProbeSamples();
+
+  int getNofSamples() const;
+  bool isValid(int sample) const;
+
+  QString                m_fieldName;
+  int                    m_nofComponents;
+  // x, y, z of every sample
+  std::vector<double>    m_positions;
+  // Distance along the polyline, only for line probes
+  std::vector<double>    m_arcLengths;
+  // m_nofComponents per sample, NaN outside of every part
+  std::vector<double>    m_values;
+  // Index of the part in the geometry and cell of the part, -1 outside
+  std::vector<int>       m_partIds;
+  std::vector<vtkIdType> m_cellIds;
+};
+
+// Samples point and cell fields of a Geometry at many points at once. The
+// cell trees of the parts are built in parallel when the engine is created
+// (the ready PartLocator trees are reused in the GUI thread), then every
+// query finds the candidate parts of each sample in a uniform grid of part
+// bounds and runs the samples in parallel chunks. A sample inside several
+// parts takes the one with the lowest index.
+//
+// The engine keeps shallow copies of the part data and a copy of the dataset
+// registry: changes of the geometry afterwards are not seen, create a new
+// engine for them. Parts evicted by PartCache are left out. Must be created
+// in the thread that owns the geometry, queries can run in any thread.
+class ProbeEngine
+{
+public:
+  explicit ProbeEngine(const Geometry& geometry);
+  ~ProbeEngine();
+
+  int getNofParts() const;
+
+  // points holds x, y, z of every sample
+  ProbeSamples probePoints(
+    const QString& fieldName,
+    DatasetRegistry::Association association,
+    const std::vector<double>& points) const;
+
+  // nofSamples points evenly spaced along the polyline, both ends included
+  ProbeSamples probeLine(
+    const QString& fieldName,
+    DatasetRegistry::Association association,
+    const std::vector<double>& polyline,
+    int nofSamples) const;
+
+  // Polyline resampled by arc length, the distances are returned in
+  // arcLengths
+  static std::vector<double> SampleLine(
+    const std::vector<double>& polyline,
+    int nofSamples,
+    std::vector<double>& arcLengths);
+
+protected:
+  struct PartTree
+  {
+    int                                 m_index;
+    vtkSmartPointer<vtkDataSet>         m_data;
+    vtkSmartPointer<vtkCellTreeLocator> m_tree;
+    double                              m_tolerance;
+    double                              m_bounds[6];
+  };
+
+  class BuildTrees;
+  class SampleFunctor;
+
+  void buildPartGrid();
+
+  // Parts whose bounds may hold the point, null outside of every part
+  const std::vector<int>* findBin(const double point[3]) const;
+
+  std::vector<PartTree>                  m_parts;
+  std::shared_ptr<const DatasetRegistry> m_datasets;
+
+  // Uniform grid over the bounds of every part, each bin lists the parts
+  // whose bounds overlap it
+  double                        m_gridBounds[6];
+  int                           m_gridSize[3];
+  std::vector<std::vector<int>> m_bins;
+};
+
+#endif // PROBEENGINE_H
@@ -0,0 +1,374 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "ProbeRunner.h"
+
+#include "Geometry.h"
+#include "GeometryFactory.h"
+#include "GeometryPart.h"
+#include "ProbeEngine.h"
+#include "Tracer.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QRegExp>
+#include <QTextStream>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+bool writeSamples(
+  const QString& fileName,
+  const Geometry& geom,
+  const ProbeSamples& samples)
+{
+  QFile file(fileName);
+
+  if( !file.open(QIODevice::WriteOnly | QIODevice::Text) )
+  {
+    qWarning("Could not write '%s'", qPrintable(fileName));
+    return false;
+  }
+
+  QTextStream out(&file);
+  out.setRealNumberPrecision(10);
+
+  out << "sample,arc_length,x,y,z,part,part_name,cell";
+
+  for( int c = 0; c < samples.m_nofComponents; ++c )
+  {
+    out << "," << samples.m_fieldName;
+
+    if( samples.m_nofComponents > 1 )
+    {
+      out << "_" << c;
+    }
+  }
+
+  out << "\n";
+
+  const bool line = !samples.m_arcLengths.empty();
+
+  for( int s = 0; s < samples.getNofSamples(); ++s )
+  {
+    QString partName;
+
+    if( samples.isValid(s) )
+    {
+      if( auto part = geom.getPart(samples.m_partIds[s]).lock() )
+      {
+        partName = part->getPartName();
+      }
+    }
+
+    out << s << ","
+        << (line? samples.m_arcLengths[s] : 0.0) << ","
+        << samples.m_positions[3*s] << ","
+        << samples.m_positions[3*s + 1] << ","
+        << samples.m_positions[3*s + 2] << ","
+        << samples.m_partIds[s] << ","
+        << partName << ","
+        << samples.m_cellIds[s];
+
+    for( int c = 0; c < samples.m_nofComponents; ++c )
+    {
+      // NaN outside of every part, empty in the CSV
+      const double value = samples.m_values[s * samples.m_nofComponents + c];
+
+      out << ",";
+
+      if( !std::isnan(value) )
+      {
+        out << value;
+      }
+    }
+
+    out << "\n";
+  }
+
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+ProbeRunner::Job::Job()
+  :
+  m_nofSamples(1),
+  m_pointBatch(false)
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool ProbeRunner::ReadJobFile(const QString& fileName, QList<Job>& jobs)
+{
+  QFile file(fileName);
+
+  if( !file.open(QIODevice::ReadOnly | QIODevice::Text) )
+  {
+    qWarning("Could not open job file '%s'", qPrintable(fileName));
+    return false;
+  }
+
+  // Relative paths are relative to the job file
+  const QDir baseDir = QFileInfo(fileName).absoluteDir();
+
+  QTextStream in(&file);
+  int lineNumber = 0;
+
+  while( !in.atEnd() )
+  {
+    const QString line = in.readLine().trimmed();
+    ++lineNumber;
+
+    if( line.isEmpty() || line.startsWith('#') )
+    {
+      continue;
+    }
+
+    const QStringList fields = line.split(QRegExp("\\s+"));
+
+    bool ok = fields.size() >= 5;
+
+    Job job;
+
+    if( ok )
+    {
+      job.m_geometryFile = GeometryFactory::IsProceduralSpec(fields[0])?
+        fields[0] : baseDir.absoluteFilePath(fields[0]);
+      job.m_datasetName  = fields[1];
+      job.m_nofSamples   = fields[2].toInt(&ok);
+      job.m_outputFile   = baseDir.absoluteFilePath(fields[3]);
+    }
+
+    if( ok && fields[4].startsWith('@') )
+    {
+      job.m_pointBatch = true;
+
+      ok = (fields.size() == 5) &&
+        ReadPoints(baseDir.absoluteFilePath(fields[4].mid(1)), job.m_points);
+    }
+    else if( ok )
+    {
+      ok = ((fields.size() - 4) % 3) == 0;
+
+      for( int i = 4; ok && (i < fields.size()); ++i )
+      {
+        job.m_points.push_back(fields[i].toDouble(&ok));
+      }
+    }
+
+    if( !ok || (job.m_nofSamples < 1) || job.m_points.empty() )
+    {
+      qWarning("%s:%d: expected 'geometry dataset samples output "
+               "x y z [x y z ...]' or 'geometry dataset samples output @file'",
+        qPrintable(fileName), lineNumber);
+      return false;
+    }
+
+    jobs << job;
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+int ProbeRunner::run(const QList<Job>& jobs)
+{
+  QMap<QString, QList<Job>> jobsPerGeometry;
+
+  for( const Job& job : jobs )
+  {
+    jobsPerGeometry[job.m_geometryFile] << job;
+  }
+
+  int nofFailures = 0;
+
+  QElapsedTimer timer;
+
+  for( const QList<Job>& geometryJobs : jobsPerGeometry )
+  {
+    timer.start();
+
+    const QString& source = geometryJobs.first().m_geometryFile;
+
+    std::shared_ptr<Geometry> geom =
+      GeometryFactory::IsProceduralSpec(source)?
+        GeometryFactory::CreateProceduralGeometry(source) :
+        GeometryFactory::CreateGeometryFromFile(source);
+
+    if( !geom )
+    {
+      qWarning("Could not read '%s'", qPrintable(source));
+
+      nofFailures += geometryJobs.size();
+      continue;
+    }
+
+    geom->waitForLoaded();
+
+    const ProbeEngine engine(*geom);
+
+    std::printf("%s: %d parts prepared in %.3f s\n",
+      qPrintable(source),
+      engine.getNofParts(),
+      timer.restart() / 1000.0);
+
+    for( const Job& job : geometryJobs )
+    {
+      const DatasetHandle dataset = geom->findDataset(job.m_datasetName);
+
+      if( !dataset.isValid() )
+      {
+        qWarning("No dataset '%s' in '%s'",
+          qPrintable(job.m_datasetName),
+          qPrintable(source));
+
+        ++nofFailures;
+        continue;
+      }
+
+      const bool line = !job.m_pointBatch && (job.m_points.size() > 3);
+
+      const ProbeSamples samples = line?
+        engine.probeLine(
+          job.m_datasetName,
+          dataset.getAssociation(),
+          job.m_points,
+          job.m_nofSamples) :
+        engine.probePoints(
+          job.m_datasetName,
+          dataset.getAssociation(),
+          job.m_points);
+
+      const bool ok = writeSamples(job.m_outputFile, *geom, samples);
+
+      int nofHits = 0;
+
+      for( int s = 0; s < samples.getNofSamples(); ++s )
+      {
+        nofHits += samples.isValid(s)? 1 : 0;
+      }
+
+      std::printf("%s %s (%s, %d of %d samples inside) in %.3f s\n",
+        ok? "probed" : "FAILED",
+        qPrintable(job.m_outputFile),
+        qPrintable(job.m_datasetName),
+        nofHits,
+        samples.getNofSamples(),
+        timer.restart() / 1000.0);
+
+      nofFailures += ok? 0 : 1;
+    }
+  }
+
+  std::fflush(stdout);
+
+  return nofFailures;
+}
+
+//------------------------------------------------------------------------------
+
+int ProbeRunner::Main(const QStringList& arguments)
+{
+  const int probeIndex = arguments.indexOf("--probe");
+
+  if( (probeIndex < 0) || (probeIndex + 1 >= arguments.size()) )
+  {
+    qWarning("Usage: %s --probe <job file>", qPrintable(arguments.value(0)));
+    return 1;
+  }
+
+  QList<Job> jobs;
+
+  if( !ReadJobFile(arguments[probeIndex + 1], jobs) )
+  {
+    return 1;
+  }
+
+  ProbeRunner runner;
+
+  return (runner.run(jobs) == 0)? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+
+bool ProbeRunner::ReadPoints(
+  const QString& fileName,
+  std::vector<double>& points)
+{
+  QFile file(fileName);
+
+  if( !file.open(QIODevice::ReadOnly | QIODevice::Text) )
+  {
+    qWarning("Could not open points file '%s'", qPrintable(fileName));
+    return false;
+  }
+
+  QTextStream in(&file);
+
+  while( !in.atEnd() )
+  {
+    const QString line = in.readLine().trimmed();
+
+    if( line.isEmpty() || line.startsWith('#') )
+    {
+      continue;
+    }
+
+    const QStringList fields = line.split(QRegExp("[\\s,]+"));
+
+    if( fields.size() != 3 )
+    {
+      qWarning("%s: expected 'x y z' lines", qPrintable(fileName));
+      return false;
+    }
+
+    for( const QString& field : fields )
+    {
+      bool ok = false;
+      points.push_back(field.toDouble(&ok));
+
+      if( !ok )
+      {
+        qWarning("%s: expected 'x y z' lines", qPrintable(fileName));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
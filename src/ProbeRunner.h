@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PROBERUNNER_H
+#define PROBERUNNER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+// Headless probing of a job file to CSV files, see ProbeEngine. Each line of
+// the job file is a probe:
+//
+//   # geometry       dataset   samples  output file   points (x y z ...)
+//   data/engine.vtm  Pressure  200      out/axis.csv  0 0 -1  0 0 1
+//   data/engine.vtm  Pressure  1        out/taps.csv  @taps.txt
+//
+// One point is a point probe, several points are a polyline sampled at the
+// given count. "@file" reads a batch of point probes, x y z per line. The
+// probes of a geometry share its cell trees, the geometry is read once.
+class ProbeRunner
+{
+public:
+  struct Job
+  {
+    Job();
+
+    QString             m_geometryFile;
+    QString             m_datasetName;
+    int                 m_nofSamples;
+    QString             m_outputFile;
+    std::vector<double> m_points;
+    bool                m_pointBatch;
+  };
+
+  static bool ReadJobFile(const QString& fileName, QList<Job>& jobs);
+
+  // Runs every probe and prints a report, returns the number of failures
+  int run(const QList<Job>& jobs);
+
+  // Entry point of the --probe command line mode
+  static int Main(const QStringList& arguments);
+
+protected:
+  static bool ReadPoints(const QString& fileName, std::vector<double>& points);
+};
+
+#endif // PROBERUNNER_H
@@ -0,0 +1,637 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "ProceduralGeometry.h"
+
+#include "Tracer.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+const double Pi = 3.14159265358979323846;
+
+// Analytic fields, one period per unit length
+inline float scalarField(const float x[3])
+{
+  return static_cast<float>(
+    std::sin(2.0 * Pi * x[0]) * std::cos(2.0 * Pi * x[1]) + 0.5 * x[2]);
+}
+
+inline void velocityField(const float x[3], float v[3])
+{
+  v[0] = -x[1];
+  v[1] =  x[0];
+  v[2] = static_cast<float>(0.25 * std::sin(Pi * x[2]));
+}
+
+//------------------------------------------------------------------------------
+
+struct GridSize
+{
+  vtkIdType m_nofCells[3];
+  double    m_bounds[6];
+
+  vtkIdType getNofPoints(int axis) const
+  {
+    return m_nofCells[axis] + 1;
+  }
+
+  vtkIdType getNofPoints() const
+  {
+    return getNofPoints(0) * getNofPoints(1) * getNofPoints(2);
+  }
+
+  vtkIdType getNofCells() const
+  {
+    return m_nofCells[0] * m_nofCells[1] * m_nofCells[2];
+  }
+
+  vtkIdType getPointId(vtkIdType i, vtkIdType j, vtkIdType k) const
+  {
+    return i + getNofPoints(0) * (j + getNofPoints(1) * k);
+  }
+};
+
+// Cells per axis proportional to the box extents
+GridSize computeGridSize(vtkIdType nofCells, const double bounds[6])
+{
+  GridSize size;
+  std::copy(bounds, bounds + 6, size.m_bounds);
+
+  double lengths[3];
+  double volume = 1.0;
+
+  for( int axis = 0; axis < 3; ++axis )
+  {
+    lengths[axis] = std::max(bounds[2*axis + 1] - bounds[2*axis], 1e-12);
+    volume *= lengths[axis];
+  }
+
+  const double cellsPerLength =
+    std::cbrt(std::max(static_cast<double>(nofCells), 1.0) / volume);
+
+  for( int axis = 0; axis < 3; ++axis )
+  {
+    size.m_nofCells[axis] = std::max<vtkIdType>(1,
+      static_cast<vtkIdType>(std::llround(lengths[axis] * cellsPerLength)));
+  }
+
+  return size;
+}
+
+//------------------------------------------------------------------------------
+
+class GridPointsFiller
+{
+public:
+  GridPointsFiller(const GridSize& size, float* points)
+    :
+    m_size(size),
+    m_points(points)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    const vtkIdType nx = m_size.getNofPoints(0);
+    const vtkIdType ny = m_size.getNofPoints(1);
+
+    for( vtkIdType id = begin; id < end; ++id )
+    {
+      const vtkIdType index[3] = {id % nx, (id / nx) % ny, id / (nx * ny)};
+
+      for( int axis = 0; axis < 3; ++axis )
+      {
+        const double t =
+          static_cast<double>(index[axis]) / m_size.m_nofCells[axis];
+
+        m_points[3*id + axis] = static_cast<float>(
+          m_size.m_bounds[2*axis] +
+          t * (m_size.m_bounds[2*axis + 1] - m_size.m_bounds[2*axis]));
+      }
+    }
+  }
+
+protected:
+  const GridSize& m_size;
+  float*          m_points;
+};
+
+//------------------------------------------------------------------------------
+
+// Hexahedra, or 6 tetrahedra per hexahedron sharing its main diagonal, which
+// keeps the faces of neighbour cells conforming
+class GridCellsFiller
+{
+public:
+  GridCellsFiller(const GridSize& size, bool tetrahedra, vtkIdType* cells)
+    :
+    m_size(size),
+    m_tetrahedra(tetrahedra),
+    m_cells(cells)
+  {
+  }
+
+  // Over the hexahedra of the grid
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    // Corners by bits x = 1, y = 2, z = 4. Every tetrahedron (0, a, b, 7) is
+    // ordered for a positive volume, see tests/
+    static const int HexCorners[8] = {0, 1, 3, 2, 4, 5, 7, 6};
+    static const int TetPaths[6][2] = {
+      {1, 3}, {5, 1}, {3, 2}, {2, 6}, {4, 5}, {6, 4}};
+
+    const vtkIdType nx = m_size.m_nofCells[0];
+    const vtkIdType ny = m_size.m_nofCells[1];
+
+    for( vtkIdType hex = begin; hex < end; ++hex )
+    {
+      const vtkIdType i = hex % nx;
+      const vtkIdType j = (hex / nx) % ny;
+      const vtkIdType k = hex / (nx * ny);
+
+      vtkIdType corners[8];
+
+      for( int c = 0; c < 8; ++c )
+      {
+        corners[c] = m_size.getPointId(i + (c & 1), j + ((c >> 1) & 1),
+          k + ((c >> 2) & 1));
+      }
+
+      if( m_tetrahedra )
+      {
+        vtkIdType* cell = m_cells + 30 * hex;
+
+        for( int t = 0; t < 6; ++t )
+        {
+          *cell++ = 4;
+          *cell++ = corners[0];
+          *cell++ = corners[TetPaths[t][0]];
+          *cell++ = corners[TetPaths[t][1]];
+          *cell++ = corners[7];
+        }
+      }
+      else
+      {
+        vtkIdType* cell = m_cells + 9 * hex;
+
+        *cell++ = 8;
+
+        for( int c = 0; c < 8; ++c )
+        {
+          *cell++ = corners[HexCorners[c]];
+        }
+      }
+    }
+  }
+
+protected:
+  const GridSize& m_size;
+  bool            m_tetrahedra;
+  vtkIdType*      m_cells;
+};
+
+//------------------------------------------------------------------------------
+
+// Cube faces of n x n quads, two triangles per quad, projected on the sphere
+class SphereFiller
+{
+public:
+  SphereFiller(
+    vtkIdType n,
+    const double center[3],
+    double radius,
+    float* points,
+    vtkIdType* cells)
+    :
+    m_n(n),
+    m_radius(radius),
+    m_points(points),
+    m_cells(cells)
+  {
+    std::copy(center, center + 3, m_center);
+  }
+
+  vtkIdType getNofFacePoints() const
+  {
+    return (m_n + 1) * (m_n + 1);
+  }
+
+  void fillPoints(vtkIdType begin, vtkIdType end) const
+  {
+    for( vtkIdType id = begin; id < end; ++id )
+    {
+      const int       face  = static_cast<int>(id / getNofFacePoints());
+      const vtkIdType local = id % getNofFacePoints();
+      const int       axis  = face / 2;
+
+      double p[3];
+      p[axis]           = (face % 2)? 1.0 : -1.0;
+      p[(axis + 1) % 3] = 2.0 * (local % (m_n + 1)) / m_n - 1.0;
+      p[(axis + 2) % 3] = 2.0 * (local / (m_n + 1)) / m_n - 1.0;
+
+      const double norm = std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]);
+
+      for( int c = 0; c < 3; ++c )
+      {
+        m_points[3*id + c] =
+          static_cast<float>(m_center[c] + m_radius * p[c] / norm);
+      }
+    }
+  }
+
+  void fillCells(vtkIdType begin, vtkIdType end) const
+  {
+    const vtkIdType nofFaceCells = 2 * m_n * m_n;
+
+    for( vtkIdType id = begin; id < end; ++id )
+    {
+      const int       face  = static_cast<int>(id / nofFaceCells);
+      const vtkIdType quad  = (id % nofFaceCells) / 2;
+      const vtkIdType i     = quad % m_n;
+      const vtkIdType j     = quad / m_n;
+      const vtkIdType first = face * getNofFacePoints();
+
+      const vtkIdType a = first + i + (m_n + 1) * j;
+      const vtkIdType b = a + 1;
+      const vtkIdType c = b + (m_n + 1);
+      const vtkIdType d = a + (m_n + 1);
+
+      // Outwards on every face
+      const bool flip = ((face % 2) == 0);
+      const bool second = ((id % 2) == 1);
+
+      vtkIdType* cell = m_cells + 4 * id;
+      *cell++ = 3;
+      *cell++ = a;
+      *cell++ = second? (flip? d : c) : (flip? c : b);
+      *cell++ = second? (flip? c : d) : (flip? b : c);
+    }
+  }
+
+protected:
+  vtkIdType  m_n;
+  double     m_center[3];
+  double     m_radius;
+  float*     m_points;
+  vtkIdType* m_cells;
+};
+
+class SpherePointsFunctor
+{
+public:
+  explicit SpherePointsFunctor(const SphereFiller& filler)
+    :
+    m_filler(filler)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    m_filler.fillPoints(begin, end);
+  }
+
+protected:
+  const SphereFiller& m_filler;
+};
+
+class SphereCellsFunctor
+{
+public:
+  explicit SphereCellsFunctor(const SphereFiller& filler)
+    :
+    m_filler(filler)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    m_filler.fillCells(begin, end);
+  }
+
+protected:
+  const SphereFiller& m_filler;
+};
+
+//------------------------------------------------------------------------------
+
+class PointFieldsFiller
+{
+public:
+  PointFieldsFiller(const float* points, float* scalars, float* vectors)
+    :
+    m_points(points),
+    m_scalars(scalars),
+    m_vectors(vectors)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for( vtkIdType id = begin; id < end; ++id )
+    {
+      m_scalars[id] = scalarField(m_points + 3*id);
+      velocityField(m_points + 3*id, m_vectors + 3*id);
+    }
+  }
+
+protected:
+  const float* m_points;
+  float*       m_scalars;
+  float*       m_vectors;
+};
+
+// Evaluated at the first point of every cell of a fixed size
+class CellFieldFiller
+{
+public:
+  CellFieldFiller(
+    const float* points,
+    const vtkIdType* cells,
+    vtkIdType cellSize,
+    float* scalars)
+    :
+    m_points(points),
+    m_cells(cells),
+    m_cellSize(cellSize),
+    m_scalars(scalars)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for( vtkIdType id = begin; id < end; ++id )
+    {
+      const vtkIdType point = m_cells[(m_cellSize + 1) * id + 1];
+
+      m_scalars[id] = scalarField(m_points + 3*point);
+    }
+  }
+
+protected:
+  const float*     m_points;
+  const vtkIdType* m_cells;
+  vtkIdType        m_cellSize;
+  float*           m_scalars;
+};
+
+//------------------------------------------------------------------------------
+
+class CellLocationsFiller
+{
+public:
+  CellLocationsFiller(
+    vtkIdType cellSize,
+    unsigned char cellType,
+    vtkIdType* locations,
+    unsigned char* types)
+    :
+    m_cellSize(cellSize),
+    m_cellType(cellType),
+    m_locations(locations),
+    m_types(types)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    for( vtkIdType id = begin; id < end; ++id )
+    {
+      m_locations[id] = (m_cellSize + 1) * id;
+      m_types[id]     = m_cellType;
+    }
+  }
+
+protected:
+  vtkIdType      m_cellSize;
+  unsigned char  m_cellType;
+  vtkIdType*     m_locations;
+  unsigned char* m_types;
+};
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkPoints> newFloatPoints(vtkIdType nofPoints)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(nofPoints);
+
+  return points;
+}
+
+vtkSmartPointer<vtkFloatArray> newFloatArray(
+  const char* name,
+  int nofComponents,
+  vtkIdType nofTuples)
+{
+  vtkSmartPointer<vtkFloatArray> array = vtkSmartPointer<vtkFloatArray>::New();
+  array->SetName(name);
+  array->SetNumberOfComponents(nofComponents);
+  array->SetNumberOfTuples(nofTuples);
+
+  return array;
+}
+
+void addFields(
+  vtkDataSet* data,
+  vtkPoints* points,
+  vtkIdTypeArray* cells,
+  vtkIdType cellSize)
+{
+  const vtkIdType nofPoints = points->GetNumberOfPoints();
+  const vtkIdType nofCells  = cells->GetNumberOfTuples() / (cellSize + 1);
+
+  const float* pts = static_cast<const float*>(points->GetVoidPointer(0));
+
+  vtkSmartPointer<vtkFloatArray> scalars =
+    newFloatArray("Scalar", 1, nofPoints);
+  vtkSmartPointer<vtkFloatArray> vectors =
+    newFloatArray("Velocity", 3, nofPoints);
+  vtkSmartPointer<vtkFloatArray> cellScalars =
+    newFloatArray("CellScalar", 1, nofCells);
+
+  PointFieldsFiller pointFields(
+    pts,
+    scalars->GetPointer(0),
+    vectors->GetPointer(0));
+
+  vtkSMPTools::For(0, nofPoints, pointFields);
+
+  CellFieldFiller cellFields(
+    pts,
+    cells->GetPointer(0),
+    cellSize,
+    cellScalars->GetPointer(0));
+
+  vtkSMPTools::For(0, nofCells, cellFields);
+
+  data->GetPointData()->AddArray(scalars);
+  data->GetPointData()->AddArray(vectors);
+  data->GetCellData()->AddArray(cellScalars);
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> createGrid(
+  vtkIdType nofCells,
+  const double bounds[6],
+  bool tetrahedra)
+{
+  const GridSize  size     = computeGridSize(nofCells, bounds);
+  const vtkIdType nofHexes = size.getNofCells();
+
+  const vtkIdType cellSize  = tetrahedra? 4 : 8;
+  const vtkIdType cellCount = tetrahedra? 6 * nofHexes : nofHexes;
+
+  vtkSmartPointer<vtkPoints> points = newFloatPoints(size.getNofPoints());
+
+  GridPointsFiller pointsFiller(
+    size,
+    static_cast<float*>(points->GetVoidPointer(0)));
+
+  vtkSMPTools::For(0, size.getNofPoints(), pointsFiller);
+
+  vtkSmartPointer<vtkIdTypeArray> connectivity =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues((cellSize + 1) * cellCount);
+
+  GridCellsFiller cellsFiller(size, tetrahedra, connectivity->GetPointer(0));
+
+  vtkSMPTools::For(0, nofHexes, cellsFiller);
+
+  vtkSmartPointer<vtkIdTypeArray> locations =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  locations->SetNumberOfValues(cellCount);
+
+  vtkSmartPointer<vtkUnsignedCharArray> types =
+    vtkSmartPointer<vtkUnsignedCharArray>::New();
+  types->SetNumberOfValues(cellCount);
+
+  CellLocationsFiller locationsFiller(
+    cellSize,
+    tetrahedra? VTK_TETRA : VTK_HEXAHEDRON,
+    locations->GetPointer(0),
+    types->GetPointer(0));
+
+  vtkSMPTools::For(0, cellCount, locationsFiller);
+
+  vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+  cells->SetCells(cellCount, connectivity);
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->SetCells(types, locations, cells);
+
+  addFields(grid, points, connectivity, cellSize);
+
+  return grid;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkPolyData> ProceduralGeometry::CreateSphere(
+  vtkIdType nofCells,
+  const double center[3],
+  double radius)
+{
+  TRACE_SCOPE("ProceduralGeometry::CreateSphere");
+
+  // 6 faces of n x n quads, 2 triangles per quad
+  const vtkIdType n = std::max<vtkIdType>(1, static_cast<vtkIdType>(
+    std::llround(std::sqrt(std::max<double>(nofCells, 1) / 12.0))));
+
+  const vtkIdType nofPoints    = 6 * (n + 1) * (n + 1);
+  const vtkIdType nofTriangles = 12 * n * n;
+
+  vtkSmartPointer<vtkPoints> points = newFloatPoints(nofPoints);
+
+  vtkSmartPointer<vtkIdTypeArray> connectivity =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(4 * nofTriangles);
+
+  SphereFiller filler(
+    n,
+    center,
+    radius,
+    static_cast<float*>(points->GetVoidPointer(0)),
+    connectivity->GetPointer(0));
+
+  SpherePointsFunctor pointsFunctor(filler);
+  vtkSMPTools::For(0, nofPoints, pointsFunctor);
+
+  SphereCellsFunctor cellsFunctor(filler);
+  vtkSMPTools::For(0, nofTriangles, cellsFunctor);
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  polys->SetCells(nofTriangles, connectivity);
+
+  vtkSmartPointer<vtkPolyData> sphere = vtkSmartPointer<vtkPolyData>::New();
+  sphere->SetPoints(points);
+  sphere->SetPolys(polys);
+
+  addFields(sphere, points, connectivity, 3);
+
+  return sphere;
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkUnstructuredGrid> ProceduralGeometry::CreateBox(
+  vtkIdType nofCells,
+  const double bounds[6])
+{
+  TRACE_SCOPE("ProceduralGeometry::CreateBox");
+
+  return createGrid(nofCells, bounds, false);
+}
+
+//------------------------------------------------------------------------------
+
+vtkSmartPointer<vtkUnstructuredGrid> ProceduralGeometry::CreateTetraVolume(
+  vtkIdType nofCells,
+  const double bounds[6])
+{
+  TRACE_SCOPE("ProceduralGeometry::CreateTetraVolume");
+
+  return createGrid(std::max<vtkIdType>(nofCells / 6, 1), bounds, true);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PROCEDURALGEOMETRY_H
+#define PROCEDURALGEOMETRY_H
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+class vtkPolyData;
+class vtkUnstructuredGrid;
+
+// Generated meshes of any size for stress tests, points, cells and fields
+// are filled in parallel with vtkSMPTools. Every mesh has analytic fields of
+// the world coordinates, so the parts of an assembly show continuous fields:
+// "Scalar" and "Velocity" point data and "CellScalar" cell data.
+class ProceduralGeometry
+{
+public:
+  // Cube projected on the sphere, about nofCells triangles
+  static vtkSmartPointer<vtkPolyData> CreateSphere(
+    vtkIdType nofCells,
+    const double center[3],
+    double radius);
+
+  // Hexahedra of a structured box, about nofCells cells
+  static vtkSmartPointer<vtkUnstructuredGrid> CreateBox(
+    vtkIdType nofCells,
+    const double bounds[6]);
+
+  // Structured box with every hexahedron split in 6 tetrahedra, about
+  // nofCells cells
+  static vtkSmartPointer<vtkUnstructuredGrid> CreateTetraVolume(
+    vtkIdType nofCells,
+    const double bounds[6]);
+};
+
+#endif // PROCEDURALGEOMETRY_H
@@ -0,0 +1,238 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "RedrawScheduler.h"
+
+#include "GeometryPart.h"
+#include "GeometryPartRepresentation.h"
+#include "PartCache.h"
+#include "Tracer.h"
+
+#include <QHash>
+#include <QList>
+#include <QtConcurrentMap>
+
+#include <memory>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+// Representations sharing a part also share its surface filter, so they are
+// updated in sequence by the same task.
+typedef QList<GeometryPartRepresentation*> RepresentationGroup;
+
+struct UpdatePipelines
+{
+  void operator()(RepresentationGroup& group) const
+  {
+    for( GeometryPartRepresentation* rep : group )
+    {
+      rep->updatePipeline();
+    }
+  }
+};
+
+}
+
+//------------------------------------------------------------------------------
+
+RedrawScheduler::RedrawScheduler(QObject* parent)
+  :
+  QObject(parent),
+  m_parallel(true),
+  m_nofRequests(0),
+  m_nofExecutedUpdates(0),
+  m_nofFrames(0)
+{
+  m_timer.setSingleShot(true);
+  m_timer.setInterval(16);
+
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+//------------------------------------------------------------------------------
+
+RedrawScheduler::~RedrawScheduler()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void RedrawScheduler::schedule(GeometryPartRepresentation* rep)
+{
+  ++m_nofRequests;
+
+  m_pending.insert(rep);
+
+  if( !m_timer.isActive() )
+  {
+    m_timer.start();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void RedrawScheduler::unschedule(GeometryPartRepresentation* rep)
+{
+  m_pending.remove(rep);
+}
+
+//------------------------------------------------------------------------------
+
+int RedrawScheduler::getFrameInterval() const
+{
+  return m_timer.interval();
+}
+
+//------------------------------------------------------------------------------
+
+void RedrawScheduler::setFrameInterval(int msec)
+{
+  m_timer.setInterval(msec);
+}
+
+//------------------------------------------------------------------------------
+
+bool RedrawScheduler::isParallel() const
+{
+  return m_parallel;
+}
+
+//------------------------------------------------------------------------------
+
+void RedrawScheduler::setParallel(bool on)
+{
+  m_parallel = on;
+}
+
+//------------------------------------------------------------------------------
+
+qint64 RedrawScheduler::getNofRequests() const
+{
+  return m_nofRequests;
+}
+
+//------------------------------------------------------------------------------
+
+qint64 RedrawScheduler::getNofExecutedUpdates() const
+{
+  return m_nofExecutedUpdates;
+}
+
+//------------------------------------------------------------------------------
+
+qint64 RedrawScheduler::getNofCoalescedUpdates() const
+{
+  return m_nofRequests - m_nofExecutedUpdates;
+}
+
+//------------------------------------------------------------------------------
+
+qint64 RedrawScheduler::getNofFrames() const
+{
+  return m_nofFrames;
+}
+
+//------------------------------------------------------------------------------
+
+void RedrawScheduler::resetCounters()
+{
+  m_nofRequests        = 0;
+  m_nofExecutedUpdates = 0;
+  m_nofFrames          = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void RedrawScheduler::flush()
+{
+  TRACE_SCOPE("RedrawScheduler::flush");
+
+  m_timer.stop();
+
+  if( m_pending.isEmpty() )
+  {
+    return;
+  }
+
+  QSet<GeometryPartRepresentation*> pending;
+  pending.swap(m_pending);
+
+  // Filter parameters and actor properties are set in the GUI thread, this
+  // is cheap and only marks the touched stages as modified.
+  QHash<GeometryPart*, RepresentationGroup> groups;
+  std::vector<std::shared_ptr<GeometryPart>> parts;
+
+  for( GeometryPartRepresentation* rep : pending )
+  {
+    rep->applyChanges();
+    ++m_nofExecutedUpdates;
+
+    if( auto validPart = rep->getGeometryPart().lock() )
+    {
+      if( !groups.contains(validPart.get()) )
+      {
+        parts.push_back(validPart);
+      }
+
+      groups[validPart.get()] << rep;
+    }
+  }
+
+  // The expensive part is executing the modified pipelines, which do not
+  // share any filter across parts.
+  QList<RepresentationGroup> work = groups.values();
+
+  if( m_parallel && (work.size() > 1) )
+  {
+    QtConcurrent::blockingMap(work, UpdatePipelines());
+  }
+  else
+  {
+    for( RepresentationGroup& group : work )
+    {
+      UpdatePipelines()(group);
+    }
+  }
+
+  // Decimated proxies of the new outputs are built in background
+  for( RepresentationGroup& group : work )
+  {
+    for( GeometryPartRepresentation* rep : group )
+    {
+      rep->updateLODProxies();
+    }
+  }
+
+  // The cache is updated once per frame, the workers above do not lock it
+  PartCache::Touch(parts);
+  PartCache::EnforceBudget();
+
+  ++m_nofFrames;
+
+  emit frameReady();
+}
+
+//------------------------------------------------------------------------------
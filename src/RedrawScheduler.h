@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef REDRAWSCHEDULER_H
+#define REDRAWSCHEDULER_H
+
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+class GeometryPartRepresentation;
+
+// Collects the representations of a plot that changed since the last frame
+// and brings them up to date once per frame tick, no matter how many property
+// changes each one received. Pipelines of different parts are independent and
+// are executed in parallel, then a single frameReady() asks for one render.
+class RedrawScheduler : public QObject
+{
+  Q_OBJECT
+public:
+  explicit RedrawScheduler(QObject* parent = 0);
+  virtual ~RedrawScheduler();
+
+  void schedule(GeometryPartRepresentation* rep);
+  void unschedule(GeometryPartRepresentation* rep);
+
+  int getFrameInterval() const;
+  void setFrameInterval(int msec);
+
+  bool isParallel() const;
+  void setParallel(bool on);
+
+  // Every schedule() call counts as a request, every representation brought
+  // up to date in a tick as an executed update; the difference is the work
+  // saved by coalescing.
+  qint64 getNofRequests() const;
+  qint64 getNofExecutedUpdates() const;
+  qint64 getNofCoalescedUpdates() const;
+  qint64 getNofFrames() const;
+  void resetCounters();
+
+signals:
+  void frameReady();
+
+public slots:
+  void flush();
+
+protected:
+  QSet<GeometryPartRepresentation*> m_pending;
+  QTimer                            m_timer;
+  bool                              m_parallel;
+
+  qint64 m_nofRequests;
+  qint64 m_nofExecutedUpdates;
+  qint64 m_nofFrames;
+};
+
+#endif // REDRAWSCHEDULER_H
@@ -0,0 +1,653 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "TimeSeriesPlayer.h"
+
+#include "Geometry.h"
+#include "GeometryLoader.h"
+#include "Tracer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QXmlStreamReader>
+
+#include <vtkCellData.h>
+#include <vtkDataSet.h>
+#include <vtkPointData.h>
+
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+
+class TimeSeriesPlayer::StepReader : public QRunnable
+{
+public:
+  StepReader(TimeSeriesPlayer* player, int position)
+    :
+    m_player(player),
+    m_position(position),
+    m_step(player->stepAt(position)),
+    m_info(player->m_steps[m_step]),
+    m_precision(player->m_geometry?
+      player->m_geometry->getPrecisionPolicy() : PrecisionPolicy())
+  {
+  }
+
+  virtual void run()
+  {
+    // The playback may have moved on while this read was queued
+    if( m_player->m_cancelled || !m_player->isWanted(m_position) )
+    {
+      return;
+    }
+
+    m_player->stepRead(m_position, ReadStep(m_step, m_info, m_precision));
+
+    QMetaObject::invokeMethod(m_player, "stepLoaded", Qt::QueuedConnection);
+  }
+
+protected:
+  TimeSeriesPlayer* m_player;
+  int               m_position;
+  int               m_step;
+  StepInfo          m_info;
+  PrecisionPolicy   m_precision;
+};
+
+//------------------------------------------------------------------------------
+
+TimeStepData::TimeStepData()
+  :
+  m_step(-1)
+{
+}
+
+//------------------------------------------------------------------------------
+
+TimeSeriesPlayer::Slot::Slot()
+  :
+  m_position(-1),
+  m_state(EMPTY_SLOT)
+{
+}
+
+//------------------------------------------------------------------------------
+
+TimeSeriesPlayer::TimeSeriesPlayer(
+  const QList<StepInfo>& steps,
+  Geometry* geometry)
+  :
+  QObject(geometry),
+  m_geometry(geometry),
+  m_steps(steps),
+  m_slots(8),
+  m_cancelled(false),
+  m_position(-1),
+  m_clockPosition(0),
+  m_seekPosition(-1),
+  m_prefetchEnd(-1),
+  m_frameRate(10.0),
+  m_looping(true),
+  m_nofShownSteps(0),
+  m_nofSkippedSteps(0),
+  m_nofStalls(0)
+{
+  // The other cores are left for the banding of the shown step
+  m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+
+  if( m_geometry )
+  {
+    QList<double> timeValues;
+
+    for( const StepInfo& info : m_steps )
+    {
+      timeValues << info.m_time;
+    }
+
+    m_geometry->setTimeValues(timeValues);
+
+    connect(
+      this,       SIGNAL(firstStepShown()),
+      m_geometry, SIGNAL(loadFinished()));
+  }
+
+  if( !m_steps.isEmpty() )
+  {
+    seek(0);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+TimeSeriesPlayer::~TimeSeriesPlayer()
+{
+  m_cancelled = true;
+  m_pool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+
+QList<TimeSeriesPlayer::StepInfo> TimeSeriesPlayer::ReadStepList(
+  const QString& fileName)
+{
+  QFile file(fileName);
+
+  if( !file.open(QIODevice::ReadOnly) )
+  {
+    return QList<StepInfo>();
+  }
+
+  const QDir baseDir = QFileInfo(fileName).absoluteDir();
+
+  // Several DataSets with the same timestep are parts of the same step
+  QMap<double, QStringList> files;
+
+  QXmlStreamReader xml(&file);
+
+  while( !xml.atEnd() )
+  {
+    xml.readNext();
+
+    if( !xml.isStartElement() || (xml.name() != QLatin1String("DataSet")) )
+    {
+      continue;
+    }
+
+    const QXmlStreamAttributes attributes = xml.attributes();
+    const QString file = attributes.value(QLatin1String("file")).toString();
+
+    if( file.isEmpty() )
+    {
+      continue;
+    }
+
+    const double time =
+      attributes.value(QLatin1String("timestep")).toString().toDouble();
+
+    files[time] << baseDir.absoluteFilePath(file);
+  }
+
+  if( xml.hasError() )
+  {
+    qWarning("Error parsing '%s': %s",
+      qPrintable(fileName),
+      qPrintable(xml.errorString()));
+  }
+
+  QList<StepInfo> steps;
+
+  for( auto it = files.constBegin(); it != files.constEnd(); ++it )
+  {
+    StepInfo info;
+    info.m_time      = it.key();
+    info.m_fileNames = it.value();
+
+    steps << info;
+  }
+
+  return steps;
+}
+
+//------------------------------------------------------------------------------
+
+TimeStepData TimeSeriesPlayer::ReadStep(
+  int step,
+  const StepInfo& info,
+  const PrecisionPolicy& precision)
+{
+  TRACE_SCOPE("TimeSeriesPlayer::ReadStep");
+
+  TimeStepData data;
+  data.m_step = step;
+
+  ArrayRangeEngine rangeEngine;
+
+  for( const QString& fileName : info.m_fileNames )
+  {
+    for( const auto& block : GeometryLoader::ReadBlockList(fileName) )
+    {
+      vtkSmartPointer<vtkDataSet> blockData = GeometryLoader::ReadBlock(block);
+
+      if( !blockData )
+      {
+        qWarning("Could not read block '%s' of time step %d",
+          qPrintable(block.m_name), step);
+        continue;
+      }
+
+      // The block was just read, it shares no points or attributes with
+      // another dataset
+      const qint64 savedBytes =
+        PrecisionConverter::ConvertToSingle(blockData, precision);
+
+      // Ranges are computed here so showing the step does not scan the arrays
+      // in the GUI thread
+      for( const ArrayRange& range :
+           rangeEngine.computeRanges(blockData->GetPointData()) )
+      {
+        data.m_pointRanges.push_back(range);
+      }
+
+      for( const ArrayRange& range :
+           rangeEngine.computeRanges(blockData->GetCellData()) )
+      {
+        data.m_cellRanges.push_back(range);
+      }
+
+      data.m_names << block.m_name;
+      data.m_blocks.push_back(blockData);
+      data.m_savedBytes.push_back(savedBytes);
+    }
+  }
+
+  return data;
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::getNofSteps() const
+{
+  return m_steps.size();
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::getCurrentStep() const
+{
+  return m_geometry? m_geometry->getTimeStep() : -1;
+}
+
+//------------------------------------------------------------------------------
+
+bool TimeSeriesPlayer::isPlaying() const
+{
+  return m_timer.isActive();
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::getBufferSize() const
+{
+  return static_cast<int>(m_slots.size());
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::setBufferSize(int nofSteps)
+{
+  nofSteps = std::max(1, nofSteps);
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    if( nofSteps == static_cast<int>(m_slots.size()) )
+    {
+      return;
+    }
+
+    // Reads in flight find their slot gone and drop the data
+    m_slots.clear();
+    m_slots.resize(nofSteps);
+  }
+
+  prefetch((m_seekPosition >= 0)? m_seekPosition - 1 : m_position);
+}
+
+//------------------------------------------------------------------------------
+
+double TimeSeriesPlayer::getFrameRate() const
+{
+  return m_frameRate;
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::setFrameRate(double stepsPerSecond)
+{
+  if( stepsPerSecond <= 0.0 )
+  {
+    return;
+  }
+
+  const bool playing = isPlaying();
+
+  if( playing )
+  {
+    pause();
+  }
+
+  m_frameRate = stepsPerSecond;
+
+  if( playing )
+  {
+    play();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+bool TimeSeriesPlayer::isLooping() const
+{
+  return m_looping;
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::setLooping(bool on)
+{
+  m_looping = on;
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::getNofShownSteps() const
+{
+  return m_nofShownSteps;
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::getNofSkippedSteps() const
+{
+  return m_nofSkippedSteps;
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::getNofStalls() const
+{
+  return m_nofStalls;
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::play()
+{
+  if( m_steps.size() < 2 )
+  {
+    return;
+  }
+
+  // Restart from the beginning once the last step has been played
+  if( !m_looping && (m_seekPosition < 0) &&
+      (m_position >= m_steps.size() - 1) )
+  {
+    seek(0);
+  }
+
+  m_clockPosition = (m_seekPosition >= 0)? m_seekPosition : m_position;
+  m_clock.start();
+
+  m_timer.start(std::max(1, static_cast<int>(1000.0 / m_frameRate)));
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::pause()
+{
+  m_timer.stop();
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::seek(int step)
+{
+  if( (step < 0) || (step >= m_steps.size()) )
+  {
+    return;
+  }
+
+  // Nothing is shown at the new position until its step has been read
+  m_position      = step - 1;
+  m_seekPosition  = step;
+  m_clockPosition = step;
+  m_clock.start();
+
+  prefetch(m_position);
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::waitForCurrentStep()
+{
+  m_pool.waitForDone();
+
+  stepLoaded();
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::tick()
+{
+  const int nofSteps = m_steps.size();
+
+  int target = m_clockPosition +
+    static_cast<int>(std::floor(m_clock.elapsed() * m_frameRate / 1000.0));
+
+  if( !m_looping )
+  {
+    target = std::min(target, nofSteps - 1);
+  }
+
+  if( target <= m_position )
+  {
+    return;
+  }
+
+  // The newest step that is ready up to the clock, the ones before it are
+  // skipped
+  for( int position = target; position > m_position; --position )
+  {
+    TimeStepData data;
+
+    if( takeReadyStep(position, data) )
+    {
+      m_nofSkippedSteps += position - m_position - 1;
+
+      showStep(position, data);
+      prefetch(m_position);
+
+      if( !m_looping && (m_position >= nofSteps - 1) )
+      {
+        pause();
+        emit playbackFinished();
+      }
+
+      return;
+    }
+  }
+
+  ++m_nofStalls;
+
+  // The clock went past every step being read, read from the clock on. The
+  // window is only moved then, so the reads get the whole buffer to finish.
+  if( target > m_prefetchEnd )
+  {
+    prefetch(target - 1);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::stepLoaded()
+{
+  if( m_seekPosition < 0 )
+  {
+    return;
+  }
+
+  TimeStepData data;
+
+  if( takeReadyStep(m_seekPosition, data) )
+  {
+    showStep(m_seekPosition, data);
+    prefetch(m_position);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::stepAt(int position) const
+{
+  return position % m_steps.size();
+}
+
+//------------------------------------------------------------------------------
+
+int TimeSeriesPlayer::getPrefetchDepth() const
+{
+  const int nofSlots = static_cast<int>(m_slots.size());
+
+  // A loop shorter than the buffer would read the same steps twice
+  if( m_looping )
+  {
+    return std::min(nofSlots, std::max(1, m_steps.size() - 1));
+  }
+
+  return nofSlots;
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::prefetch(int position)
+{
+  QList<int> positions;
+
+  {
+    QMutexLocker locker(&m_mutex);
+
+    const int nofSlots = static_cast<int>(m_slots.size());
+    const int depth    = getPrefetchDepth();
+
+    m_prefetchEnd = position + depth;
+
+    // Consecutive positions never share a slot within the buffer size
+    for( int p = position + 1; p <= position + depth; ++p )
+    {
+      if( !m_looping && (p >= m_steps.size()) )
+      {
+        break;
+      }
+
+      Slot& slot = m_slots[p % nofSlots];
+
+      if( slot.m_position == p )
+      {
+        continue;
+      }
+
+      slot.m_position = p;
+      slot.m_state    = LOADING_SLOT;
+      slot.m_data     = TimeStepData();
+
+      positions << p;
+    }
+  }
+
+  for( int p : positions )
+  {
+    m_pool.start(new StepReader(this, p));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+bool TimeSeriesPlayer::isWanted(int position)
+{
+  QMutexLocker locker(&m_mutex);
+
+  const Slot& slot = m_slots[position % m_slots.size()];
+
+  return (slot.m_position == position) && (slot.m_state == LOADING_SLOT);
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::stepRead(int position, TimeStepData data)
+{
+  QMutexLocker locker(&m_mutex);
+
+  Slot& slot = m_slots[position % m_slots.size()];
+
+  if( (slot.m_position == position) && (slot.m_state == LOADING_SLOT) )
+  {
+    slot.m_state = READY_SLOT;
+    slot.m_data  = std::move(data);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+bool TimeSeriesPlayer::takeReadyStep(int position, TimeStepData& data)
+{
+  QMutexLocker locker(&m_mutex);
+
+  Slot& slot = m_slots[position % m_slots.size()];
+
+  if( (slot.m_position != position) || (slot.m_state != READY_SLOT) )
+  {
+    return false;
+  }
+
+  // Once shown the data is owned by the parts, the slot is free again
+  data = std::move(slot.m_data);
+  slot = Slot();
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+void TimeSeriesPlayer::showStep(int position, const TimeStepData& data)
+{
+  TRACE_SCOPE("TimeSeriesPlayer::showStep");
+
+  const bool firstStep = (m_nofShownSteps == 0);
+
+  m_position = position;
+
+  if( m_seekPosition <= position )
+  {
+    m_seekPosition = -1;
+  }
+
+  m_geometry->setTimeStepData(data);
+
+  ++m_nofShownSteps;
+
+  emit stepShown(data.m_step);
+
+  if( firstStep )
+  {
+    emit firstStepShown();
+  }
+}
+
+//------------------------------------------------------------------------------
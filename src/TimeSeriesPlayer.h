@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef TIMESERIESPLAYER_H
+#define TIMESERIESPLAYER_H
+
+#include "ArrayRangeEngine.h"
+#include "PrecisionConverter.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <vector>
+
+class vtkDataSet;
+
+class Geometry;
+
+// The data of every part of a Geometry at one time step, matched to the parts
+// by block name
+struct TimeStepData
+{
+  TimeStepData();
+
+  int                                      m_step;
+  QStringList                              m_names;
+  std::vector<vtkSmartPointer<vtkDataSet>> m_blocks;
+  std::vector<qint64>                      m_savedBytes;  // Per block
+  std::vector<ArrayRange>                  m_pointRanges;
+  std::vector<ArrayRange>                  m_cellRanges;
+};
+
+// Plays the time steps of a transient Geometry. The steps ahead of the
+// current one are read by a worker pool into a ring buffer of a fixed number
+// of slots, so memory does not depend on the number of steps. Playback
+// follows the wall clock: when reading falls behind the frame rate, the
+// steps that are not ready in time are skipped.
+class TimeSeriesPlayer : public QObject
+{
+  Q_OBJECT
+public:
+  struct StepInfo
+  {
+    double      m_time;
+    QStringList m_fileNames;
+  };
+
+  // ParaView collection (.pvd), the files of each time step are grouped
+  static QList<StepInfo> ReadStepList(const QString& fileName);
+
+  explicit TimeSeriesPlayer(const QList<StepInfo>& steps, Geometry* geometry);
+  virtual ~TimeSeriesPlayer();
+
+  int getNofSteps() const;
+  int getCurrentStep() const;
+  bool isPlaying() const;
+
+  // Number of steps read ahead of the current one
+  int getBufferSize() const;
+  void setBufferSize(int nofSteps);
+
+  double getFrameRate() const;
+  void setFrameRate(double stepsPerSecond);
+
+  bool isLooping() const;
+  void setLooping(bool on);
+
+  // Blocks until the pending reads are done and shows the requested step
+  void waitForCurrentStep();
+
+  int getNofShownSteps() const;
+  int getNofSkippedSteps() const;
+  int getNofStalls() const;
+
+public slots:
+  void play();
+  void pause();
+  void seek(int step);
+
+signals:
+  void stepShown(int step);
+  void firstStepShown();
+  void playbackFinished();
+
+protected slots:
+  void tick();
+  void stepLoaded();
+
+protected:
+  class StepReader;
+
+  enum SlotState
+  {
+    EMPTY_SLOT,
+    LOADING_SLOT,
+    READY_SLOT
+  };
+
+  struct Slot
+  {
+    Slot();
+
+    int          m_position;
+    SlotState    m_state;
+    TimeStepData m_data;
+  };
+
+  // The blocks are converted to the precision of the geometry, in the
+  // reading thread
+  static TimeStepData ReadStep(
+    int step,
+    const StepInfo& info,
+    const PrecisionPolicy& precision);
+
+  int stepAt(int position) const;
+  int getPrefetchDepth() const;
+  void prefetch(int position);
+  bool isWanted(int position);
+  void stepRead(int position, TimeStepData data);
+  bool takeReadyStep(int position, TimeStepData& data);
+  void showStep(int position, const TimeStepData& data);
+
+  Geometry*       m_geometry;
+  QList<StepInfo> m_steps;
+  QThreadPool     m_pool;
+  QTimer          m_timer;
+  QElapsedTimer   m_clock;
+
+  QMutex            m_mutex;
+  std::vector<Slot> m_slots;
+  std::atomic<bool> m_cancelled;
+
+  // Positions keep counting while looping, the step is position % nofSteps
+  int    m_position;
+  int    m_clockPosition;
+  int    m_seekPosition;
+  int    m_prefetchEnd;
+  double m_frameRate;
+  bool   m_looping;
+
+  int m_nofShownSteps;
+  int m_nofSkippedSteps;
+  int m_nofStalls;
+};
+
+#endif // TIMESERIESPLAYER_H
@@ -0,0 +1,290 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "Tracer.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+struct TraceEvent
+{
+  const char* m_name;
+  qint64      m_begin;
+  qint64      m_duration;
+};
+
+// Only the owning thread appends, the mutex is uncontended except while a
+// trace is being written or cleared
+struct ThreadBuffer
+{
+  QMutex                  m_mutex;
+  int                     m_id;
+  QString                 m_name;
+  std::vector<TraceEvent> m_events;
+};
+
+// Buffers are kept after their thread finishes so short lived pool threads
+// still show up in the trace
+struct TraceRegistry
+{
+  QMutex                                     m_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+TraceRegistry& getRegistry()
+{
+  static TraceRegistry registry;
+  return registry;
+}
+
+const std::chrono::steady_clock::time_point s_epoch =
+  std::chrono::steady_clock::now();
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+QString s_environmentTraceFile;
+
+ThreadBuffer& getThreadBuffer()
+{
+  if( !t_buffer )
+  {
+    TraceRegistry& registry = getRegistry();
+
+    QMutexLocker locker(&registry.m_mutex);
+
+    std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+    buffer->m_id = static_cast<int>(registry.m_buffers.size()) + 1;
+
+    QThread* thread = QThread::currentThread();
+
+    if( QCoreApplication::instance() &&
+        (thread == QCoreApplication::instance()->thread()) )
+    {
+      buffer->m_name = "GUI";
+    }
+    else if( thread && !thread->objectName().isEmpty() )
+    {
+      buffer->m_name = thread->objectName();
+    }
+    else
+    {
+      buffer->m_name = QString("Worker %1").arg(buffer->m_id);
+    }
+
+    t_buffer = buffer.get();
+    registry.m_buffers.push_back(std::move(buffer));
+  }
+
+  return *t_buffer;
+}
+
+QString escapeJson(const QString& text)
+{
+  QString escaped;
+  escaped.reserve(text.size());
+
+  for( const QChar c : text )
+  {
+    if( (c == '"') || (c == '\\') )
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if( c.unicode() < 0x20 )
+    {
+      escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+    }
+    else
+    {
+      escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+std::atomic<bool> Tracer::s_enabled(false);
+
+//------------------------------------------------------------------------------
+
+void Tracer::SetEnabled(bool enabled)
+{
+  s_enabled.store(enabled);
+}
+
+//------------------------------------------------------------------------------
+
+void Tracer::Clear()
+{
+  TraceRegistry& registry = getRegistry();
+
+  QMutexLocker locker(&registry.m_mutex);
+
+  for( auto& buffer : registry.m_buffers )
+  {
+    QMutexLocker bufferLocker(&buffer->m_mutex);
+    buffer->m_events.clear();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+qint64 Tracer::Now()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+//------------------------------------------------------------------------------
+
+void Tracer::AddEvent(const char* name, qint64 begin, qint64 end)
+{
+  ThreadBuffer& buffer = getThreadBuffer();
+
+  QMutexLocker locker(&buffer.m_mutex);
+
+  TraceEvent event;
+  event.m_name     = name;
+  event.m_begin    = begin;
+  event.m_duration = end - begin;
+
+  buffer.m_events.push_back(event);
+}
+
+//------------------------------------------------------------------------------
+
+int Tracer::GetNofEvents()
+{
+  TraceRegistry& registry = getRegistry();
+
+  QMutexLocker locker(&registry.m_mutex);
+
+  int nofEvents = 0;
+
+  for( auto& buffer : registry.m_buffers )
+  {
+    QMutexLocker bufferLocker(&buffer->m_mutex);
+    nofEvents += static_cast<int>(buffer->m_events.size());
+  }
+
+  return nofEvents;
+}
+
+//------------------------------------------------------------------------------
+
+bool Tracer::WriteChromeTrace(const QString& fileName)
+{
+  QFile file(fileName);
+
+  if( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) )
+  {
+    qWarning("Could not write trace '%s'", qPrintable(fileName));
+    return false;
+  }
+
+  const qint64 pid = QCoreApplication::applicationPid();
+
+  QTextStream out(&file);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  TraceRegistry& registry = getRegistry();
+
+  QMutexLocker locker(&registry.m_mutex);
+
+  bool first = true;
+
+  for( auto& buffer : registry.m_buffers )
+  {
+    QMutexLocker bufferLocker(&buffer->m_mutex);
+
+    out << (first ? "\n" : ",\n")
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+        << ",\"tid\":" << buffer->m_id
+        << ",\"args\":{\"name\":\"" << escapeJson(buffer->m_name) << "\"}}";
+
+    first = false;
+
+    for( const TraceEvent& event : buffer->m_events )
+    {
+      out << ",\n{\"name\":\"" << escapeJson(event.m_name)
+          << "\",\"ph\":\"X\",\"ts\":" << event.m_begin
+          << ",\"dur\":" << event.m_duration
+          << ",\"pid\":" << pid
+          << ",\"tid\":" << buffer->m_id << "}";
+    }
+  }
+
+  out << "\n]}\n";
+  out.flush();
+
+  return (file.error() == QFile::NoError);
+}
+
+//------------------------------------------------------------------------------
+
+void Tracer::StartFromEnvironment()
+{
+  const QByteArray fileName = qgetenv("QTVTK_TRACE");
+
+  if( fileName.isEmpty() || !s_environmentTraceFile.isEmpty() )
+  {
+    return;
+  }
+
+  s_environmentTraceFile = QString::fromLocal8Bit(fileName);
+
+  SetEnabled(true);
+
+  // Runs from the QCoreApplication destructor, whatever the exit path
+  qAddPostRoutine(&Tracer::WriteEnvironmentTrace);
+}
+
+//------------------------------------------------------------------------------
+
+void Tracer::WriteEnvironmentTrace()
+{
+  SetEnabled(false);
+
+  if( WriteChromeTrace(s_environmentTraceFile) )
+  {
+    qWarning("Trace written to '%s'", qPrintable(s_environmentTraceFile));
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+
+#include <atomic>
+
+// Scoped timing of the hot paths, recorded per thread and exported as a
+// Chrome trace (chrome://tracing, ui.perfetto.dev). While disabled a scope
+// only costs a relaxed atomic load. Setting QTVTK_TRACE=<file> records the
+// whole run and writes the trace when the application exits.
+class Tracer
+{
+public:
+  static bool IsEnabled()
+  {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  static void SetEnabled(bool enabled);
+  static void Clear();
+
+  // Microseconds since the start of the process
+  static qint64 Now();
+
+  // name must outlive the tracer, i.e. a string literal
+  static void AddEvent(const char* name, qint64 begin, qint64 end);
+
+  static int GetNofEvents();
+  static bool WriteChromeTrace(const QString& fileName);
+
+  static void StartFromEnvironment();
+
+protected:
+  static void WriteEnvironmentTrace();
+
+  static std::atomic<bool> s_enabled;
+};
+
+class TraceScope
+{
+public:
+  explicit TraceScope(const char* name)
+    :
+    m_name(Tracer::IsEnabled() ? name : nullptr),
+    m_begin(m_name ? Tracer::Now() : 0)
+  {
+  }
+
+  ~TraceScope()
+  {
+    if( m_name )
+    {
+      Tracer::AddEvent(m_name, m_begin, Tracer::Now());
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  const char* m_name;
+  qint64      m_begin;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#endif // TRACER_H
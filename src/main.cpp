@@ -20,12 +20,42 @@
 // IN THE SOFTWARE.
 //------------------------------------------------------------------------------
 
+#include "BatchRenderer.h"
 #include "MainWindow.h"
+#include "MemoryGrowthDriver.h"
 #include "MyVTKApplication.h"
+#include "ProbeRunner.h"
+
+#include <cstring>
 
 int main(int argc, char** argv)
 {
+  for( int i = 1; i < argc; ++i )
+  {
+    // Headless mode, no window is created and no display is needed
+    if( std::strcmp(argv[i], "--batch") == 0 )
+    {
+      MyVTKApplication a(argc, argv, false);
+
+      return BatchRenderer::Main(a.arguments());
+    }
+
+    if( std::strcmp(argv[i], "--probe") == 0 )
+    {
+      MyVTKApplication a(argc, argv, false);
+
+      return ProbeRunner::Main(a.arguments());
+    }
+  }
+
   MyVTKApplication a(argc, argv);
+
+  // Add/remove plot cycles with memory checks, needs a display (e.g. Xvfb)
+  if( a.arguments().contains("--memory-cycles") )
+  {
+    return MemoryGrowthDriver::Main(a.arguments());
+  }
+
   MainWindow& w = MainWindow::GetWindowInstance();
   w.show();
 
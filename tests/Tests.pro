@@ -0,0 +1,49 @@
+#-------------------------------------------------------------------------------
+#
+# Copyright 2017 Edson Contreras
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+#-------------------------------------------------------------------------------
+
+# Checks of the generated meshes, the program exits with 1 when one fails.
+
+QT       += core
+
+TARGET = QtVTKViewerTests
+TEMPLATE = app
+CONFIG += console
+
+QMAKE_CXXFLAGS += -std=c++11
+
+INCLUDEPATH += \
+  ../src
+
+SOURCES += \
+  ./main.cpp \
+  ../src/PartHierarchy.cpp \
+  ../src/ProceduralGeometry.cpp \
+  ../src/Tracer.cpp
+
+HEADERS  += \
+  ../src/PartHierarchy.h \
+  ../src/ProceduralGeometry.h \
+  ../src/Tracer.h
+
+include(../vtk7.pri)
@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+// Copyright 2017 Edson Contreras
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "PartHierarchy.h"
+#include "ProceduralGeometry.h"
+
+#include <QCoreApplication>
+
+#include <vtkCellType.h>
+#include <vtkIdList.h>
+#include <vtkTetra.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <cstdio>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+int s_nofFailures = 0;
+
+void check(bool condition, const char* name)
+{
+  std::printf("%s %s\n", condition? "PASS" : "FAIL", name);
+
+  if( !condition )
+  {
+    ++s_nofFailures;
+  }
+}
+
+// Volume, Jacobian and quality filters need every tetrahedron to keep the
+// VTK orientation
+void testTetraVolumeOrientation()
+{
+  const double bounds[6] = {-1.0, 2.0, 0.0, 1.0, 0.0, 0.5};
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    ProceduralGeometry::CreateTetraVolume(6 * 4 * 3 * 2, bounds);
+
+  vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+
+  bool allTetra    = grid->GetNumberOfCells() > 0;
+  bool allPositive = allTetra;
+
+  for( vtkIdType c = 0; c < grid->GetNumberOfCells(); ++c )
+  {
+    if( grid->GetCellType(c) != VTK_TETRA )
+    {
+      allTetra = false;
+      continue;
+    }
+
+    grid->GetCellPoints(c, ids);
+
+    double p[4][3];
+
+    for( int i = 0; i < 4; ++i )
+    {
+      grid->GetPoint(ids->GetId(i), p[i]);
+    }
+
+    if( vtkTetra::ComputeVolume(p[0], p[1], p[2], p[3]) <= 0.0 )
+    {
+      allPositive = false;
+    }
+  }
+
+  check(allTetra, "CreateTetraVolume only makes tetrahedra");
+  check(allPositive, "CreateTetraVolume tetrahedra have positive volume");
+}
+
+// A row of unit boxes along x, the pick ray runs along the row from the far
+// end and must report the boxes it crosses from the nearest
+void testPartHierarchyRay()
+{
+  const int nofParts = 50;
+
+  std::vector<double> bounds;
+
+  for( int i = 0; i < nofParts; ++i )
+  {
+    const double partBounds[6] = {2.0 * i, 2.0 * i + 1.0, 0.0, 1.0, 0.0, 1.0};
+    bounds.insert(bounds.end(), partBounds, partBounds + 6);
+  }
+
+  PartHierarchy hierarchy;
+  hierarchy.build(bounds);
+
+  const double origin[3]    = {200.0, 0.5, 0.5};
+  const double direction[3] = {-180.0, 0.0, 0.0};
+
+  std::vector<PartHierarchy::RayHit> hits;
+  hierarchy.findAlongRay(origin, direction, hits);
+
+  // From x = 200 down to x = 20, parts 10 to 49
+  bool ordered = (hits.size() == 40);
+
+  for( size_t i = 0; ordered && (i < hits.size()); ++i )
+  {
+    ordered = (hits[i].m_part == nofParts - 1 - static_cast<int>(i)) &&
+              ((i == 0) || (hits[i - 1].m_t <= hits[i].m_t));
+  }
+
+  check(ordered,
+    "PartHierarchy::findAlongRay finds the crossed parts in order");
+
+  const double missOrigin[3] = {200.0, 2.0, 0.5};
+  hierarchy.findAlongRay(missOrigin, direction, hits);
+
+  check(hits.empty(), "PartHierarchy::findAlongRay misses parts off the ray");
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  QCoreApplication app(argc, argv);
+
+  testTetraVolumeOrientation();
+  testPartHierarchyRay();
+
+  return (s_nofFailures == 0)? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+#-------------------------------------------------------------------------------
+#
+# Copyright 2017 Edson Contreras
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+#-------------------------------------------------------------------------------
+
+# VTK 7.1 include path and libraries, shared by the application and the
+# benchmarks (bench/Benchmarks.pro)
+
+INCLUDEPATH += \
+  $$(VTK_7_INCLUDE_PATH)
+
+LIBS += \
+  -L$$(VTK_7_LIBRARY_PATH) \
+  -lvtkCommonColor-7.1 \
+  -lvtkCommonCore-7.1 \
+  -lvtkCommonComputationalGeometry-7.1 \
+  -lvtkCommonDataModel-7.1 \
+  -lvtkCommonExecutionModel-7.1 \
+  -lvtkCommonMath-7.1 \
+  -lvtkCommonMisc-7.1 \
+  -lvtkCommonSystem-7.1 \
+  -lvtkCommonTransforms-7.1 \
+  -lvtkDICOMParser-7.1 \
+  -lvtkFiltersCore-7.1 \
+  -lvtkFiltersGeneral-7.1 \
+  -lvtkFiltersGeometry-7.1 \
+  -lvtkFiltersModeling-7.1 \
+  -lvtkFiltersExtraction-7.1 \
+  -lvtkFiltersSources-7.1 \
+  -lvtkFiltersStatistics-7.1 \
+  -lvtkGUISupportQt-7.1 \
+  -lvtkGUISupportQtOpenGL-7.1 \
+  -lvtkIOCore-7.1 \
+  -lvtkIOImage-7.1 \
+  -lvtkIOLegacy-7.1 \
+  -lvtkIOXML-7.1 \
+  -lvtkIOXMLParser-7.1 \
+  -lvtkImagingCore-7.1 \
+  -lvtkImagingFourier-7.1 \
+  -lvtkInteractionStyle-7.1 \
+  -lvtkRenderingCore-7.1 \
+  -lvtkRenderingOpenGL2-7.1 \
+  -lvtkalglib-7.1 \
+  -lvtkexpat-7.1 \
+  -lvtkglew-7.1 \
+  -lvtkjpeg-7.1 \
+  -lvtkmetaio-7.1 \
+  -lvtkpng-7.1 \
+  -lvtksys-7.1 \
+  -lvtktiff-7.1 \
+  -lvtkzlib-7.1